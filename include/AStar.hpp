@@ -31,13 +31,79 @@
 #define ASTAR_HPP_
 
 
-#include "Map.hpp"           // A class to represent the game map
-#include "BinaryHeap.hpp"	 // Priority queue used for the open_list_
-#include "RedBlackTree.hpp"  // Binary self balancing tree class used for the closed_list_
+#include "Map.hpp"                // A class to represent the game map
+#include "IndexedBinaryHeap.hpp"  // Priority queue used for the open_list_
+#include "SlabPool.hpp"           // Arena allocator for MapNodes
+#include "BucketQueue.hpp"        // Alternative open list (Dial's buckets)
+#include "GenerationStamps.hpp"   // ids on the bucket open list
+#include <vector>                 // nodes on the bucket open list
+
+//#define ASTAR_CLOSED_LIST_RBTREE  // set to use a red-black tree instead of generation stamps as closed list
+
+#if defined (ASTAR_CLOSED_LIST_RBTREE)
+#include "RedBlackTree.hpp"     // Binary self balancing tree class used for the closed_list_
+#else
+#include "DenseClosedList.hpp"  // Generation stamps over node ids used for the closed_list_
+#endif
 
 namespace astar
 {
 
+	//! \brief Arena allocator for the nodes generated by AStar
+	typedef o_data_structures::SlabPool<o_graph::MapNode> NodePool;
+
+
+	/** \brief Memory used by class AStar that is kept between searches
+	 *
+	 *  \details A Workspace bundles the open lists (one per OpenListPolicy), the closed list and
+	 *  the pool for MapNodes. Every list is emptied at the end of a search
+	 *  in O(1) or O(open list size) (never in O(map size)), so once a workspace
+	 *  has grown to the size of the largest map, a search only touches the
+	 *  nodes it actually visits.
+	 *
+	 *  \note A workspace must not be used by two searches at the same time.
+	 *  The interface functions use one workspace per thread (ThreadWorkspace()).
+	 */
+	struct Workspace
+	{
+		typedef o_graph::MapNode MapNode;
+		typedef o_data_structures::IndexedBinaryHeap<float, MapNode*> OpenList;
+#if defined (ASTAR_CLOSED_LIST_RBTREE)
+		typedef o_data_structures::RedBlackTree<unsigned int, MapNode*> ClosedList;
+#else
+		typedef o_data_structures::DenseClosedList<MapNode*> ClosedList;
+#endif
+
+		/** \brief Open list for OpenListPolicy open_list_buckets
+		 *  \details BucketQueue has no decrease key; an improved node is inserted again
+		 *  and its outdated entry is skipped when it is popped after the node was closed.
+		 */
+		struct BucketList
+		{
+			o_data_structures::BucketQueue<MapNode*> queue_;  //< key: integer f-value (LIFO among equal keys)
+			o_data_structures::GenerationStamps<> ids_;        //< ids of the nodes on the list
+			std::vector<MapNode*> nodes_;                      //< node of every id on the list
+		};
+
+		Workspace() { }
+		void Reserve(const unsigned int &n_nodes);
+
+		NodePool node_pool_;      //< Memory for all MapNodes of a search
+		OpenList open_list_;      //< Priority queue containing all Nodes that need processing (indexed by node id)
+		BucketList bucket_list_;  //< Open list used instead of open_list_ for OpenListPolicy open_list_buckets
+		ClosedList closed_list_;  //< Set of all visited nodes (generation stamps over node ids or binary search tree)
+
+	private :
+		Workspace(const Workspace &);
+		Workspace &operator=(const Workspace &);
+	};
+
+	//! \brief State of a search run in several steps (see AStar::Step(..) and ResumableSearch)
+	enum SearchStatus {search_idle, search_in_progress, search_found, search_unreachable};
+
+	// per-thread workspace used by the interface functions documented in AStar.cpp
+	Workspace &ThreadWorkspace();
+
 	// interface function documented in AStar.cpp
 	int FindPath(const int nStartX, const int nStartY,
 				 const int nTargetX, const int nTargetY,
@@ -52,6 +118,30 @@ namespace astar
 				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
 
 
+	// interface function with choice of the open list documented in AStar.cpp
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded,
+				 const o_data_structures::OpenListPolicy &policy);
+
+
+	// interface function with choice of open list and heuristic documented in AStar.cpp
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded,
+				 const o_data_structures::OpenListPolicy &policy, const o_graph::HeuristicPolicy &heuristic);
+
+
+	// interface function for bounded suboptimal paths (weighted A*) documented in AStar.cpp
+	int FindBoundedPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, const float epsilon,
+				 unsigned int &nodes_expanded);
+
+
 
 
 
@@ -60,6 +150,17 @@ namespace astar
 	 *  \detail Implementation details:
 	 *  	- Buffer to write computed path to is owned by caller
 	 *  	- Early return if computed path exceeds buffer size
+	 *  	- MapNodes are taken from a NodePool and released all at once
+	 *  	  at the end of FindPath(..) (no new/delete per node)
+	 *  	- open list, closed list and NodePool are owned by a Workspace
+	 *  	  that outlives the search (no per search initialization in O(map size))
+	 *  	- The open list is either an IndexedBinaryHeap (f-values with tie breaking
+	 *  	  deviation, see Map::get_heuristic(..)) or a BucketQueue (integer f-values,
+	 *  	  LIFO among equal f-values), see open_list_policy_
+	 *  	- The heuristic is either the manhattan distance or the landmark bound
+	 *  	  of the Landmarks registered for the map (see heuristic_policy_)
+	 *  	- With weight_ w > 1 the f-value is g + w*h (weighted A*, nodes are
+	 *  	  not reopened); the path found is at most w times longer than a shortest one
 	 *
 	 * 	\references
 	 *  	- P. E. Hart, N. J. Nilsson, B. Raphael:
@@ -68,6 +169,10 @@ namespace astar
 	 *	    - P. E. Hart, N. J. Nilsson, B. Raphael:
 	 *	      Correction to A Formal Basis for the Heuristic Determination of Minimum Cost Paths.
 	 *	      SIGART Newsletter, 37, 1972, S. 2829.
+	 *	    - I. Pohl: Heuristic Search Viewed as Path Finding in a Graph.
+	 *	      Artificial Intelligence 1 (3), 1970, S. 193-204.
+	 *	    - M. Likhachev, G. Gordon, S. Thrun: ARA*: Anytime A* with Provable Bounds
+	 *	      on Sub-Optimality. NIPS 2003 (bound without reopening, consistent heuristic).
 	 *	    - https://www.redblobgames.com/pathfinding/a-star/introduction.html (date: 2018-10-04)
 	 *      - https://de.wikipedia.org/wiki/A*-Algorithmus (date: 2018-10-04)
 	 */
@@ -75,28 +180,42 @@ namespace astar
 	{
 	public :
 		explicit AStar(o_graph::Map &map, int *p_buffer, int size_buffer);
+		explicit AStar(o_graph::Map &map, int *p_buffer, int size_buffer, Workspace &workspace);
 		int FindPath(const int &iS, const int &jS, const int &iT, const int &jT);
+		bool Start(const int &iS, const int &jS, const int &iT, const int &jT);
+		SearchStatus Step(const unsigned int &max_expansions);
+		void ClearLists();
+
+		static const unsigned int unlimited_expansions_ = 0u - 1u;  //< budget of Step(..) that runs a search to its end
 
 		unsigned int nodes_expanded_; //< for diagnostics
+		int path_length_;             //< length of the path found by Step(..) (-1 before)
+		o_data_structures::OpenListPolicy open_list_policy_;  //< open list to be used (default: binary heap)
+		o_graph::HeuristicPolicy heuristic_policy_;           //< heuristic to be used (default: manhattan)
+		float weight_;  //< weight of the heuristic (default 1: shortest paths; > 1 only bounded with open_list_binary_heap)
 
 	protected :
 		typedef o_graph::Map Map;
 		typedef o_graph::MapNode MapNode;
-		typedef o_data_structures::BinaryHeap<float, MapNode*> OpenList;
-		typedef o_data_structures::BinaryHeapNode<float, MapNode*> OpenListItem;
-		typedef o_data_structures::RedBlackTree<unsigned int, MapNode*> ClosedList;
-		typedef o_data_structures::RedBlackNode<unsigned int, MapNode*> ClosedListItem;
+		typedef Workspace::OpenList OpenList;
+		typedef Workspace::BucketList BucketList;
+		typedef Workspace::ClosedList ClosedList;
 
 		AStar();
 		void ExpandNode(MapNode *predecessor);
+		MapNode *FindOpen(const unsigned int &id) const;
+		void PushOpen(MapNode *node, const bool &is_update);
+		MapNode *PopOpen();
 		int BacktrackPath(MapNode *node_on_path) const;
-		void ClearLists();
 
 		int output_buffer_size_;  //< size of Buffer for returning computed path
 		int *p_output_buffer_;    //< pointer to buffer for returning computed path (memory owned by caller)
 		Map &map_;                //< Reference to the game map (provided by caller)
-		OpenList open_list_;      //< Priority queue containing all Nodes that need processing
-		ClosedList closed_list_;  //< Binary search tree containing all visited nodes
+		NodePool &node_pool_;     //< Memory for all MapNodes of a search (owned by a Workspace)
+		OpenList &open_list_;     //< Priority queue containing all Nodes that need processing (owned by a Workspace)
+		BucketList &bucket_list_; //< Alternative open list (owned by a Workspace)
+		ClosedList &closed_list_; //< Set of all visited nodes (owned by a Workspace)
+		unsigned int target_id_;  //< id of the target of the current search (set by Start(..))
 
 	}; // END OF CLASS AStar
 
@@ -0,0 +1,89 @@
+/** \file
+ * 		BidirectionalSearch.hpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (bidirectional breadth first search)
+ *
+ *  \details
+ *  	BidirectionalSearch.hpp declares interface functions bidirectional::FindPath(..)
+ *  	with the same contract as the UCS FindPath(..) (see UniformCostSearch.hpp).
+ *  	Two breadth first searches grow from start and target over o_graph::Map
+ *  	until their explored regions meet. The search can either alternate between
+ *  	both directions on the calling thread or run the backward direction on a
+ *  	second thread (see SearchMode).
+ *
+ *  \sa
+ *  	UniformCostSearch.hpp
+ */
+
+#pragma once
+#ifndef BIDIRECTIONAL_SEARCH_HPP_
+#define BIDIRECTIONAL_SEARCH_HPP_
+
+namespace bidirectional
+{
+
+	//! \brief Selects how the two directions of the search are executed
+	enum SearchMode
+	{
+		search_alternating,  //< calling thread expands the smaller frontier level by level
+		search_two_threads   //< forward on the calling thread, backward on a second thread (experimental)
+	};
+
+
+	/** \brief Interface to use the bidirectional search (alternating mode)
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \return Returns the length of the shortest path between Start and
+	 *  Target, or -1 if no such path exists
+	 *
+	 *  \note FindPath(..) may be called concurrently from several threads;
+	 *  every thread reuses its own search memory (see Workspace in BidirectionalSearch.cpp).
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize);
+
+
+	/** \brief Interface to use the bidirectional search with additional diagnostic capabilities
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[out] nodes_expanded number of grid points reached by both directions
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+
+	/** \brief Interface to use the bidirectional search with choice of the mode
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[in] mode alternating on the calling thread or two threads
+	 *  \note search_two_threads is experimental: every calling thread keeps a second
+	 *  thread that is woken up per call. Both threads touch the same stamps, so it
+	 *  can only pay off for long queries on an otherwise idle core
+	 *  (see "pdx_pathfinding bidirectional" in main.cpp).
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded,
+				 const SearchMode &mode);
+
+} // END OF NAMESPACE bidirectional
+
+#endif // END OF BIDIRECTIONAL_SEARCH_HPP_
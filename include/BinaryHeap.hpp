@@ -155,6 +155,7 @@ namespace o_data_structures
 		void decrease_key(const unsigned int &i, KeyType new_key);
 		void change_key(const unsigned int &i, const KeyType &new_key);
 		void build();
+		void clear();
 
 
 		bool is_empty(void) const {return n_items_==0;}
@@ -415,6 +416,18 @@ namespace o_data_structures
 	}
 
 
+	/** \brief removes all items from the heap
+	 *  \details Allocated memory is kept, so a heap that is reused
+	 *  (e.g. by consecutive searches) doesn't need to grow again.
+	 */
+	template <typename KeyType, typename DataType>
+	void BinaryHeap<KeyType,DataType>::clear()
+	{
+		n_items_ = 0;
+		return;
+	}
+
+
 	/** \brief Searches the heap for an item (use this if item is a literal or float and its position in heap isn't of interest)
 	 *
 	 *  \details
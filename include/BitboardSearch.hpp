@@ -0,0 +1,63 @@
+/** \file
+ * 		BitboardSearch.hpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (bit-parallel breadth first search)
+ *
+ *  \details
+ *  	Since the map is binary and all moves cost 1, uniform cost search is a
+ *  	breadth first search. BitboardSearch.hpp declares interface functions
+ *  	bitboard::FindPath(..) that expand the BFS wavefront on a bit-packed map
+ *  	(tiles of 8x8 grid points per machine word) with shifts and bitwise ANDs instead of
+ *  	expanding single nodes through a priority queue (see UniformCostSearch.hpp).
+ *
+ *  \sa
+ *  	UniformCostSearch.hpp
+ */
+
+#pragma once
+#ifndef BITBOARD_SEARCH_HPP_
+#define BITBOARD_SEARCH_HPP_
+
+namespace bitboard
+{
+
+	/** \brief Interface to use the bit-parallel breadth first search
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \return Returns the length of the shortest path between Start and
+	 *  Target, or -1 if no such path exists
+	 *
+	 *  \note FindPath(..) may be called concurrently from several threads;
+	 *  every thread reuses its own search memory (see Workspace in BitboardSearch.cpp).
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize);
+
+
+	/** \brief Interface to use the bit-parallel breadth first search with additional diagnostic capabilities
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[out] nodes_expanded number of grid points reached by the wavefront (start excluded)
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+} // END OF NAMESPACE bitboard
+
+#endif // END OF BITBOARD_SEARCH_HPP_
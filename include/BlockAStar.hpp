@@ -0,0 +1,240 @@
+/** \file
+ * 		BlockAStar.hpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities on blocks of 4x4 grid points (Block A*)
+ *
+ *  \details
+ *  	AStar pushes and pops every generated grid point through its open list.
+ *  	Class BlockAStar tiles the map into blocks of 4x4 grid points and puts
+ *  	whole blocks on the open list: expanding a block relaxes all of its grid
+ *  	points at once with the help of a local distance database (LDDB), which
+ *  	holds the distances between all pairs of grid points inside a block for
+ *  	every one of the 2^16 possible block patterns. The open list sees about
+ *  	one operation per block instead of one per grid point.
+ *
+ *  	The database does not depend on the map, so one database (16 MiB) is built
+ *  	once per process and shared by all maps and threads. It can be saved to a
+ *  	file and read again on the next start (see PrepareDatabase(..)).
+ *
+ *  	Where it loses against AStar:
+ *  	- The first query of a process builds the database (about 0.1 s, 16 MiB)
+ *  	  unless PrepareDatabase(..) was called before. Counted into the first
+ *  	  maze512-1 query this makes Block A* slower than AStar on that family
+ *  	  (7.0 vs 6.6 ms per query, 40 queries).
+ *  	- Short queries on small open maps (empty_16x16: 0.7 vs 0.4 us): setting
+ *  	  up the block search costs more than the few expansions it saves.
+ *  	- On random maps Fringe search (FringeSearch.hpp) is faster.
+ *  	With a prepared database it is 1.4-4x faster than AStar on all maze512 families.
+ *
+ * 	\references
+ * 		- P. Yap, N. Burch, R. C. Holte, J. Schaeffer: Block A*: Database-Driven
+ * 		  Search with Applications in Any-angle Path-Planning. AAAI 2011, S. 120-125.
+ *  \sa
+ *  	AStar.hpp
+ */
+
+#pragma once
+#ifndef BLOCK_ASTAR_HPP_
+#define BLOCK_ASTAR_HPP_
+
+#include <cstddef>               // std::size_t
+#include <string>                // file names
+#include <vector>                // distances and lists of the search
+#include "GenerationStamps.hpp"  // reached grid points and known blocks of the search
+#include "IndexedBinaryHeap.hpp" // open list of the search
+#include "Map.hpp"               // A class to represent the game map
+
+namespace blockastar
+{
+
+	/** \brief Distances between all pairs of grid points inside a 4x4 block (LDDB)
+	 *
+	 *  \details A block pattern has bit (dy*4 + dx) set if grid point (dx,dy) of the block
+	 *  is traversable; grid points outside the map count as blocked. get_table(pattern)[from*16 + to]
+	 *  is the length of a shortest path from grid point from to grid point to that doesn't leave
+	 *  the block, unreachable_ if there is none (or one of both is blocked).
+	 *
+	 *  File format (native byte order): magic "PDXLDB1" (8 bytes), block size (int32),
+	 *  checksum of the distances (uint64), distances_ (2^16 x 256 bytes).
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	2^16 * 16 * 16 bytes
+	 *  build		|	O(2^16 * 16 * 16)
+	 *  distance	|	O(1)
+	 */
+	class LocalDistanceDatabase
+	{
+	public :
+		LocalDistanceDatabase();
+
+		static LocalDistanceDatabase *Load(const std::string &file_name);
+		int Save(const std::string &file_name) const;
+		std::size_t get_memory_footprint() const;
+
+		/** \brief distances of all pairs of grid points of a block pattern
+		 *  \param[in] pattern The block pattern
+		 *  \return 16 x 16 distances (row: from, column: to)
+		 */
+		inline const unsigned char *get_table(const unsigned int &pattern) const {
+			return &distances_[pattern << 8];
+		}
+
+		std::vector<unsigned char> distances_;  //< 256 distances of every pattern
+		unsigned long long checksum_;           //< checksum of distances_ (see Load(..))
+
+		static const int block_size_ = 4;                  //< extent of a block in both directions
+		static const unsigned int n_patterns_ = 1u << 16;  //< number of distinct block patterns
+		static const unsigned char unreachable_ = 255;     //< distance of unconnected grid points
+
+	protected :
+		LocalDistanceDatabase(const LocalDistanceDatabase &);
+		LocalDistanceDatabase &operator=(const LocalDistanceDatabase &);
+
+		//! \brief tag of the constructor that leaves the distances empty
+		struct Empty { };
+		explicit LocalDistanceDatabase(const Empty &);
+	}; // END OF CLASS LocalDistanceDatabase
+
+
+	// database shared by all searches (read from or saved to file_name on first use)
+	const LocalDistanceDatabase &PrepareDatabase(const std::string &file_name);
+	const LocalDistanceDatabase &SharedDatabase();
+
+
+	/** \brief Memory used by class BlockAStar that is kept between searches
+	 *
+	 *  \details Grid points are stored block by block: grid point (dx,dy) of block b
+	 *  has the index b*16 + dy*4 + dx (the "block index").
+	 *
+	 *  \note A workspace must not be used by two searches at the same time.
+	 *  The interface functions use one workspace per thread.
+	 */
+	struct Workspace
+	{
+		Workspace() { }
+
+		std::vector<int> g_;                   //< path cost of reached grid points (block index)
+		std::vector<unsigned int> parents_;    //< block index of the predecessor of reached grid points
+		std::vector<unsigned short> patterns_; //< pattern of known blocks
+		std::vector<unsigned short> ingress_;  //< grid points of a block reached from outside since its last expansion
+		o_data_structures::GenerationStamps<unsigned int> reached_;  //< grid points with valid g_ (block index)
+		o_data_structures::GenerationStamps<unsigned int> known_;    //< blocks with valid patterns_ and ingress_
+		o_data_structures::IndexedBinaryHeap<unsigned long long, unsigned int> open_list_;  //< blocks keyed by their best ingress (see BlockAStar::get_key(..))
+
+	private :
+		Workspace(const Workspace &);
+		Workspace &operator=(const Workspace &);
+	};
+
+
+	/** \brief provides pathfinding capabilities expanding blocks of 4x4 grid points (Block A*)
+	 *
+	 *  \details Expanding a block relaxes all of its grid points from its ingress grid points
+	 *  (LDDB distances), then steps from every improved boundary grid point into the neighbouring
+	 *  blocks, which become ingress grid points there. A block can be expanded several times,
+	 *  whenever better paths reach it. The search stops once the least key on the open list is
+	 *  not smaller than the length of the best path to the target found so far.
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	O(width*height)
+	 *  Time		|	O(width*height * log(width*height))
+	 */
+	class BlockAStar
+	{
+	public :
+		explicit BlockAStar(o_graph::Map &map, int *p_buffer, int size_buffer);
+		explicit BlockAStar(o_graph::Map &map, int *p_buffer, int size_buffer, Workspace &workspace);
+		int FindPath(const int &iS, const int &jS, const int &iT, const int &jT);
+
+		unsigned int nodes_expanded_;  //< number of expanded blocks (for diagnostics)
+
+	protected :
+		BlockAStar();
+		BlockAStar(const BlockAStar &);
+		BlockAStar &operator=(const BlockAStar &);
+
+		/** \brief grid point id of a block index
+		 *  \param[in] cell The block index
+		 *  \return id of the grid point (see Map.hpp)
+		 */
+		inline unsigned int get_id(const unsigned int &cell) const {
+			const unsigned int block = cell >> 4;
+			return (block % n_blocks_x_)*4 + (cell & 3) + ((block / n_blocks_x_)*4 + ((cell >> 2) & 3))*map_.width_;
+		}
+
+		/** \brief key of a block on the open list
+		 *  \details Ties of f are broken in favour of larger g (grid points closer to the target).
+		 *  \param[in] f f-value of an ingress grid point
+		 *  \param[in] g path cost of the ingress grid point
+		 *  \return the key
+		 */
+		inline static unsigned long long get_key(const int &f, const int &g) {
+			return ((unsigned long long) f << 32) | (0xFFFFFFFFu - (unsigned int) g);
+		}
+
+		//! \brief f-value of a key (see get_key(..))
+		inline static int get_f(const unsigned long long &key) {
+			return (int) (key >> 32);
+		}
+
+		unsigned int get_block_index(const unsigned int &id) const;
+		unsigned int get_pattern(const unsigned int &block);
+		void RelaxCell(const unsigned int &cell, const int &g, const int &h, const unsigned int &parent);
+		void ExpandBlock(const unsigned int &block);
+		void BacktrackPath(const unsigned int &start_cell, const unsigned int &target_cell, const int &path_length) const;
+
+		int output_buffer_size_;                 //< size of Buffer for returning computed path
+		int *p_output_buffer_;                   //< pointer to buffer for returning computed path (memory owned by caller)
+		o_graph::Map &map_;                      //< Reference to the game map (provided by caller)
+		const LocalDistanceDatabase &database_;  //< distances inside blocks (shared)
+		Workspace &workspace_;                   //< lists of the search
+		unsigned int n_blocks_x_;                //< number of blocks in x-direction
+		unsigned int n_blocks_y_;                //< number of blocks in y-direction
+		int target_x_;                           //< x-coordinate of the target (heuristic)
+		int target_y_;                           //< y-coordinate of the target (heuristic)
+	}; // END OF CLASS BlockAStar
+
+
+	/** \brief Interface to use Block A*
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \return Returns the length of the shortest path between Start and
+	 *  Target, or -1 if no such path exists
+	 *
+	 *  \note If the shortest path consists of more visited nodes than
+	 *  can be stored in pOutBuffer all surplus nodes are discarded.
+	 *  The first query builds the shared database unless PrepareDatabase(..) was called before.
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize);
+
+
+	/** \brief Interface to use Block A* with additional diagnostic capabilities
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[out] nodes_expanded number of expanded blocks
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+} // END OF NAMESPACE blockastar
+
+#endif // END OF BLOCK_ASTAR_HPP_
@@ -0,0 +1,235 @@
+/** \file
+ * 		BucketQueue.hpp
+ *
+ *  \brief
+ *  	Provides a bucket based priority queue for monotone integer keys (class BucketQueue)
+ *
+ *  \details
+ *  	BucketQueue is an implementation of Dial's algorithm for the open list
+ *  	of a pathfinder on a unit cost grid (small integer path costs and f-values).
+ *  	Insertion and removal are O(1) (amortized) as long as keys are monotone,
+ *  	i.e. no key smaller than the key of the last removed item is inserted.
+ *  	This holds for uniform cost search and for A* with a consistent heuristic.
+ *
+ *  	Contains as well the enum OpenListPolicy which lets pathfinders choose
+ *  	between BinaryHeap and BucketQueue as open list.
+ *
+ *  \references
+ *  	- R. B. Dial: Algorithm 360: Shortest-path forest with topological ordering.
+ *  	  Communications of the ACM 12 (11), 1969, S. 632-633.
+ */
+
+#pragma once
+#ifndef BUCKET_QUEUE_HPP_
+#define BUCKET_QUEUE_HPP_
+
+//#define BUCKETQUEUE_CAUTIOUS    // unset if STL exceptions aren't wanted
+
+#if defined (BUCKETQUEUE_CAUTIOUS)
+#include <stdexcept>  // exception handling
+#endif
+
+#include <vector>     // items of a single bucket
+
+namespace o_data_structures
+{
+
+	//! \brief Selects the priority queue a pathfinder uses as open list
+	enum OpenListPolicy
+	{
+		open_list_binary_heap,  //< (indexed) binary heap, arbitrary keys, O(log n)
+		open_list_buckets       //< BucketQueue, monotone integer keys, O(1)
+	};
+
+
+	/** \brief Priority queue for monotone integer keys (Dial's buckets)
+	 *
+	 *  \details Items with key k are stored in bucket k % n_buckets_ (circular array).
+	 *  All stored keys lie within [min_key_, min_key_ + n_buckets_); if an insertion
+	 *  exceeds this span the number of buckets is doubled.
+	 *
+	 *  Items with equal key are returned in LIFO order. For A* this prefers the
+	 *  most recently generated nodes among nodes with equal f-value, which are
+	 *  mostly the nodes with the largest path cost g (i.e. closest to the target).
+	 *  Keeping the buckets sorted by g instead was measured to be several times
+	 *  slower on maps with wide corridors (large plateaus of equal f-values).
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	O(n + key span)
+	 *  insert		|	O(1) (amortized)
+	 *  pop			|	O(1) (amortized over all pops)
+	 *  clear		|	O(key span)
+	 *
+	 *  \note Keys must be monotone: insert(..) mustn't be called with a key
+	 *  smaller than the key of the item returned by the last call to pop().
+	 */
+	template <typename DataType>
+	class BucketQueue
+	{
+	public :
+		explicit BucketQueue(const unsigned int &n_buckets = 16);
+		~BucketQueue();
+
+		void insert(const unsigned int &key, const DataType &data);
+		DataType pop();
+		unsigned int min_key();
+		void clear();
+
+		bool is_empty(void) const {return n_items_==0;}
+
+		unsigned int n_items_;    //< number of items currently stored
+
+	protected :
+		BucketQueue(const BucketQueue &);
+		BucketQueue &operator=(const BucketQueue &);
+
+		typedef std::vector<DataType> Bucket;
+
+		void grow(const unsigned int &key);
+		void advance();
+
+		Bucket *buckets_;         //< circular array of buckets
+		unsigned int n_buckets_;  //< number of buckets (power of two)
+		unsigned int mask_;       //< n_buckets_-1 (key -> bucket index)
+		unsigned int min_key_;    //< no stored key is smaller than min_key_
+		bool has_min_key_;        //< false until the first insertion (after construction or clear())
+	}; // END OF CLASS BucketQueue
+
+
+
+	/** \brief Constructor
+	 *  \param[in] n_buckets initial number of buckets (rounded up to a power of two)
+	 */
+	template <typename DataType>
+	BucketQueue<DataType>::BucketQueue(const unsigned int &n_buckets) :
+			n_items_(0), n_buckets_(1), min_key_(0), has_min_key_(false)
+	{
+		while (n_buckets_ < n_buckets)
+			n_buckets_ *= 2;
+		mask_ = n_buckets_-1;
+		buckets_ = new Bucket[n_buckets_];
+	}
+
+
+	//! \brief Destructor
+	template <typename DataType>
+	BucketQueue<DataType>::~BucketQueue()
+	{
+		delete[] buckets_;
+	}
+
+
+	/** \brief Adds an item
+	 *  \param[in] key Key of the new item (key >= key of the last popped item)
+	 *  \param[in] data Data field of the new item
+	 */
+	template <typename DataType>
+	void BucketQueue<DataType>::insert(const unsigned int &key, const DataType &data)
+	{
+		// the first key after construction or clear() sets the start of the key span;
+		// later an empty queue keeps min_key_ (the key of the last popped item),
+		// since subsequent keys may be smaller than key (but not smaller than min_key_)
+		if (!has_min_key_)
+		{
+			min_key_ = key;
+			has_min_key_ = true;
+		}
+       #if defined(BUCKETQUEUE_CAUTIOUS)
+		if (key < min_key_)
+			throw std::runtime_error("insert: key isn't monotone\n");
+       #endif
+		if (key - min_key_ >= n_buckets_)
+			grow(key);
+
+		buckets_[key & mask_].push_back(data);
+		++n_items_;
+		return;
+	}
+
+
+	/** \brief removes an item with minimum key (the last inserted among those)
+	 *  \return data field of the removed item
+	 */
+	template <typename DataType>
+	DataType BucketQueue<DataType>::pop()
+	{
+       #if defined(BUCKETQUEUE_CAUTIOUS)
+		if (n_items_ == 0)
+			throw std::runtime_error("pop: queue is empty\n");
+       #endif
+		advance();
+		Bucket &bucket = buckets_[min_key_ & mask_];
+		DataType data = bucket.back();
+		bucket.pop_back();
+		--n_items_;
+		return data;
+	}
+
+
+	/** \brief key of the item that will be returned by the next call to pop()
+	 *  \return the minimum key (queue mustn't be empty)
+	 */
+	template <typename DataType>
+	unsigned int BucketQueue<DataType>::min_key()
+	{
+		advance();
+		return min_key_;
+	}
+
+
+	/** \brief removes all items
+	 *  \details allocated buckets are kept for reuse
+	 */
+	template <typename DataType>
+	void BucketQueue<DataType>::clear()
+	{
+		for (unsigned int i=0; i<n_buckets_; ++i)
+			buckets_[i].clear();
+		n_items_ = 0;
+		min_key_ = 0;
+		has_min_key_ = false;
+		return;
+	}
+
+
+	/** \brief moves min_key_ to the first non empty bucket (queue mustn't be empty)
+	 *  \details min_key_ is only moved on demand, so a bucket that was emptied by pop()
+	 *  can still receive items with the same key.
+	 */
+	template <typename DataType>
+	inline void BucketQueue<DataType>::advance()
+	{
+		while (buckets_[min_key_ & mask_].empty())
+			++min_key_;
+		return;
+	}
+
+
+	/** \brief doubles the number of buckets until key fits into the key span
+	 *  \param[in] key The key that has to be storable
+	 */
+	template <typename DataType>
+	void BucketQueue<DataType>::grow(const unsigned int &key)
+	{
+		unsigned int new_n_buckets = n_buckets_;
+		while (key - min_key_ >= new_n_buckets)
+			new_n_buckets *= 2;
+		unsigned int new_mask = new_n_buckets-1;
+
+		Bucket *tmp = new Bucket[new_n_buckets];
+		for (unsigned int offset=0; offset<n_buckets_; ++offset)
+		{
+			unsigned int k = min_key_ + offset;
+			tmp[k & new_mask].swap(buckets_[k & mask_]);
+		}
+		delete[] buckets_;
+		buckets_ = tmp;
+		n_buckets_ = new_n_buckets;
+		mask_ = new_mask;
+		return;
+	}
+
+} // END OF NAMESPACE o_data_structures
+
+#endif // END OF BUCKET_QUEUE_HPP_
@@ -0,0 +1,83 @@
+/** \file
+ * 		ComponentLabels.hpp
+ *
+ *  \brief
+ *  	Connected components of a game map (class ComponentLabels)
+ *
+ *  \details
+ *  	A search between grid points of different connected components
+ *  	can't succeed, but without further knowledge every pathfinder explores
+ *  	the whole component of the start position before it returns -1.
+ *  	ComponentLabels labels every traversable grid point with the id of its
+ *  	connected component once per map, so such queries are rejected in O(1).
+ *
+ *  	Pathfinders get the labels of a map through a registry keyed by the
+ *  	maps data pointer (see RegisterComponents(..) and Registry.hpp).
+ */
+
+#pragma once
+#ifndef COMPONENT_LABELS_HPP_
+#define COMPONENT_LABELS_HPP_
+
+#include <memory>  // shared ownership of registered labels
+#include <vector>  // labels of all grid points
+
+namespace o_graph
+{
+
+	/** \brief Labels of the connected components of a grid map
+	 *
+	 *  \details Grid points are connected horizontally and vertically (see Map.hpp).
+	 *  Labels are computed by a two pass union find:
+	 *  - first pass: every traversable grid point is united with its traversable
+	 *    left and upper neighbour (union by index, path halving)
+	 *  - second pass: roots are numbered consecutively from 0 to n_components_-1
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	O(width*height)
+	 *  construction|	O(width*height*alpha(width*height))
+	 *  connected	|	O(1)
+	 *
+	 *  \note The labels are only valid as long as the map data doesn't change.
+	 */
+	class ComponentLabels
+	{
+	public :
+		explicit ComponentLabels(const int &width, const int &height, const unsigned char *data);
+
+		/** \brief component of a grid point
+		 *  \param[in] id The id of the grid point (see Map::get_id(..))
+		 *  \return label of the component; blocked_ if the grid point isn't traversable
+		 */
+		inline int label(const unsigned int &id) const {
+			return labels_[id];
+		}
+
+		/** \brief checks if a path between two grid points can exist
+		 *  \param[in] id_a id of the first grid point
+		 *  \param[in] id_b id of the second grid point
+		 *  \return true if both grid points are identical or traversable and in the same component
+		 */
+		inline bool connected(const unsigned int &id_a, const unsigned int &id_b) const {
+			return (id_a == id_b) || ((labels_[id_a] == labels_[id_b]) && (labels_[id_a] != blocked_));
+		}
+
+		const int width_;                //< width of the labelled map
+		const int height_;               //< height of the labelled map
+		int n_components_;               //< number of connected components
+		std::vector<int> labels_;        //< component of every grid point (blocked_ for blocked grid points)
+		static const int blocked_ = -1;  //< label of blocked grid points
+
+	protected :
+		ComponentLabels();
+	}; // END OF CLASS ComponentLabels
+
+
+	std::shared_ptr<const ComponentLabels> RegisterComponents(const unsigned char *data, const int &width, const int &height);
+	void UnregisterComponents(const unsigned char *data);
+	std::shared_ptr<const ComponentLabels> FindComponents(const unsigned char *data, const int &width, const int &height);
+
+} // END OF NAMESPACE o_graph
+
+#endif // END OF COMPONENT_LABELS_HPP_
@@ -0,0 +1,134 @@
+/** \file
+ * 		ContractionHierarchy.hpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (contraction hierarchies)
+ *
+ *  \details
+ *  	For static maps a heavy preprocessing pays off: class ContractionHierarchy
+ *  	contracts the traversable grid points of a map one by one and adds
+ *  	shortcut edges that preserve all distances. A query is a bidirectional
+ *  	Dijkstra search that only follows edges to more important nodes and
+ *  	settles a few hundred nodes, even for paths across the whole map.
+ *  	Shortcuts of the resulting path are unpacked recursively into grid moves.
+ *
+ *  	The hierarchy of a map is built once and registered by the maps
+ *  	data pointer (see RegisterContractionHierarchy(..) and Registry.hpp).
+ *
+ * 	\references
+ * 		- R. Geisberger, P. Sanders, D. Schultes, D. Delling: Contraction Hierarchies:
+ * 		  Faster and Simpler Hierarchical Routing in Road Networks. WEA 2008, S. 319-333.
+ */
+
+#pragma once
+#ifndef CONTRACTION_HIERARCHY_HPP_
+#define CONTRACTION_HIERARCHY_HPP_
+
+#include <memory>  // shared ownership of registered hierarchies
+#include <vector>  // compact graph arrays
+#include "Map.hpp"
+
+namespace ch
+{
+
+	/** \brief Shortcut augmented graph of a static map
+	 *
+	 *  \details Nodes are the traversable grid points, numbered by their rank
+	 *  (order of contraction, most important node last). The graph is undirected,
+	 *  so only upward edges (to nodes of higher rank) are stored, in compressed
+	 *  row format:
+	 *  - the upward edges of node v are first_edge_[v] .. first_edge_[v+1]-1
+	 *  - edge_head_[e] is the higher ranked end of edge e, edge_weight_[e] its length
+	 *  - edge_middle_[e] is the node a shortcut bypasses (no_middle_ for grid moves)
+	 *  - edge_children_[2*e], edge_children_[2*e+1] are the two edges a shortcut replaces
+	 *
+	 *  Node order: lazy updated priority = 2*edge difference + contracted neighbours
+	 *  + hierarchy level. Witness searches are limited to max_witness_settled_ nodes
+	 *  (a missed witness only adds a superfluous shortcut).
+	 *
+	 *  \note The hierarchy is only valid as long as the map data doesn't change.
+	 */
+	class ContractionHierarchy
+	{
+	public :
+		explicit ContractionHierarchy(const o_graph::Map &map);
+
+		/** \brief node of a grid point
+		 *  \param[in] id The grid point (see o_graph::Map::get_id(..))
+		 *  \return node of the grid point; no_node_ if it isn't traversable
+		 */
+		inline int get_node(const unsigned int &id) const {
+			return node_of_cell_[id];
+		}
+
+		int FindEdge(const unsigned int &a, const unsigned int &b) const;
+		int UnpackEdge(const unsigned int &a, const unsigned int &b, int *pOutBuffer) const;
+		std::size_t get_memory_footprint() const;
+
+		const int width_;                        //< width of the map
+		const int height_;                       //< height of the map
+		unsigned int n_nodes_;                   //< number of nodes (traversable grid points)
+		unsigned int n_shortcuts_;               //< number of shortcut edges
+		std::vector<int> node_of_cell_;          //< node of every grid point (no_node_ if blocked)
+		std::vector<unsigned int> cell_of_node_; //< grid point of every node
+		std::vector<unsigned int> first_edge_;   //< first upward edge of every node (n_nodes_+1 entries)
+		std::vector<unsigned int> edge_head_;    //< higher ranked end of every edge
+		std::vector<int> edge_weight_;           //< length of every edge
+		std::vector<int> edge_middle_;           //< bypassed node of every shortcut (no_middle_ for grid moves)
+		std::vector<unsigned int> edge_children_;//< edges (lower end, middle) and (middle, upper end) of every shortcut
+
+		static const int no_node_ = -1;              //< node of blocked grid points
+		static const int no_middle_ = -1;            //< middle of edges that aren't shortcuts
+		static const int max_witness_settled_ = 64;  //< limit of a witness search
+
+	protected :
+		ContractionHierarchy();
+		ContractionHierarchy(const ContractionHierarchy &);
+		ContractionHierarchy &operator=(const ContractionHierarchy &);
+	}; // END OF CLASS ContractionHierarchy
+
+
+	std::shared_ptr<const ContractionHierarchy> RegisterContractionHierarchy(const unsigned char *data, const int &width, const int &height);
+	void UnregisterContractionHierarchy(const unsigned char *data);
+	std::shared_ptr<const ContractionHierarchy> FindContractionHierarchy(const unsigned char *data, const int &width, const int &height);
+
+
+	/** \brief Interface to use the contraction hierarchy of a map
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \return Returns the length of the shortest path between Start and
+	 *  Target, or -1 if no such path exists
+	 *
+	 *  \note Without a registered ContractionHierarchy for pMap the query is
+	 *  answered by astar::FindPath(..).
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize);
+
+
+	/** \brief Interface to use the contraction hierarchy with additional diagnostic capabilities
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[out] nodes_expanded nodes settled by both upward searches
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+} // END OF NAMESPACE ch
+
+#endif // END OF CONTRACTION_HIERARCHY_HPP_
@@ -0,0 +1,142 @@
+/** \file
+ * 		CorridorGraph.hpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (search on a corridor contracted map)
+ *
+ *  \details
+ *  	Mazes with corridor width 1 consist mostly of grid points with exactly two
+ *  	traversable neighbours. Expanding them one by one is pure overhead: there is
+ *  	only one way to go. Class CorridorGraph keeps the junctions and dead ends
+ *  	of a map as nodes and collapses every corridor between them into one
+ *  	weighted edge. A query is an A* search on this sparse graph; start and
+ *  	target inside a corridor are attached to the ends of their corridor on the
+ *  	fly, and the resulting path is walked back along the corridors into grid points.
+ *
+ *  	The graph of a map is built once and registered by the maps data pointer
+ *  	(see RegisterCorridorGraph(..) and Registry.hpp). Maps with wide corridors
+ *  	hardly contract (maze512-2 and wider: about one node per traversable grid
+ *  	point), so no graph is registered for them and queries fall back to AStar.
+ */
+
+#pragma once
+#ifndef CORRIDOR_GRAPH_HPP_
+#define CORRIDOR_GRAPH_HPP_
+
+#include <memory>  // shared ownership of registered graphs
+#include <vector>  // compact graph arrays
+
+namespace corridor
+{
+
+	/** \brief Map with corridors contracted to weighted edges
+	 *
+	 *  \details Nodes are the traversable grid points with less or more than two
+	 *  traversable neighbours (dead ends, junctions, isolated grid points); cycles
+	 *  without such a grid point get one arbitrary node. Every other traversable
+	 *  grid point lies in exactly one corridor, a chain of grid points from node
+	 *  corridor_tail_[c] to node corridor_head_[c] with corridor_length_[c] moves
+	 *  (two adjacent nodes form a corridor of length 1 without inner grid points).
+	 *
+	 *  Arcs in compressed row format: the arcs of node v are first_arc_[v] .. first_arc_[v+1]-1,
+	 *  arc a leads to arc_head_[a] through corridor arc_corridor_[a]/2 (backwards from
+	 *  its head if arc_corridor_[a] is odd). Corridors from a node to itself get no arcs.
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	O(width*height)
+	 *  construction|	O(width*height)
+	 *  query		|	O(nodes*log(nodes) + path length)
+	 *
+	 *  \note The graph is only valid as long as the map data doesn't change.
+	 */
+	class CorridorGraph
+	{
+	public :
+		explicit CorridorGraph(const int &width, const int &height, const unsigned char *data);
+
+		int FindPath(const unsigned int &start, const unsigned int &target,
+				int *pOutBuffer, const int &nOutBufferSize, unsigned int &nodes_expanded) const;
+		std::size_t get_memory_footprint() const;
+
+		const int width_;                           //< width of the map
+		const int height_;                          //< height of the map
+		const unsigned char *data_;                 //< grid data of the map (owned by caller)
+		unsigned int n_nodes_;                      //< number of nodes
+		std::vector<int> node_of_cell_;             //< node of every grid point (no_node_ for corridors and blocked grid points)
+		std::vector<unsigned int> cell_of_node_;    //< grid point of every node
+		std::vector<int> corridor_of_cell_;         //< corridor of every inner grid point (no_corridor_ otherwise)
+		std::vector<int> position_;                 //< number of moves from the corridors tail to an inner grid point
+		std::vector<unsigned int> corridor_tail_;   //< node at the start of every corridor
+		std::vector<unsigned int> corridor_head_;   //< node at the end of every corridor
+		std::vector<int> corridor_length_;          //< number of moves from tail to head
+		std::vector<unsigned int> corridor_first_;  //< grid point after the tail (the head for length 1)
+		std::vector<unsigned int> corridor_last_;   //< grid point before the head (the tail for length 1)
+		std::vector<unsigned int> first_arc_;       //< first arc of every node (n_nodes_+1 entries)
+		std::vector<unsigned int> arc_head_;        //< node every arc leads to
+		std::vector<int> arc_weight_;               //< number of moves of every arc
+		std::vector<unsigned int> arc_corridor_;    //< 2*corridor (+1 if the corridor is walked backwards)
+
+		static const int no_node_ = -1;      //< node of corridor and blocked grid points
+		static const int no_corridor_ = -1;  //< corridor of nodes and blocked grid points
+		static const int min_tiles_per_node_ = 2;  //< contraction below which the graph isn't registered
+
+	protected :
+		CorridorGraph();
+		CorridorGraph(const CorridorGraph &);
+		CorridorGraph &operator=(const CorridorGraph &);
+
+		bool is_traversable(const int &id) const;
+		unsigned int OtherNeighbour(const unsigned int &id, const unsigned int &previous) const;
+		unsigned int NeighbourTowards(const unsigned int &id, const bool &to_tail) const;
+		void AddCorridors(const unsigned int &id);
+		void AddCorridor(const unsigned int &tail, const unsigned int &first);
+		int Walk(unsigned int previous, unsigned int current, const unsigned int &stop,
+				int *pOutBuffer, const int &nOutBufferSize, int n) const;
+	}; // END OF CLASS CorridorGraph
+
+
+	std::shared_ptr<const CorridorGraph> RegisterCorridorGraph(const unsigned char *data, const int &width, const int &height);
+	void UnregisterCorridorGraph(const unsigned char *data);
+	std::shared_ptr<const CorridorGraph> FindCorridorGraph(const unsigned char *data, const int &width, const int &height);
+
+
+	/** \brief Interface to search the corridor graph of a map
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \return Returns the length of the shortest path between Start and
+	 *  Target, or -1 if no such path exists
+	 *
+	 *  \note Without a registered CorridorGraph for pMap the query is answered by
+	 *  astar::FindPath(..).
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize);
+
+
+	/** \brief Interface to search the corridor graph with additional diagnostic capabilities
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[out] nodes_expanded number of expanded nodes of the corridor graph
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+} // END OF NAMESPACE corridor
+
+#endif // END OF CORRIDOR_GRAPH_HPP_
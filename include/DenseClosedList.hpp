@@ -0,0 +1,139 @@
+/** \file
+ * 		DenseClosedList.hpp
+ *
+ *  \brief
+ *  	Provides a closed list for dense ids (class DenseClosedList)
+ *
+ *  \details
+ *  	DenseClosedList is an alternative to class RedBlackTree (see RedBlackTree.hpp)
+ *  	when used as closed list in a graph search whose node ids are dense
+ *  	(e.g. the ids of a grid map, see Map::get_id(..)).
+ *  	Membership is stored as a generation stamp per id (see GenerationStamps.hpp),
+ *  	so a lookup is a single compare, an insertion doesn't allocate a tree node
+ *  	and clearing the list doesn't touch the stamps.
+ */
+
+#pragma once
+#ifndef DENSE_CLOSED_LIST_HPP_
+#define DENSE_CLOSED_LIST_HPP_
+
+#include <vector>               // stored items (for traversal)
+#include "GenerationStamps.hpp"  // membership of ids
+
+namespace o_data_structures
+{
+
+	/** \brief Closed list for dense ids backed by generation stamps
+	 *
+	 *  \details The interface mimics the part of class RedBlackTree that is used
+	 *  by a pathfinder (insert(..), find(..), traversal of stored items).
+	 *  - stamps_ : one stamp per id in the range [0, n_ids)
+	 *  - items_ : the inserted data (needed for traversal)
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	O(n_ids + n)
+	 *  find		|	O(1)
+	 *  insert		|	O(1) (amortized)
+	 *  clear		|	O(1) (O(n_ids) on wrap around of the generation counter)
+	 *
+	 *  \note an id must not be inserted twice
+	 */
+	template <class DataType, typename StampType = unsigned short>
+	class DenseClosedList
+	{
+	public :
+		DenseClosedList();
+		explicit DenseClosedList(const unsigned int &n_ids);
+
+		void insert(const unsigned int &id, const DataType &data);
+		void clear();
+
+		/** \brief makes ids up to n_ids-1 storable (never shrinks)
+		 *  \param[in] n_ids number of distinct ids
+		 */
+		void resize(const unsigned int &n_ids) {
+			stamps_.resize(n_ids);
+		}
+
+		/** \brief checks if id is on the list
+		 *  \param[in] id The id to look for
+		 *  \return true if id was inserted; false otherwise
+		 */
+		inline bool find(const unsigned int &id) const {
+			return stamps_.is_set(id);
+		}
+
+		template <typename Func>
+		void traverse(Func func);
+
+		GenerationStamps<StampType> stamps_;  //< membership of every id
+		std::vector<DataType> items_;         //< inserted data (in order of insertion)
+
+	protected :
+		DenseClosedList(const DenseClosedList &);
+		DenseClosedList &operator=(const DenseClosedList &);
+	}; // END OF CLASS DenseClosedList
+
+
+
+	//! \brief Constructor (call resize(..) before use)
+	template <class DataType, typename StampType>
+	DenseClosedList<DataType,StampType>::DenseClosedList() :
+			stamps_()
+	{
+		// nothing to do here
+	}
+
+
+	/** \brief Constructor
+	 *  \param[in] n_ids number of distinct ids (ids range from 0 to n_ids-1)
+	 */
+	template <class DataType, typename StampType>
+	DenseClosedList<DataType,StampType>::DenseClosedList(const unsigned int &n_ids) :
+			stamps_(n_ids)
+	{
+		// nothing to do here
+	}
+
+
+	/** \brief puts an id (and its data) on the list
+	 *  \param[in] id The id to be stored
+	 *  \param[in] data Data associated with id
+	 */
+	template <class DataType, typename StampType>
+	void DenseClosedList<DataType,StampType>::insert(const unsigned int &id, const DataType &data)
+	{
+		stamps_.set(id);
+		items_.push_back(data);
+		return;
+	}
+
+
+	/** \brief removes all ids from the list
+	 *  \details starts a new generation of stamps (no sweep over the ids)
+	 */
+	template <class DataType, typename StampType>
+	void DenseClosedList<DataType,StampType>::clear()
+	{
+		stamps_.next_generation();
+		items_.clear();
+		return;
+	}
+
+
+	/** \brief applies func to the data of every stored item
+	 *  \param[in] func Function-pointer or lambda-function taking a DataType
+	 */
+	template <class DataType, typename StampType>
+	template <typename Func>
+	void DenseClosedList<DataType,StampType>::traverse(Func func)
+	{
+		for(std::size_t i=0; i<items_.size(); ++i)
+			func(items_[i]);
+		return;
+	}
+
+} // END OF NAMESPACE o_data_structures
+
+#endif // END OF DENSE_CLOSED_LIST_HPP_
@@ -0,0 +1,127 @@
+/** \file
+ * 		FlowField.hpp
+ *
+ *  \brief
+ *  	Provides one-to-many pathfinding (flow fields)
+ *
+ *  \details
+ *  	Units heading for the same rally point all need paths to the same target.
+ *  	Instead of one search per unit, class FlowField runs one breadth first
+ *  	search backwards from the target (or from several targets) over the whole
+ *  	map and stores the first move of a shortest path for every grid point.
+ *  	Every unit then follows the moves in O(path length).
+ *
+ *  	Fields are immutable after construction, so one field can be read by any
+ *  	number of threads. Fields for single targets can be registered by the maps
+ *  	data pointer and the target (see RegisterFlowField(..)) and are then used by
+ *  	flowfield::FindPath(..). Registered fields are shared: a field that is
+ *  	replaced while queries follow it lives until the last of them is done.
+ */
+
+#pragma once
+#ifndef FLOW_FIELD_HPP_
+#define FLOW_FIELD_HPP_
+
+#include <memory>  // shared ownership of registered fields
+#include <vector>  // move of every grid point
+
+namespace flowfield
+{
+
+	/** \brief First moves of shortest paths from every grid point to the nearest target
+	 *
+	 *  \details One byte per grid point: the move towards the target (0: x+1, 1: x-1,
+	 *  2: y+1, 3: y-1), target_ for targets and unreached_ for grid points that are
+	 *  blocked or can't reach any target.
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	width*height bytes
+	 *  construction|	O(width*height)
+	 *  query		|	O(path length)
+	 */
+	class FlowField
+	{
+	public :
+		explicit FlowField(const int &width, const int &height, const unsigned char *data,
+				const std::vector<unsigned int> &targets);
+
+		int FindPath(const unsigned int &start, int *pOutBuffer, const int &nOutBufferSize) const;
+		int get_distance(const unsigned int &id) const;
+		std::size_t get_memory_footprint() const;
+
+		/** \brief next grid point on a shortest path to the nearest target
+		 *  \param[in] id the grid point
+		 *  \return the next grid point; id itself for targets; -1 if no target can be reached
+		 */
+		inline int get_next(const unsigned int &id) const {
+			const unsigned char move = moves_[id];
+			if (move >= target_)
+				return (move == target_) ? (int) id : -1;
+			return id + offsets_[move];
+		}
+
+		const int width_;                   //< width of the map
+		const int height_;                  //< height of the map
+		const unsigned char *data_;         //< grid data of the map (owned by caller)
+		std::vector<unsigned int> targets_; //< the targets (sorted)
+		std::vector<unsigned char> moves_;  //< move towards the nearest target of every grid point
+
+		static const unsigned char target_ = 4;       //< move of targets
+		static const unsigned char unreached_ = 255;  //< move of grid points without path to a target
+
+	protected :
+		FlowField();
+		FlowField(const FlowField &);
+		FlowField &operator=(const FlowField &);
+
+		int offsets_[4];  //< change of the id by every move
+	}; // END OF CLASS FlowField
+
+
+	std::shared_ptr<const FlowField> RegisterFlowField(const unsigned char *data, const int &width, const int &height,
+			const unsigned int &target);
+	void UnregisterFlowField(const unsigned char *data, const unsigned int &target);
+	std::shared_ptr<const FlowField> FindFlowField(const unsigned char *data, const int &width, const int &height,
+			const unsigned int &target);
+
+
+	/** \brief Interface to follow the flow field registered for the target
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \return Returns the length of the shortest path between Start and
+	 *  Target, or -1 if no such path exists or it doesn't fit into pOutBuffer
+	 *
+	 *  \note Without a FlowField registered for pMap and the target the query is answered by
+	 *  astar::FindPath(..).
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize);
+
+
+	/** \brief Interface to follow a flow field with additional diagnostic capabilities
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[out] nodes_expanded 0 if the registered field was used (expansions of astar::FindPath(..) otherwise)
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+} // END OF NAMESPACE flowfield
+
+#endif // END OF FLOW_FIELD_HPP_
@@ -0,0 +1,146 @@
+/** \file
+ * 		FringeSearch.hpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities with little memory (fringe search)
+ *
+ *  \details
+ *  	AStar keeps a MapNode for every generated grid point in its open and
+ *  	closed lists. Class FringeSearch replaces the priority queue by an
+ *  	iteratively raised f-threshold and two lists (now / later) of grid point ids,
+ *  	and the closed list by a bitmap. Memory is O(frontier) plus 3 bits per grid
+ *  	point (visited bit and direction of the last move), so worker processes with
+ *  	little memory can serve the largest maps.
+ *
+ * 	\references
+ * 		- Y. Bjoernsson, M. Enzenberger, R. C. Holte, J. Schaeffer: Fringe Search:
+ * 		  Beating A* at Pathfinding on Game Maps. IEEE CIG 2005, S. 125-132.
+ *  \sa
+ *  	AStar.hpp
+ */
+
+#pragma once
+#ifndef FRINGE_SEARCH_HPP_
+#define FRINGE_SEARCH_HPP_
+
+#include <vector>   // lists and bitmaps
+#include "Map.hpp"  // A class to represent the game map
+
+namespace fringe
+{
+
+	/** \brief Memory used by class FringeSearch that is kept between searches
+	 *
+	 *  \details Only the visited bitmap is cleared per search (O(width*height/64));
+	 *  the move bits are valid for visited grid points only.
+	 *
+	 *  \note A workspace must not be used by two searches at the same time.
+	 *  The interface functions use one workspace per thread.
+	 */
+	struct Workspace
+	{
+		Workspace() { }
+
+		std::vector<unsigned long long> visited_;  //< one bit per grid point: reached with final path cost
+		std::vector<unsigned char> moves_;         //< two bits per grid point: last move of the path to it
+		std::vector<unsigned int> now_;            //< grid points to be expanded in this iteration
+		std::vector<unsigned int> later_;          //< (id << 2 | move) of grid points beyond the threshold
+
+	private :
+		Workspace(const Workspace &);
+		Workspace &operator=(const Workspace &);
+	};
+
+
+	/** \brief provides pathfinding capabilities with O(frontier) memory (fringe search)
+	 *
+	 *  \details All moves cost 1 and the manhattan distance is consistent, so the f-value
+	 *  of a path grows by 0 or 2 with every move. The threshold is raised in steps of 2:
+	 *  - iteration T expands all grid points with f == T depth first (now list)
+	 *  - successors with f == T+2 are put on the later list, which becomes the now list
+	 *    of the next iteration
+	 *  Every grid point expanded in iteration T has path cost T - h, so the first
+	 *  path that reaches it with f == T is a shortest one: a visited bit is a complete
+	 *  closed list and no path cost has to be stored. A grid point may be on the later
+	 *  list several times; surplus entries are skipped once it is visited.
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	O(frontier) + 3 bits per grid point
+	 *  Time		|	O(width*height)
+	 */
+	class FringeSearch
+	{
+	public :
+		explicit FringeSearch(o_graph::Map &map, int *p_buffer, int size_buffer);
+		explicit FringeSearch(o_graph::Map &map, int *p_buffer, int size_buffer, Workspace &workspace);
+		int FindPath(const int &iS, const int &jS, const int &iT, const int &jT);
+
+		unsigned int nodes_expanded_;  //< for diagnostics
+		std::size_t max_frontier_;     //< largest size of both lists (for diagnostics)
+
+	protected :
+		FringeSearch();
+		FringeSearch(const FringeSearch &);
+		FringeSearch &operator=(const FringeSearch &);
+
+		/** \brief checks the visited bit of a grid point
+		 *  \param[in] id The grid point
+		 *  \return true if visited
+		 */
+		inline bool is_visited(const unsigned int &id) const {
+			return (visited_[id >> 6] >> (id & 63)) & 1ULL;
+		}
+
+		void Visit(const unsigned int &id, const unsigned int &move);
+		int BacktrackPath(const unsigned int &target_id, const int &path_length) const;
+
+		int output_buffer_size_;                 //< size of Buffer for returning computed path
+		int *p_output_buffer_;                   //< pointer to buffer for returning computed path (memory owned by caller)
+		o_graph::Map &map_;                      //< Reference to the game map (provided by caller)
+		std::vector<unsigned long long> &visited_;  //< visited bitmap (owned by a Workspace)
+		std::vector<unsigned char> &moves_;         //< move bits (owned by a Workspace)
+		std::vector<unsigned int> &now_;            //< now list (owned by a Workspace)
+		std::vector<unsigned int> &later_;          //< later list (owned by a Workspace)
+	}; // END OF CLASS FringeSearch
+
+
+	/** \brief Interface to use the fringe search
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \return Returns the length of the shortest path between Start and
+	 *  Target, or -1 if no such path exists
+	 *
+	 *  \note If the shortest path consists of more visited nodes than
+	 *  can be stored in pOutBuffer all surplus nodes are discarded.
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize);
+
+
+	/** \brief Interface to use the fringe search with additional diagnostic capabilities
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[out] nodes_expanded number of expanded grid points
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+} // END OF NAMESPACE fringe
+
+#endif // END OF FRINGE_SEARCH_HPP_
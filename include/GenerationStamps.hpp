@@ -0,0 +1,143 @@
+/** \file
+ * 		GenerationStamps.hpp
+ *
+ *  \brief
+ *  	Provides a set of dense ids that can be emptied in O(1) (class GenerationStamps)
+ *
+ *  \details
+ *  	Instead of a flag per id GenerationStamps stores a stamp per id.
+ *  	An id is in the set if its stamp equals the current generation.
+ *  	Starting a new generation (e.g. for a new search) empties the set
+ *  	without touching the stamps; the stamps are wiped only when the
+ *  	generation counter wraps around.
+ */
+
+#pragma once
+#ifndef GENERATION_STAMPS_HPP_
+#define GENERATION_STAMPS_HPP_
+
+namespace o_data_structures
+{
+
+	/** \brief Set of dense ids with O(1) reset by generation counting
+	 *
+	 *  \details
+	 *  - stamps_[id] == generation_ <=> id is in the set
+	 *  - next_generation() empties the set in O(1); every
+	 *    2^(8*sizeof(StampType))-1 generations all stamps are wiped in O(n_ids_)
+	 *  - resize(..) only grows the set (existing stamps are kept)
+	 *
+	 *  StampType should be an unsigned integer type. Smaller types save memory
+	 *  (and cache) but wrap around more often.
+	 */
+	template <typename StampType = unsigned short>
+	class GenerationStamps
+	{
+	public :
+		GenerationStamps();
+		explicit GenerationStamps(const unsigned int &n_ids);
+		~GenerationStamps();
+
+		void resize(const unsigned int &n_ids);
+		void next_generation();
+
+		/** \brief checks if id is in the set
+		 *  \param[in] id The id to look for
+		 *  \return true if id was set during the current generation
+		 */
+		inline bool is_set(const unsigned int &id) const {
+			return stamps_[id] == generation_;
+		}
+
+		/** \brief puts id into the set
+		 *  \param[in] id The id to be stored
+		 */
+		inline void set(const unsigned int &id) {
+			stamps_[id] = generation_;
+		}
+
+		/** \brief removes id from the set
+		 *  \param[in] id The id to be removed
+		 */
+		inline void unset(const unsigned int &id) {
+			stamps_[id] = 0;
+		}
+
+		unsigned int n_ids_;       //< number of distinct ids (size of stamps_)
+		StampType generation_;     //< current generation (never 0)
+		StampType *stamps_;        //< generation in which each id was set last
+		unsigned long long wipes_; //< number of full wipes (diagnostics)
+
+	protected :
+		GenerationStamps(const GenerationStamps &);
+		GenerationStamps &operator=(const GenerationStamps &);
+	}; // END OF CLASS GenerationStamps
+
+
+
+	//! \brief Constructor (empty set without ids)
+	template <typename StampType>
+	GenerationStamps<StampType>::GenerationStamps() :
+			n_ids_(0), generation_(1), stamps_(0L), wipes_(0)
+	{
+		// nothing to do here
+	}
+
+
+	/** \brief Constructor
+	 *  \param[in] n_ids number of distinct ids (ids range from 0 to n_ids-1)
+	 */
+	template <typename StampType>
+	GenerationStamps<StampType>::GenerationStamps(const unsigned int &n_ids) :
+			n_ids_(n_ids), generation_(1), wipes_(0)
+	{
+		stamps_ = new StampType[n_ids_]();
+	}
+
+
+	//! \brief Destructor
+	template <typename StampType>
+	GenerationStamps<StampType>::~GenerationStamps()
+	{
+		delete[] stamps_;
+	}
+
+
+	/** \brief Increases the number of ids (never shrinks)
+	 *  \param[in] n_ids new number of distinct ids
+	 */
+	template <typename StampType>
+	void GenerationStamps<StampType>::resize(const unsigned int &n_ids)
+	{
+		if (n_ids <= n_ids_)
+			return;
+		StampType *tmp = new StampType[n_ids]();
+		for(unsigned int id=0; id<n_ids_; ++id)
+			tmp[id] = stamps_[id];
+		delete[] stamps_;
+		stamps_ = tmp;
+		n_ids_ = n_ids;
+		return;
+	}
+
+
+	/** \brief empties the set
+	 *  \details O(1) unless the generation counter wraps around
+	 */
+	template <typename StampType>
+	void GenerationStamps<StampType>::next_generation()
+	{
+		++generation_;
+		if (generation_ == 0)
+		{
+			for(unsigned int id=0; id<n_ids_; ++id)
+				stamps_[id] = 0;
+			generation_ = 1;
+			++wipes_;
+		}
+		return;
+	}
+
+} // END OF NAMESPACE o_data_structures
+
+#endif // END OF GENERATION_STAMPS_HPP_
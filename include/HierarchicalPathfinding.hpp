@@ -0,0 +1,191 @@
+/** \file
+ * 		HierarchicalPathfinding.hpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (hierarchical pathfinding, HPA*)
+ *
+ *  \details
+ *  	The game map is split into square clusters. Entrances between adjacent
+ *  	clusters become nodes of a small abstract graph (class ClusterGraph)
+ *  	whose edges are the moves across cluster borders and the precomputed
+ *  	distances between the entrances of a cluster. A query searches the
+ *  	abstract graph and refines it into grid moves with AStar restricted to
+ *  	one cluster at a time (class HierarchicalPath). Refinement is lazy:
+ *  	a caller that only needs the first moves of a long path only refines
+ *  	the first clusters.
+ *
+ *  	The abstract graph of a map is computed once and registered by the maps
+ *  	data pointer (see RegisterClusterGraph(..) and Registry.hpp).
+ *
+ *  \note The paths are near optimal, not optimal: a path crosses a cluster border
+ *  only at the chosen entrance points (see ClusterGraph).
+ *
+ * 	\references
+ * 		- A. Botea, M. Mueller, J. Schaeffer: Near Optimal Hierarchical Path-Finding.
+ * 		  Journal of Game Development 1, 2004, S. 7-28.
+ */
+
+#pragma once
+#ifndef HIERARCHICAL_PATHFINDING_HPP_
+#define HIERARCHICAL_PATHFINDING_HPP_
+
+#include <memory>  // shared ownership of registered graphs
+#include <vector>  // abstract graph, waypoints
+
+namespace hpa
+{
+
+	/** \brief Abstract graph of a clustered game map
+	 *
+	 *  \details The map is split into clusters of cluster_size_ x cluster_size_ grid points
+	 *  (clusters at the right and lower border may be smaller).
+	 *  Along the border of two adjacent clusters every maximal run of grid points
+	 *  that are traversable on both sides forms an entrance. An entrance shorter
+	 *  than max_single_transition_ gets one transition in its middle, longer
+	 *  entrances get one transition at each end. Both grid points of a transition
+	 *  become abstract nodes connected by an edge of cost 1.
+	 *  All abstract nodes of a cluster are connected by edges whose cost is their
+	 *  distance within the cluster (breadth first search restricted to the cluster).
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	O(width*height/cluster_size)
+	 *  construction|	O(width*height*entrances per cluster)
+	 *
+	 *  \note The graph is only valid as long as the map data doesn't change.
+	 */
+	class ClusterGraph
+	{
+	public :
+		//! \brief edge of the abstract graph
+		struct Edge
+		{
+			unsigned int target_;  //< index of the abstract node the edge leads to
+			int cost_;             //< number of moves
+		};
+
+		//! \brief abstract node (transition point at a cluster border)
+		struct Node
+		{
+			unsigned int id_;          //< grid point of the node (see o_graph::Map::get_id(..))
+			unsigned int cluster_;     //< cluster containing the grid point
+			std::vector<Edge> edges_;  //< outgoing edges
+		};
+
+		explicit ClusterGraph(const int &width, const int &height, const unsigned char *data,
+				const int &cluster_size = 16);
+
+		/** \brief cluster of a grid point
+		 *  \param[in] x x-coordinate of the grid point
+		 *  \param[in] y y-coordinate of the grid point
+		 *  \return index of the cluster
+		 */
+		inline unsigned int get_cluster(const int &x, const int &y) const {
+			return (x/cluster_size_) + (y/cluster_size_)*n_clusters_x_;
+		}
+
+		int ClusterDistances(const unsigned int &origin, std::vector<int> &distances) const;
+		int RefineSegment(const unsigned int &from, const unsigned int &to, std::vector<int> &moves,
+				unsigned int &nodes_expanded) const;
+		unsigned int get_local_index(const unsigned int &id) const;
+
+		const int width_;                 //< width of the map
+		const int height_;                //< height of the map
+		const unsigned char *data_;       //< grid data of the map (owned by caller)
+		const int cluster_size_;          //< extent of a cluster in x- and y-direction
+		int n_clusters_x_;                //< number of clusters in x-direction
+		int n_clusters_y_;                //< number of clusters in y-direction
+		std::vector<Node> nodes_;         //< all abstract nodes
+		std::vector< std::vector<unsigned int> > cluster_nodes_;  //< abstract nodes of every cluster
+		static const int max_single_transition_ = 6;  //< shorter entrances get a single transition
+
+	protected :
+		ClusterGraph();
+		ClusterGraph(const ClusterGraph &);
+		ClusterGraph &operator=(const ClusterGraph &);
+
+		void AddEntrances(const int &x0, const int &y0, const int &dx, const int &dy,
+				const int &length, std::vector<int> &node_of);
+		unsigned int AddNode(const unsigned int &id, std::vector<int> &node_of);
+		void AddEdge(const unsigned int &a, const unsigned int &b, const int &cost);
+	}; // END OF CLASS ClusterGraph
+
+
+
+	/** \brief Result of a hierarchical search that is refined on demand
+	 *
+	 *  \details Search(..) finds the abstract path and its length. The path is kept
+	 *  as a list of waypoints (start, abstract nodes, target); consecutive waypoints
+	 *  are either neighbours on the grid or lie in the same cluster. Refine(..)
+	 *  delivers the next moves and refines one segment between waypoints at a time.
+	 *
+	 *  \code
+	 *  	hpa::HierarchicalPath path;
+	 *  	int length = path.Search(*graph, nStartX, nStartY, nTargetX, nTargetY);
+	 *  	int n_moves = path.Refine(pOutBuffer, 8);  // first 8 moves only
+	 *  \endcode
+	 */
+	class HierarchicalPath
+	{
+	public :
+		HierarchicalPath();
+
+		int Search(const ClusterGraph &graph, const int &nStartX, const int &nStartY,
+				const int &nTargetX, const int &nTargetY);
+		int Refine(int *pOutBuffer, const int &n_moves);
+
+		const ClusterGraph *p_graph_;        //< graph of the last search (owned by caller)
+		int length_;                         //< length of the path (-1 if no path exists)
+		std::vector<unsigned int> waypoints_;//< start, abstract nodes and target (grid ids)
+		std::size_t next_waypoint_;          //< waypoint the current segment leads to
+		std::vector<int> segment_;           //< moves of the current segment
+		std::size_t segment_position_;       //< next undelivered move of segment_
+		unsigned int nodes_expanded_;        //< for diagnostics
+	}; // END OF CLASS HierarchicalPath
+
+
+	std::shared_ptr<const ClusterGraph> RegisterClusterGraph(const unsigned char *data, const int &width, const int &height);
+	void UnregisterClusterGraph(const unsigned char *data);
+	std::shared_ptr<const ClusterGraph> FindClusterGraph(const unsigned char *data, const int &width, const int &height);
+
+
+	/** \brief Interface to use hierarchical pathfinding
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \return Returns the length of the path found between Start and
+	 *  Target, or -1 if no such path exists
+	 *
+	 *  \note Without a registered ClusterGraph for pMap the query is answered by
+	 *  astar::FindPath(..).
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize);
+
+
+	/** \brief Interface to use hierarchical pathfinding with additional diagnostic capabilities
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[out] nodes_expanded abstract nodes expanded plus grid points visited by
+	 *  cluster searches and refinement
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+} // END OF NAMESPACE hpa
+
+#endif // END OF HIERARCHICAL_PATHFINDING_HPP_
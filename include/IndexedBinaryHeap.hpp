@@ -0,0 +1,380 @@
+/** \file
+ * 		IndexedBinaryHeap.hpp
+ *
+ *  \brief
+ *  	Provides a binary minimum heap with id -> position lookup (class IndexedBinaryHeap)
+ *
+ *  \details
+ *  	IndexedBinaryHeap is a sibling of class BinaryHeap (see BinaryHeap.hpp).
+ *  	Every item carries a dense id (e.g. the id of a map node) and the heap
+ *  	keeps track of the position of every id within IndexedBinaryHeap::A_.
+ *  	- membership test by id in O(1) (contains(..))
+ *  	- access of an items data by id in O(1) (data(..))
+ *  	- change of an items key by id in O(log n) (change_key_by_id(..))
+ */
+
+#pragma once
+#ifndef INDEXEDBINARYHEAP_HPP_
+#define INDEXEDBINARYHEAP_HPP_
+
+//#define BINARYHEAP_CAUTIOUS    // unset if STL isn't available
+
+#if defined (BINARYHEAP_CAUTIOUS)
+#include <stdexcept>           // exception handling
+#endif
+
+#include "BinaryHeap.hpp"      // index arithmetics left(..), right(..), parent(..)
+#include "BinaryHeapNode.hpp"  // NodeType used in class IndexedBinaryHeap
+
+namespace o_data_structures
+{
+
+	////////////////////////////////////////////////////////////
+	/// CLASS DECLARATION //////////////////////////////////////
+	////////////////////////////////////////////////////////////
+
+
+	/** \brief Binary minimum heap whose items can be addressed by a dense id
+	 *
+	 *  \details Items are stored in the same layout as in class BinaryHeap
+	 *  (IndexedBinaryHeap::A_ with n_items_ valid entries, minimum at A_[0]).
+	 *  Additionally every item is associated with an id from the range [0, n_ids_).
+	 *  Two arrays are kept in sync by every swap(..) (and therefore by every
+	 *  sift_up(..) and sift_down(..)):
+	 *  - ids_[i] : id of the item stored at A_[i]
+	 *  - position_[id] : index of item id within A_ (or not_in_heap_)
+	 *
+	 *  An id can be stored at most once at a time.
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	O(n + n_ids)
+	 *  contains	|	O(1)
+	 *  insert		|	O(log n)
+	 *  Delete		|	O(log n)
+	 *  change key	|	O(log n)
+	 *  clear		|	O(n)
+	 *
+	 *  \note position_ is allocated (and initialized) once for all n_ids ids;
+	 *  clear() only resets ids that are still stored in the heap.
+	 *  A heap that is reused by consecutive searches therefore never
+	 *  touches all n_ids positions again.
+	 */
+	template <typename KeyType, typename DataType>
+	class IndexedBinaryHeap
+	{
+	public :
+		typedef BinaryHeapNode<KeyType,DataType> NodeType;
+		explicit IndexedBinaryHeap(const unsigned int &n_ids = 0);
+		~IndexedBinaryHeap();
+
+		void resize_ids(const unsigned int &n_ids);
+
+		void insert(const unsigned int &id, const KeyType &newkey, const DataType &data);
+		void remove(const unsigned int &i);
+		DataType pop(const unsigned int &i);
+		void change_key(const unsigned int &i, const KeyType &new_key);
+		void change_key_by_id(const unsigned int &id, const KeyType &new_key);
+		void clear();
+
+		bool is_empty(void) const {return n_items_==0;}
+
+		/** \brief checks if an item with a certain id is stored in the heap
+		 *  \param[in] id The id to look for
+		 *  \return true if the item is stored in the heap; false otherwise
+		 */
+		inline bool contains(const unsigned int &id) const {
+			return position_[id] != not_in_heap_;
+		}
+
+		/** \brief position of an item within IndexedBinaryHeap::A_
+		 *  \param[in] id The id of the item (must be stored in the heap)
+		 *  \return index of the item within A_
+		 */
+		inline unsigned int position(const unsigned int &id) const {
+			return position_[id];
+		}
+
+		/** \brief data field of an item
+		 *  \param[in] id The id of the item (must be stored in the heap)
+		 *  \return the items data field
+		 */
+		inline const DataType &data(const unsigned int &id) const {
+			return A_[position_[id]].data_;
+		}
+
+		static const unsigned int not_in_heap_ = 0 - 1;  //< position of ids not stored in the heap
+
+		NodeType *A_;             //< Array where heap elements get stored in (literally "The Tree")
+		unsigned int *ids_;       //< ids_[i] is the id of the item stored at A_[i]
+		unsigned int *position_;  //< position_[id] is the index of item id in A_
+		unsigned int max_items_;  //< Current size of A_ (maximum number of storable elements)
+		unsigned int n_items_;    //< Number of data nodes currently stored in A_
+		unsigned int n_ids_;      //< Number of distinct ids (size of position_)
+
+	protected :
+		IndexedBinaryHeap(const IndexedBinaryHeap &);
+		IndexedBinaryHeap &operator=(const IndexedBinaryHeap &);
+
+		// helper functions
+		void swap(const unsigned int &a, const unsigned int &b);
+		void resize(const unsigned int &new_max_items);
+		void sift_down(unsigned int i);
+		void sift_up(unsigned int i);
+	}; // END OF CLASS IndexedBinaryHeap<KeyType,DataType>
+
+
+
+
+	////////////////////////////////////////////////////////////
+	/// METHOD DEFINITIONS//////////// /////////////////////////
+	////////////////////////////////////////////////////////////
+
+
+	/** \brief Constructor
+	 *  \param[in] n_ids number of distinct ids (ids range from 0 to n_ids-1)
+	 */
+	template <typename KeyType, typename DataType>
+	IndexedBinaryHeap<KeyType,DataType>::IndexedBinaryHeap(const unsigned int &n_ids) :
+			max_items_(15), n_items_(0), n_ids_(n_ids)
+	{
+		A_ = new NodeType[max_items_];
+		ids_ = new unsigned int[max_items_];
+		position_ = new unsigned int[n_ids_];
+		for(unsigned int id=0; id<n_ids_; ++id)
+			position_[id] = not_in_heap_;
+	}
+
+
+	//! \brief Destructor
+	template <typename KeyType, typename DataType>
+	IndexedBinaryHeap<KeyType,DataType>::~IndexedBinaryHeap()
+	{
+		delete[] A_;
+		delete[] ids_;
+		delete[] position_;
+	}
+
+
+	/** \brief Increases the number of distinct ids (never shrinks)
+	 *  \details positions of stored items are kept
+	 *  \param[in] n_ids new number of distinct ids
+	 */
+	template <typename KeyType, typename DataType>
+	void IndexedBinaryHeap<KeyType,DataType>::resize_ids(const unsigned int &n_ids)
+	{
+		if (n_ids <= n_ids_)
+			return;
+		unsigned int *tmp = new unsigned int[n_ids];
+		for(unsigned int id=0; id<n_ids_; ++id)
+			tmp[id] = position_[id];
+		for(unsigned int id=n_ids_; id<n_ids; ++id)
+			tmp[id] = not_in_heap_;
+		delete[] position_;
+		position_ = tmp;
+		n_ids_ = n_ids;
+		return;
+	}
+
+
+	/** \brief Adds an item to the heap
+	 *  \param[in] id Id of the new item (mustn't be stored in the heap already)
+	 *  \param[in] newkey Search key of the new item
+	 *  \param[in] data Data field of the new item
+	 */
+	template <typename KeyType, typename DataType>
+	void IndexedBinaryHeap<KeyType,DataType>::insert(const unsigned int &id, const KeyType &newkey, const DataType &data)
+	{
+       #if defined(BINARYHEAP_CAUTIOUS)
+		if (id>=n_ids_)
+			throw std::runtime_error("insert: id out of bound\n");
+		if (contains(id))
+			throw std::runtime_error("insert: id already stored\n");
+       #endif
+		resize(n_items_+1);
+		A_[n_items_] = NodeType(newkey, data);
+		ids_[n_items_] = id;
+		position_[id] = n_items_;
+		++n_items_;
+		sift_up(n_items_-1);
+	}
+
+
+	/** \brief removes an item from the heap and returns its data field
+	 *  \param[in] i Index of the item to be removed from the heap
+	 *  \return Copy of the removed items data field
+	 */
+	template <typename KeyType, typename DataType>
+	DataType IndexedBinaryHeap<KeyType,DataType>::pop(const unsigned int &i)
+	{
+		DataType removedItem = A_[i].data_;
+		remove(i);
+		return removedItem;
+	}
+
+
+	/** \brief removes an item from the heap
+	 *  \details restores minimum heap condition and marks the id of the
+	 *  removed item as not stored
+	 *  \param[in] i Index of the item to be removed from the heap
+	 */
+	template <typename KeyType, typename DataType>
+	void IndexedBinaryHeap<KeyType,DataType>::remove(const unsigned int &i)
+	{
+       #if defined(BINARYHEAP_CAUTIOUS)
+		if (i>=n_items_)
+			throw std::runtime_error("remove: index i out of bound\n");
+       #endif
+		unsigned int lastIdx = n_items_-1;
+		swap(i,lastIdx);
+		position_[ids_[lastIdx]] = not_in_heap_;
+		--n_items_;
+
+		if ( i != lastIdx )
+		{
+			if ( i == 0 || A_[i] > A_[parent(i)] )
+				sift_down(i);
+			else
+				sift_up(i);
+		}
+		return;
+	}
+
+
+	/** \brief Changes the key of the item at index i and repositions it within the heap
+	 *  \param[in] i Index/position of the item
+	 *  \param[in] new_key New value key
+	 */
+	template <typename KeyType, typename DataType>
+	void IndexedBinaryHeap<KeyType,DataType>::change_key(const unsigned int &i, const KeyType &new_key)
+	{
+		if (new_key > A_[i].key_)
+		{
+			A_[i].key_ = new_key;
+			sift_down(i);
+		}
+		else if (new_key < A_[i].key_)
+		{
+			A_[i].key_ = new_key;
+			sift_up(i);
+		}
+		return;
+	}
+
+
+	/** \brief Changes the key of the item with a certain id
+	 *  \param[in] id The id of the item (must be stored in the heap)
+	 *  \param[in] new_key New value key
+	 */
+	template <typename KeyType, typename DataType>
+	void IndexedBinaryHeap<KeyType,DataType>::change_key_by_id(const unsigned int &id, const KeyType &new_key)
+	{
+       #if defined(BINARYHEAP_CAUTIOUS)
+		if (!contains(id))
+			throw std::runtime_error("change_key_by_id: id not stored\n");
+       #endif
+		change_key(position_[id], new_key);
+		return;
+	}
+
+
+	/** \brief removes all items from the heap
+	 *  \details Only ids of stored items are reset, so the cost is O(n) and not O(n_ids).
+	 *  Allocated memory is kept for further use.
+	 */
+	template <typename KeyType, typename DataType>
+	void IndexedBinaryHeap<KeyType,DataType>::clear()
+	{
+		for(unsigned int i=0; i<n_items_; ++i)
+			position_[ids_[i]] = not_in_heap_;
+		n_items_ = 0;
+		return;
+	}
+
+
+	/** \brief swaps two elements a and b with each other and updates their positions
+	 *  \param[in] a First element to swap
+	 *  \param[in] b Second element to swap
+	 */
+	template <typename KeyType, typename DataType>
+	inline void IndexedBinaryHeap<KeyType,DataType>::swap(const unsigned int &a, const unsigned int &b)
+	{
+		NodeType tmp = A_[a];
+		A_[a] = A_[b];
+		A_[b] = tmp;
+
+		unsigned int tmp_id = ids_[a];
+		ids_[a] = ids_[b];
+		ids_[b] = tmp_id;
+
+		position_[ids_[a]] = a;
+		position_[ids_[b]] = b;
+	}
+
+
+	/** \brief increases memory for the heap if new_max_items exceeds the current size
+	 *  \details memory grows by doubling (amortized O(1) per insertion) and is never reduced
+	 *  \param[in] new_max_items Number of items that need to be storable
+	 */
+	template <typename KeyType, typename DataType>
+	void IndexedBinaryHeap<KeyType,DataType>::resize(const unsigned int &new_max_items)
+	{
+		if ( new_max_items <= max_items_ )
+			return;
+
+		unsigned int new_size = 2*max_items_+1;
+		NodeType *tmp = new NodeType[new_size];
+		unsigned int *tmp_ids = new unsigned int[new_size];
+		for(unsigned int j=0; j<n_items_; ++j)
+		{
+			tmp[j] = A_[j];
+			tmp_ids[j] = ids_[j];
+		}
+		delete[] A_;
+		delete[] ids_;
+		A_ = tmp;
+		ids_ = tmp_ids;
+		max_items_ = new_size;
+		return;
+	}
+
+
+	/** \brief (aka heapify) Moves a node at index downwards within the tree until equilibrium is reached
+	 *  \param[in] i Index of the node to be relocated
+	 */
+	template <typename KeyType, typename DataType>
+	void IndexedBinaryHeap<KeyType,DataType>::sift_down(unsigned int i)
+	{
+		while (true)
+		{
+			unsigned int min = i;
+			if ( (left(i) < n_items_) && (A_[left(i)] < A_[min]) )
+				min = left(i);
+			if ( (right(i) < n_items_) && (A_[right(i)] < A_[min]) )
+				min = right(i);
+			if (min == i)
+				return;
+			swap(i, min);
+			i = min;
+		}
+	}
+
+
+	/** \brief Moves a node at index up within the tree until equilibrium is reached
+	 *  \param[in] i Index of the node to be relocated
+	 */
+	template <typename KeyType, typename DataType>
+	void IndexedBinaryHeap<KeyType,DataType>::sift_up(unsigned int i)
+	{
+		while ( (i > 0) && (A_[i] < A_[parent(i)]) )
+		{
+			swap(i, parent(i));
+			i = parent(i);
+		}
+		return;
+	}
+
+
+} // END OF NAMESPACE o_data_structures
+
+#endif // END OF INDEXEDBINARYHEAP_HPP_
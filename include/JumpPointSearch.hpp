@@ -0,0 +1,120 @@
+/** \file
+ * 		JumpPointSearch.hpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (Jump Point Search on a 4-connected grid)
+ *
+ *  \details
+ * 		JumpPointSearch.hpp contains declaration of class JumpPointSearch and
+ * 		interface functions int FindPath(..) with the same signatures as astar::FindPath(..):
+ * 		- Class JumpPointSearch is an A* that doesn't put every neighbour of a node
+ * 		  on the open list but only the next jump points in every canonical direction
+ * 		  (see reference and class documentation). On open maps this skips the
+ * 		  large number of symmetric paths A* has to expand.
+ * 		- The search reuses the Workspace (open list, closed list, NodePool) of class AStar.
+ *
+ *  \sa
+ *  	class AStar in AStar.hpp
+ */
+
+#pragma once
+#ifndef JUMP_POINT_SEARCH_HPP_
+#define JUMP_POINT_SEARCH_HPP_
+
+
+#include "Map.hpp"    // A class to represent the game map
+#include "AStar.hpp"  // Workspace (open list, closed list, NodePool) shared with class AStar
+
+namespace jps
+{
+
+	// interface function documented in JumpPointSearch.cpp
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize);
+
+
+	// interface function with additional diagnostics documented in JumpPointSearch.cpp
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+
+
+
+
+	/** \brief provides pathfinding capabilities (implements Jump Point Search for 4-connected grids)
+	 *
+	 *  \detail Canonical ordering: a shortest path moves horizontally first and turns
+	 *  vertically afterwards; a vertical move only turns horizontally again where
+	 *  the turn is forced by an obstacle. This gives the pruning rules:
+	 *  	- moving horizontally in direction dx: natural successors are the next
+	 *  	  node in direction dx and both vertical neighbours (no forced neighbours)
+	 *  	- moving vertically in direction dy: natural successor is the next node in
+	 *  	  direction dy; a horizontal neighbour is forced if the node behind it
+	 *  	  (in direction -dy) is blocked
+	 *  	- a vertical jump stops at the target, at a node with a forced neighbour
+	 *  	  or in front of an obstacle (no jump point)
+	 *  	- a horizontal jump stops at the target or at a node from which a vertical
+	 *  	  jump finds a jump point
+	 *
+	 *  Implementation details (otherwise as class AStar):
+	 *  	- path costs between jump points are manhattan distances (straight lines)
+	 *  	- the direction a node was reached from is derived from its predecessor
+	 *  	- BacktrackPath(..) writes all nodes between jump points to the buffer
+	 *  	- nodes_expanded_ counts insertions and updates of the open list
+	 *
+	 * 	\references
+	 *  	- D. Harabor, A. Grastien: Online Graph Pruning for Pathfinding on Grid Maps.
+	 *  	  Proceedings of the 25th AAAI Conference on Artificial Intelligence, 2011, S. 1114-1119.
+	 */
+	class JumpPointSearch
+	{
+	public :
+		explicit JumpPointSearch(o_graph::Map &map, int *p_buffer, int size_buffer);
+		explicit JumpPointSearch(o_graph::Map &map, int *p_buffer, int size_buffer, astar::Workspace &workspace);
+		int FindPath(const int &iS, const int &jS, const int &iT, const int &jT);
+
+		unsigned int nodes_expanded_; //< for diagnostics
+
+	protected :
+		typedef o_graph::Map Map;
+		typedef o_graph::MapNode MapNode;
+		typedef astar::Workspace::OpenList OpenList;
+		typedef astar::Workspace::ClosedList ClosedList;
+
+		JumpPointSearch();
+
+		/** \brief checks if a position is on the map and traversable
+		 *  \param[in] x x-coordinate of the position
+		 *  \param[in] y y-coordinate of the position
+		 *  \return true if (x,y) is traversable; false otherwise (also outside the map)
+		 */
+		inline bool is_free(const int &x, const int &y) const {
+			return (x >= 0) && (x < map_.width_) && (y >= 0) && (y < map_.height_)
+					&& map_.is_traversable(x,y);
+		}
+
+		bool JumpHorizontal(int &x, const int &y, const int &dx) const;
+		bool JumpVertical(const int &x, int &y, const int &dy) const;
+		void IdentifySuccessors(MapNode *predecessor);
+		void PushSuccessor(MapNode *predecessor, const int &x, const int &y);
+		int BacktrackPath(MapNode *node_on_path) const;
+		void ClearLists();
+
+		int output_buffer_size_;  //< size of Buffer for returning computed path
+		int *p_output_buffer_;    //< pointer to buffer for returning computed path (memory owned by caller)
+		Map &map_;                //< Reference to the game map (provided by caller)
+		astar::NodePool &node_pool_;  //< Memory for all MapNodes of a search (owned by a Workspace)
+		OpenList &open_list_;     //< Priority queue containing all jump points that need processing (owned by a Workspace)
+		ClosedList &closed_list_; //< Set of all visited jump points (owned by a Workspace)
+		int x_target_;            //< x-coordinate of the target (jumps stop there)
+		int y_target_;            //< y-coordinate of the target (jumps stop there)
+
+	}; // END OF CLASS JumpPointSearch
+
+} // END OF NAMESPACE jps
+
+#endif // END OF JUMP_POINT_SEARCH_HPP_
@@ -0,0 +1,115 @@
+/** \file
+ * 		Landmarks.hpp
+ *
+ *  \brief
+ *  	Landmark based heuristic for informed pathfinders (ALT / differential heuristic)
+ *
+ *  \details
+ *  	On mazes the manhattan distance underestimates the path length badly and
+ *  	A* expands almost as many nodes as Dijkstra. Class Landmarks stores the
+ *  	exact distances of every grid point to a few landmarks; by the triangle
+ *  	inequality |d(L,n) - d(L,t)| is a lower bound of the distance d(n,t), which
+ *  	Map::get_heuristic(..) uses instead of (or rather: in addition to) the
+ *  	manhattan distance.
+ *
+ *  	Pathfinders get the landmarks of a map through a registry keyed by the
+ *  	maps data pointer (see RegisterLandmarks(..) and Registry.hpp).
+ *
+ * 	\references
+ * 		- A. V. Goldberg, C. Harrelson: Computing the Shortest Path: A* Search
+ * 		  Meets Graph Theory. SODA 2005, S. 156-165.
+ * 		- N. R. Sturtevant, A. Felner, M. Barrer, J. Schaeffer, N. Burch:
+ * 		  Memory-Based Heuristics for Explicit State Spaces. IJCAI 2009, S. 609-614.
+ */
+
+#pragma once
+#ifndef LANDMARKS_HPP_
+#define LANDMARKS_HPP_
+
+#include <cstdlib>  // abs(..)
+#include <memory>   // shared ownership of registered landmarks
+#include <vector>   // distance tables
+
+namespace o_graph
+{
+
+	//! \brief Heuristic used by a pathfinder (see Map::get_heuristic(..))
+	enum HeuristicPolicy
+	{
+		heuristic_manhattan,  //< manhattan distance to the target
+		heuristic_landmarks   //< maximum of manhattan distance and landmark bounds (registered Landmarks)
+	};
+
+
+	/** \brief Distance tables of a few landmarks of a grid map
+	 *
+	 *  \details Landmarks are chosen by farthest point selection in the largest
+	 *  connected component: the first landmark is the grid point farthest from an
+	 *  arbitrary grid point, every further landmark the grid point farthest from all
+	 *  landmarks chosen so far. Every landmark costs one breadth first search.
+	 *
+	 *  The distances of a grid point to all landmarks are stored next to each other
+	 *  (distances_[id*n_landmarks_ + l]), so a bound costs two cache lines.
+	 *  Grid points outside the largest component get no bound (unreached_).
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	O(width*height*n_landmarks)
+	 *  construction|	O(width*height*n_landmarks)
+	 *  get_bound	|	O(n_landmarks)
+	 *
+	 *  \note The landmarks are only valid as long as the map data doesn't change.
+	 */
+	class Landmarks
+	{
+	public :
+		explicit Landmarks(const int &width, const int &height, const unsigned char *data,
+				const unsigned int &n_landmarks);
+
+		/** \brief lower bound of a distance (triangle inequality)
+		 *  \param[in] id The id of the first grid point (see Map::get_id(..))
+		 *  \param[in] target The id of the second grid point
+		 *  \return max over all landmarks L of |d(L,id) - d(L,target)|; 0 outside the largest component
+		 */
+		inline int get_bound(const unsigned int &id, const unsigned int &target) const {
+			const int *d_id = &distances_[id*n_landmarks_];
+			const int *d_target = &distances_[target*n_landmarks_];
+			int bound = 0;
+			for (unsigned int l=0; l<n_landmarks_; ++l)
+			{
+				if ( (d_id[l] == unreached_) || (d_target[l] == unreached_) )
+					continue;
+				int difference = abs(d_id[l] - d_target[l]);
+				if (difference > bound)
+					bound = difference;
+			}
+			return bound;
+		}
+
+		std::size_t get_memory_footprint() const;
+
+		const int width_;                  //< width of the map
+		const int height_;                 //< height of the map
+		unsigned int n_landmarks_;         //< number of landmarks (at most the size of the largest component)
+		int max_distance_;                 //< largest distance in the tables (supremum of all bounds)
+		std::vector<unsigned int> ids_;    //< grid points of the landmarks
+		std::vector<int> distances_;       //< distance of every grid point to every landmark
+		static const int unreached_ = -1;  //< distance of grid points not connected to the landmarks
+
+	protected :
+		Landmarks();
+		Landmarks(const Landmarks &);
+		Landmarks &operator=(const Landmarks &);
+
+		void Distances(const unsigned char *data, const unsigned int &landmark, std::vector<int> &distances) const;
+	}; // END OF CLASS Landmarks
+
+
+	std::shared_ptr<const Landmarks> RegisterLandmarks(const unsigned char *data, const int &width, const int &height,
+			const unsigned int &n_landmarks);
+	void UnregisterLandmarks(const unsigned char *data);
+	std::shared_ptr<const Landmarks> FindLandmarks(const unsigned char *data, const int &width, const int &height);
+
+} // END OF NAMESPACE o_graph
+
+#endif // END OF LANDMARKS_HPP_
@@ -29,8 +29,12 @@
 #include <string>        // strings for filenames & output to cout
 #include <cmath>         // fabs(..) & abs(..)
 #include <stdexcept>     // exception handling
+#include <memory>        // shared ownership of registered preprocessing
 #include "oString.hpp"   // find & replace for std::string
 #include "ListLIFO.hpp"  // simple list to store map nodes temporary
+#include "ComponentLabels.hpp"  // O(1) check for unreachable targets
+#include "NeighbourMasks.hpp"   // precomputed traversable neighbours
+#include "Landmarks.hpp"        // landmark bounds for the heuristic
 
 namespace o_graph
 {
@@ -81,11 +85,19 @@ namespace o_graph
 	 * 	  - sum of distance to reference point (aka target) and
 	 * 	    small deviation in the range from (0, 1.)
 	 * 	  - deviation: (distance)/(supremum of manhattan distance)
+	 * 	- optional landmark heuristic: if p_landmarks_ is set, the distance is
+	 * 	  the maximum of manhattan distance and landmark bound (see Landmarks.hpp)
+	 * 	  and the deviation is taken relative to the largest landmark distance
 	 *
 	 *  \detail To keep in mind when using with pathfinder class:
 	 *  - Map size mustn't change after initialization
 	 *  - for every new pathfinding attempt the heuristic needs to be
 	 *    set to the targets position as point of reference
+	 *  - A map constructed from Paradoxs interface data uses the connected
+	 *    components registered for the data (see RegisterComponents(..));
+	 *    pathfinders should check is_reachable(..) before searching
+	 *  - it also uses the neighbour masks registered for the data (see
+	 *    RegisterNeighbourMasks(..)); without them masks are computed on the fly
 	 */
 	class Map
 	{
@@ -112,15 +124,47 @@ namespace o_graph
 			return (operator()(x,y) == Map::terrain_traversable_);
 		}
 
+		/** \brief checks if a path between two nodes can exist
+		 *  \param[in] id_a id of the first node
+		 *  \param[in] id_b id of the second node
+		 *  \return false if both nodes are known to be in different components; true otherwise
+		 */
+		inline bool is_reachable(const unsigned int &id_a, const unsigned int &id_b) const {
+			return !p_components_ || p_components_->connected(id_a, id_b);
+		}
+
+		/** \brief traversable neighbours of a node
+		 *  \param[in] id The nodes id
+		 *  \return bit mask of the moves to traversable neighbours (see NeighbourMasks.hpp)
+		 */
+		inline unsigned int get_neighbour_mask(const unsigned int &id) const {
+			return p_masks_ ? p_masks_->mask(id) : NeighbourMasks::ComputeMask(id, width_, height_, data_);
+		}
+
+		/** \brief id of the neighbour a move leads to
+		 *  \param[in] id The nodes id
+		 *  \param[in] move The move (0: x+1, 1: x-1, 2: y+1, 3: y-1)
+		 *  \return id of the neighbour
+		 */
+		inline unsigned int get_neighbour(const unsigned int &id, const unsigned int &move) const {
+			const int offsets[4] = {1, -1, width_, -width_};
+			return id + offsets[move];
+		}
+
 		void fill_neighbour_list(const MapNode * node);
 		void set_heuristic(const int &x0, const int &y0);
 		double get_heuristic(const unsigned int &id) const;
+		int get_manhattan(const unsigned int &id) const;
+		int get_distance_bound(const unsigned int &id) const;
 
 		typedef o_data_structures::ListLIFO<unsigned int, 4> TypNeighbourList;
 		const int width_;                  //< The maps width (extent in x-direction)
 		const int height_;                 //< The maps height (extent in y-direction)
 		const unsigned char *data_;        //< Pointer to Maps bulk data (grid information)
 		TypNeighbourList neighbour_list_;  //< Stores ids generated by fill_neighbour_list(..)
+		std::shared_ptr<const ComponentLabels> p_components_;  //< connected components of the map (empty if unknown)
+		std::shared_ptr<const NeighbourMasks> p_masks_;        //< neighbour masks of the map (empty: computed on the fly)
+		std::shared_ptr<const Landmarks> p_landmarks_;         //< landmarks used by the heuristic (empty: manhattan only)
 
 	//protected :
 
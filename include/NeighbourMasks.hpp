@@ -0,0 +1,90 @@
+/** \file
+ * 		NeighbourMasks.hpp
+ *
+ *  \brief
+ *  	Traversable neighbours of all grid points of a game map (class NeighbourMasks)
+ *
+ *  \details
+ *  	Expanding a grid point needs its traversable neighbours. Computed on the
+ *  	fly this takes a division (x and y of the id), four bounds checks and four
+ *  	loads of the grid data, with branches that the processor can't predict.
+ *  	NeighbourMasks stores 4 bits per grid point (one per move) once per map, so
+ *  	an expansion reads one byte and walks the set bits with a lookup table.
+ *
+ *  	Pathfinders get the masks of a map through a registry keyed by the
+ *  	maps data pointer (see RegisterNeighbourMasks(..)), like the connected
+ *  	components (see ComponentLabels.hpp).
+ *
+ *  	Ids stay row-major. A copy of the map with a blocked border and a row
+ *  	pitch rounded up to a power of two (x and y by shift and mask) was tried
+ *  	and was no faster than the registered masks: the masks already remove the
+ *  	bounds checks and the division is no bottleneck. Copied per query it costs
+ *  	more than a short search, and the pitch can double the memory of a map.
+ */
+
+#pragma once
+#ifndef NEIGHBOUR_MASKS_HPP_
+#define NEIGHBOUR_MASKS_HPP_
+
+#include <cstddef>  // std::size_t
+#include <memory>   // shared ownership of registered masks
+#include <vector>   // masks of all grid points
+
+namespace o_graph
+{
+
+	/** \brief Traversable neighbours of every grid point as bit mask
+	 *
+	 *  \details Bit i of a mask is set if move i leads to a traversable grid point
+	 *  (0: x+1, 1: x-1, 2: y+1, 3: y-1). The mask doesn't depend on the grid point
+	 *  itself (blocked grid points have masks, too).
+	 *  The masks are built row by row, 8 grid points per 64 bit word.
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	width*height bytes
+	 *  construction|	O(width*height)
+	 *  mask		|	O(1)
+	 *
+	 *  \note The masks are only valid as long as the map data doesn't change.
+	 */
+	class NeighbourMasks
+	{
+	public :
+		explicit NeighbourMasks(const int &width, const int &height, const unsigned char *data);
+
+		static unsigned int ComputeMask(const unsigned int &id, const int &width, const int &height,
+				const unsigned char *data);
+
+		/** \brief traversable neighbours of a grid point
+		 *  \param[in] id The id of the grid point (see Map::get_id(..))
+		 *  \return the mask (see above)
+		 */
+		inline unsigned int mask(const unsigned int &id) const {
+			return masks_[id];
+		}
+
+		//! \brief memory used by the masks (bytes)
+		inline std::size_t get_memory_footprint() const {
+			return sizeof(NeighbourMasks) + masks_.capacity();
+		}
+
+		const int width_;                    //< width of the map
+		const int height_;                   //< height of the map
+		std::vector<unsigned char> masks_;   //< mask of every grid point
+
+		static const unsigned char n_moves_[16];   //< number of set bits of every mask
+		static const unsigned char moves_[16][4];  //< set bits of every mask (ascending)
+
+	protected :
+		NeighbourMasks();
+	}; // END OF CLASS NeighbourMasks
+
+
+	std::shared_ptr<const NeighbourMasks> RegisterNeighbourMasks(const unsigned char *data, const int &width, const int &height);
+	void UnregisterNeighbourMasks(const unsigned char *data);
+	std::shared_ptr<const NeighbourMasks> FindNeighbourMasks(const unsigned char *data, const int &width, const int &height);
+
+} // END OF NAMESPACE o_graph
+
+#endif // END OF NEIGHBOUR_MASKS_HPP_
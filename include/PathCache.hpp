@@ -0,0 +1,201 @@
+/** \file
+ * 		PathCache.hpp
+ *
+ *  \brief
+ *  	Cache of shortest paths in front of astar::FindPath(..)
+ *
+ *  \details
+ *  	The AI often asks for the same paths again, e.g. units following each other.
+ *  	Class PathCache keeps the most recently used paths (least recently used ones
+ *  	are evicted) and answers a query from every cached path that contains start
+ *  	and target: every part of a shortest path is a shortest path, in both directions.
+ *
+ *  	Paths are stored as start grid point plus 2 bits per move. An index from
+ *  	grid points to the cached paths containing them finds the paths for a query.
+ */
+
+#pragma once
+#ifndef PATH_CACHE_HPP_
+#define PATH_CACHE_HPP_
+
+#include <cstddef>        // std::size_t
+#include <mutex>          // access from several threads
+#include <unordered_map>  // map versions
+#include <vector>         // cached paths
+
+namespace pathcache
+{
+
+	//! \brief Counters of a PathCache (for monitoring)
+	struct PathCacheStatistics
+	{
+		unsigned long long hits_;       //< queries answered by the cache
+		unsigned long long misses_;     //< queries not answered by the cache
+		unsigned long long evictions_;  //< paths removed to make room for new ones
+		std::size_t n_paths_;           //< paths in the cache
+		std::size_t n_cells_;           //< grid points on all paths in the cache
+		std::size_t n_maps_;            //< maps with paths of their current version in the cache
+	};
+
+
+	/** \brief Thread safe LRU cache of shortest paths
+	 *
+	 *  \details Paths are keyed by the map they were found on (its data pointer and version),
+	 *  so Lookup(..) of (start, target) finds every cached path of the same map version with
+	 *  both grid points on it. The version of a map changes with InvalidateMap(..): paths of
+	 *  older versions are never returned and are evicted in LRU order. A map is only known
+	 *  to the cache as long as paths of its current version are cached.
+	 *
+	 *  The index is a hash table with open addressing (linear probing) of 8 byte slots
+	 *  (grid point, path) with at least twice as many slots as the capacity; the position
+	 *  of a grid point on its path is found while the path is decoded.
+	 *  Memory is bounded by the capacity (grid points on all cached paths):
+	 *  at most 16 bytes of index and 2 bits of path per grid point.
+	 *
+	 *  Operation	|	Time
+	 *  ------------|---------------
+	 *  Lookup		|	O(k*log(k) + length of the cached path), k: number of cached paths through start or target
+	 *  Insert		|	O(path length) (plus evictions)
+	 */
+	class PathCache
+	{
+	public :
+		explicit PathCache(const std::size_t &capacity);
+
+		int Lookup(const unsigned char *data, const int &width, const int &height,
+				const unsigned int &start, const unsigned int &target,
+				int *pOutBuffer, const int &nOutBufferSize);
+		void Insert(const unsigned char *data, const int &width, const int &height,
+				const unsigned int &start, const int *path, const int &length);
+		void InvalidateMap(const unsigned char *data);
+		void Clear();
+		void set_capacity(const std::size_t &capacity);
+		PathCacheStatistics get_statistics() const;
+
+		static const int miss_ = -2;  //< result of Lookup(..) if no cached path contains start and target
+
+	protected :
+		//! \brief A cached path (and its place in the LRU list)
+		struct Entry
+		{
+			const unsigned char *data_;        //< grid data of the map the path was found on
+			unsigned int map_handle_;          //< map and version the path was found on
+			unsigned int start_;               //< first grid point
+			int width_;                        //< width of the map
+			int length_;                       //< number of moves
+			std::vector<unsigned char> moves_; //< 4 moves per byte (0: x+1, 1: x-1, 2: y+1, 3: y-1)
+			int newer_;                        //< next more recently used path (no_entry_ for the newest)
+			int older_;                        //< next less recently used path (no_entry_ for the oldest)
+		};
+
+		//! \brief A grid point on a cached path
+		struct Occurrence
+		{
+			unsigned int entry_;     //< the path
+			unsigned int position_;  //< number of moves from its start
+		};
+
+		//! \brief Slot of the index
+		struct Slot
+		{
+			unsigned int id_;     //< the grid point
+			unsigned int entry_;  //< a path through it (empty_slot_ if the slot is unused)
+		};
+
+		//! \brief Current version of a map
+		struct MapVersion
+		{
+			int width_;               //< width of the map
+			int height_;              //< height of the map
+			unsigned int map_handle_; //< handle of the current version
+			std::size_t n_paths_;     //< cached paths of the current version
+		};
+
+		PathCache();
+		PathCache(const PathCache &);
+		PathCache &operator=(const PathCache &);
+
+		/** \brief first slot to probe for a grid point of a map version
+		 *  \param[in] map_handle map and version
+		 *  \param[in] id the grid point
+		 *  \return index of the slot in index_
+		 */
+		inline std::size_t get_home(const unsigned int &map_handle, const unsigned int &id) const {
+			const unsigned long long key = ((unsigned long long) map_handle << 32) | id;
+			return (std::size_t) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & (index_.size() - 1);
+		}
+
+		bool FindHandle(const unsigned char *data, const int &width, const int &height,
+				unsigned int &map_handle) const;
+		bool FindOccurrences(const unsigned int &map_handle, const unsigned int &start,
+				const unsigned int &target, Occurrence &from, Occurrence &to);
+		int Decode(const Occurrence &from, const Occurrence &to, int *pOutBuffer) const;
+		void Touch(const int &entry);
+		void Unlink(const int &entry);
+		void EvictOldest();
+		void IndexInsert(const unsigned int &map_handle, const unsigned int &id, const unsigned int &entry);
+		void IndexErase(const unsigned int &map_handle, const unsigned int &id, const unsigned int &entry);
+		void Rehash();
+
+		std::size_t capacity_;                 //< maximum number of grid points on all cached paths
+		std::size_t n_cells_;                  //< grid points on all cached paths
+		std::vector<Entry> entries_;           //< cached paths and unused slots
+		std::vector<unsigned int> free_entries_; //< unused slots of entries_
+		int newest_;                           //< most recently used path (no_entry_ if empty)
+		int oldest_;                           //< least recently used path (no_entry_ if empty)
+		std::vector<Slot> index_;              //< paths through every grid point (power of two slots, see get_home(..))
+		std::unordered_map<const unsigned char*, MapVersion> versions_;  //< current version of maps with cached paths
+		unsigned int next_map_handle_;         //< handle of the next new map version
+		std::vector<unsigned int> candidates_; //< paths through the start (used by FindOccurrences(..))
+		unsigned long long hits_;              //< see PathCacheStatistics
+		unsigned long long misses_;            //< see PathCacheStatistics
+		unsigned long long evictions_;         //< see PathCacheStatistics
+		mutable std::mutex mutex_;             //< guards all of the above
+
+		static const int no_entry_ = -1;                       //< end of the LRU list
+		static const unsigned int empty_slot_ = 0u - 1u;       //< entry_ of unused slots of the index
+	}; // END OF CLASS PathCache
+
+
+	// cache used by the interface functions (capacity 65536 grid points)
+	PathCache &SharedPathCache();
+
+
+	/** \brief Interface to find paths through the shared cache (astar::FindPath(..) on a miss)
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \return Returns the length of the shortest path between Start and
+	 *  Target, or -1 if no such path exists or it doesn't fit into pOutBuffer
+	 *
+	 *  \note The map data must not change without SharedPathCache().InvalidateMap(pMap).
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize);
+
+
+	/** \brief Interface to find paths through the shared cache with additional diagnostic capabilities
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[out] nodes_expanded nodes expanded by astar::FindPath(..) (0 for a cache hit)
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+} // END OF NAMESPACE pathcache
+
+#endif // END OF PATH_CACHE_HPP_
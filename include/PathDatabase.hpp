@@ -0,0 +1,156 @@
+/** \file
+ * 		PathDatabase.hpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities without search (compressed path database)
+ *
+ *  \details
+ *  	Many units only need the next step towards their target, recomputed every
+ *  	tick. Class PathDatabase stores for every traversable source grid point the
+ *  	first move of a shortest path towards every target, run length compressed.
+ *  	A query is a binary search in the runs of the source; a full path is
+ *  	obtained by repeated first move lookups.
+ *
+ *  	The database is built by one breadth first search per source (in parallel)
+ *  	and can be saved to disk, so it is built only once per map
+ *  	(see RegisterPathDatabase(..)).
+ *
+ * 	\references
+ * 		- B. Strasser, D. Harabor, A. Botea: Fast First-Move Queries through
+ * 		  Run-Length Encoding. SoCS 2014, S. 157-165.
+ */
+
+#pragma once
+#ifndef PATH_DATABASE_HPP_
+#define PATH_DATABASE_HPP_
+
+#include <memory>           // shared ownership of registered databases
+#include <string>           // file names
+#include <vector>           // runs
+#include "Map.hpp"
+#include "ComponentLabels.hpp"  // rejection of unreachable queries
+
+namespace cpd
+{
+
+	//! \brief First move from a grid point (stored in the lower two bits of a run)
+	enum FirstMove
+	{
+		move_left = 0,   //< to id-1
+		move_right = 1,  //< to id+1
+		move_up = 2,     //< to id-width
+		move_down = 3,   //< to id+width
+		move_none = 4    //< start == target or no path
+	};
+
+
+	/** \brief Run length compressed first move table of a map
+	 *
+	 *  \details Targets are numbered in depth first search order of the map (neighbouring
+	 *  grid points get close numbers, so the first moves form long runs).
+	 *  The runs of source s are runs_[first_run_[s]] .. runs_[first_run_[s+1]-1];
+	 *  a run is (first target << 2) | FirstMove and covers all targets up to
+	 *  the first target of the next run. Targets without a first move (the source
+	 *  itself, other components) are "don't care" and never start a run.
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	O(number of runs)
+	 *  build		|	O(n_nodes^2 / n_threads)
+	 *  first move	|	O(log runs of the source)
+	 *  path		|	O(length * log runs)
+	 *
+	 *  \note The database is only valid as long as the map data doesn't change;
+	 *  Load(..) rejects files built for other map data (checksum) and files
+	 *  with a corrupt payload (checksum, see IsConsistent(..)).
+	 */
+	class PathDatabase
+	{
+	public :
+		explicit PathDatabase(const o_graph::Map &map, const unsigned int &n_threads = 0);
+
+		static PathDatabase *Load(const std::string &file_name, const o_graph::Map &map);
+		int Save(const std::string &file_name) const;
+
+		int GetFirstMove(const unsigned int &start, const unsigned int &target) const;
+		int GetPath(const unsigned int &start, const unsigned int &target,
+				int *pOutBuffer, const int &nOutBufferSize) const;
+		std::size_t get_memory_footprint() const;
+
+		/** \brief id of the neighbour a move leads to
+		 *  \param[in] id The grid point
+		 *  \param[in] move The move (not move_none)
+		 *  \return id of the neighbour
+		 */
+		inline unsigned int get_neighbour(const unsigned int &id, const int &move) const {
+			const int offsets[4] = {-1, 1, -width_, width_};
+			return id + offsets[move];
+		}
+
+		const int width_;                         //< width of the map
+		const int height_;                        //< height of the map
+		unsigned long long map_checksum_;         //< checksum of the map data (see Load(..))
+		unsigned int n_nodes_;                    //< number of traversable grid points
+		std::vector<int> node_of_cell_;           //< depth first number of every grid point (-1 if blocked)
+		std::vector<unsigned int> first_run_;     //< first run of every source (n_nodes_+1 entries)
+		std::vector<unsigned int> runs_;          //< (first target << 2) | FirstMove
+		o_graph::ComponentLabels components_;     //< rejection of unreachable queries
+
+	protected :
+		PathDatabase();
+		PathDatabase(const PathDatabase &);
+		PathDatabase &operator=(const PathDatabase &);
+
+		PathDatabase(const o_graph::Map &map, const bool &build, const unsigned int &n_threads);
+		void OrderNodes(const o_graph::Map &map);
+		void Build(const o_graph::Map &map, unsigned int n_threads);
+		unsigned long long get_payload_checksum() const;
+		bool IsConsistent(const o_graph::Map &map) const;
+	}; // END OF CLASS PathDatabase
+
+
+	std::shared_ptr<const PathDatabase> RegisterPathDatabase(const unsigned char *data, const int &width, const int &height,
+			const std::string &file_name = "");
+	void UnregisterPathDatabase(const unsigned char *data);
+	std::shared_ptr<const PathDatabase> FindPathDatabase(const unsigned char *data, const int &width, const int &height);
+
+
+	/** \brief Interface to use the path database of a map
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \return Returns the length of the shortest path between Start and
+	 *  Target, or -1 if no such path exists
+	 *
+	 *  \note Without a registered PathDatabase for pMap the query is answered by
+	 *  astar::FindPath(..).
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize);
+
+
+	/** \brief Interface to use the path database with additional diagnostic capabilities
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[out] nodes_expanded number of first move lookups
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+} // END OF NAMESPACE cpd
+
+#endif // END OF PATH_DATABASE_HPP_
@@ -32,6 +32,10 @@
 #include <string>      // handling file names
 #include "oTable.hpp"  // class to represent data + compatibility to gnuplot
 #include "oMath.hpp"   // Mathematical helper functions
+#include "oString.hpp"         // building map file names
+#include "NRRan.hpp"           // reproducible random start & target positions
+#include "time_measure.hpp"    // wall- / cpu-time measurement
+#include "Map.hpp"             // loading benchmark maps
 
 
 
@@ -133,6 +137,56 @@ private :
 	std::string output_file_name_;  //< file name for output
 };
 
+
+
+//! \brief Signature shared by all pathfinding interfaces with diagnostics (see AStar.hpp)
+typedef int (*PathfinderDiagnosticsFunc)(const int, const int, const int, const int,
+		const unsigned char*, const int, const int, int*, const int, unsigned int &);
+
+//! \brief Preprocessing of a map for an engine (e.g. hpa::RegisterClusterGraph(..))
+typedef void (*MapPreparationFunc)(const unsigned char*, const int &, const int &);
+
+//! \brief Release of the preprocessing data of a map (e.g. hpa::UnregisterClusterGraph(..))
+typedef void (*MapReleaseFunc)(const unsigned char*);
+
+
+/** \brief Measures the throughput of a pathfinding interface on the maze512-* families
+ *
+ *  \details
+ *  	For every corridor width (1, 2, 4, 8, 16, 32) the first maps_per_family maps
+ *  	are loaded and runs_per_map random (start, target) pairs are solved.
+ *  	Start and target positions are drawn from a fixed seed, so consecutive
+ *  	benchmarks (e.g. before and after an optimization) solve identical queries.
+ *  	One line per family is printed:
+ *  	queries, summed path length, expanded nodes, wall time, expansions/sec,
+ *  	average wall time per query and wall time of the preprocessing.
+ *  	Engines that need preprocessing pass a preparation function that is called
+ *  	once per map before the queries (and a release function called afterwards).
+ *  	Engines that are only meant for narrow corridors can skip the wider
+ *  	families (see set_max_corridor_width(..)).
+ */
+class BenchmarkFamilies
+{
+public :
+	explicit BenchmarkFamilies(const int &runs_per_map, const int &maps_per_family,
+			const std::string &map_directory = "./maps/");
+	void Run(const std::string &engine_name, PathfinderDiagnosticsFunc engine,
+			std::ostream &output_stream = std::cout) const;
+	void Run(const std::string &engine_name, PathfinderDiagnosticsFunc engine,
+			MapPreparationFunc prepare, MapReleaseFunc release,
+			std::ostream &output_stream = std::cout) const;
+	void set_max_corridor_width(const int &max_corridor_width);
+
+	static const int n_families_ = 6;       //< number of maze512 families
+	static const int corridor_widths_[6];   //< corridor width of each family
+private :
+	BenchmarkFamilies();
+	int runs_per_map_;            //< random queries per map
+	int maps_per_family_;         //< maps used from every family (max. 10)
+	std::string map_directory_;   //< directory containing the maze512-*.map files
+	int max_corridor_width_;      //< families with wider corridors are skipped
+};
+
 #endif // END OF PATHFINDER_DIAGNOSTICS_HPP_
 
 
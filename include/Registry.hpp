@@ -0,0 +1,255 @@
+/** \file
+ * 		Registry.hpp
+ *
+ *  \brief
+ *  	Preprocessed data of game maps, looked up by the maps data pointer (class Registry)
+ *
+ *  \details
+ *  	The interface required by Paradox only passes the raw grid data to
+ *  	FindPath(..). Everything a pathfinder computes once per map (e.g. the
+ *  	connected components of ComponentLabels.hpp) is therefore registered
+ *  	under the maps data pointer and looked up on every query.
+ *  	Every kind of preprocessing keeps its items in one Registry and provides
+ *  	Register..(..), Unregister..(..) and Find..(..) functions on top of it.
+ *
+ *  	Items are shared: a lookup returns a std::shared_ptr, so an item that is
+ *  	replaced or unregistered while a query uses it lives until the query is done.
+ *
+ *  	Lookups happen on every query (and every construction of a Map), so they
+ *  	don't take a lock: the items are kept in an immutable table that writers
+ *  	copy, change and publish through an atomic pointer.
+ */
+
+#pragma once
+#ifndef REGISTRY_HPP_
+#define REGISTRY_HPP_
+
+#include <atomic>   // published table, running lookups
+#include <memory>   // shared ownership of registered items
+#include <mutex>    // writers
+#include <vector>   // registered items
+
+namespace o_data_structures
+{
+
+	/** \brief Thread safe registry of items of type T keyed by the grid data of a map
+	 *
+	 *  \details
+	 *  - Key is the data pointer of the map (or anything else comparable by
+	 *    operator==, e.g. data pointer and target)
+	 *  - T has the extent of the map it belongs to as members width_ and height_;
+	 *    Find(..) only returns items of a map with the requested extent
+	 *  - Registering a key again replaces its item
+	 *  - A registry holds few items (one per map), so they are searched linearly
+	 *
+	 *  Writers are serialized by a mutex; every change publishes a new table. A table
+	 *  that was replaced is deleted as soon as no lookup is running (lookups count
+	 *  themselves in n_readers_ before they read the current table): by the writer
+	 *  that replaced it, by a later writer or by the last lookup that finishes.
+	 *
+	 *  Operation	|	Time
+	 *  ------------|---------------
+	 *  Find		|	O(number of items), no lock
+	 *  Register	|	O(number of items) copy of the table
+	 */
+	template <class T, class Key = const unsigned char*>
+	class Registry
+	{
+	public :
+		Registry();
+		~Registry();
+
+		std::shared_ptr<const T> Register(const Key &key, const std::shared_ptr<const T> &p_item);
+		void Unregister(const Key &key);
+		template <class Function>
+		void Update(const Key &key, Function update);
+		std::shared_ptr<const T> Find(const Key &key, const int &width, const int &height) const;
+
+	protected :
+		Registry(const Registry &);
+		Registry &operator=(const Registry &);
+
+		//! \brief A registered item
+		struct Entry
+		{
+			Key key_;                         //< data pointer of the map (and further keys)
+			std::shared_ptr<const T> p_item_; //< the item (shared with running queries)
+		};
+		typedef std::vector<Entry> Table;
+
+		void Publish(Table *p_table);
+		void Reclaim() const;
+
+		mutable std::mutex mutex_;                   //< serializes writers (and deletion of retired_)
+		std::atomic<const Table*> p_table_;          //< current table, immutable once published (null pointer: empty)
+		mutable std::atomic<unsigned int> n_readers_; //< running lookups
+		mutable std::atomic<bool> has_retired_;      //< retired_ isn't empty
+		mutable std::vector<const Table*> retired_;  //< replaced tables that running lookups may still read
+	}; // END OF CLASS Registry
+
+
+
+	//! \brief Constructor (empty registry)
+	template <class T, class Key>
+	Registry<T,Key>::Registry() :
+			mutex_(), p_table_(0L), n_readers_(0), has_retired_(false), retired_()
+	{
+		// nothing to do here
+	}
+
+
+	//! \brief Destructor (must not run concurrently to lookups)
+	template <class T, class Key>
+	Registry<T,Key>::~Registry()
+	{
+		delete p_table_.load();
+		for (std::size_t i=0; i<retired_.size(); ++i)
+			delete retired_[i];
+	}
+
+
+	/** \brief Registers an item (replaces the item registered for key)
+	 *  \param[in] key data pointer of the map (and further keys)
+	 *  \param[in] p_item the item
+	 *  \return the item
+	 */
+	template <class T, class Key>
+	std::shared_ptr<const T> Registry<T,Key>::Register(const Key &key, const std::shared_ptr<const T> &p_item)
+	{
+		Update(key, [&p_item](const std::shared_ptr<const T> &) { return p_item; });
+		return p_item;
+	}
+
+
+	/** \brief Removes the item registered for key
+	 *  \param[in] key data pointer of the map (and further keys)
+	 *  \note Queries that use the item keep it alive until they are done.
+	 */
+	template <class T, class Key>
+	void Registry<T,Key>::Unregister(const Key &key)
+	{
+		Update(key, [](const std::shared_ptr<const T> &) { return std::shared_ptr<const T>(); });
+		return;
+	}
+
+
+	/** \brief Replaces the item registered for key by a function of it
+	 *
+	 *  \details update is called with the current item (empty if none is registered)
+	 *  and returns the new item (empty: the key is removed). Concurrent updates of the
+	 *  same key don't get lost, since writers are serialized.
+	 *
+	 *  \param[in] key data pointer of the map (and further keys)
+	 *  \param[in] update std::shared_ptr<const T> (const std::shared_ptr<const T> &)
+	 */
+	template <class T, class Key>
+	template <class Function>
+	void Registry<T,Key>::Update(const Key &key, Function update)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		const Table *p_current = p_table_.load();
+		std::unique_ptr<Table> p_table((p_current != 0L) ? new Table(*p_current) : new Table());
+
+		std::size_t i = 0;
+		while ( (i < p_table->size()) && !((*p_table)[i].key_ == key) )
+			++i;
+		const std::shared_ptr<const T> p_item =
+				update((i < p_table->size()) ? (*p_table)[i].p_item_ : std::shared_ptr<const T>());
+		if (i == p_table->size())
+		{
+			if (!p_item)
+			{
+				Reclaim();
+				return;
+			}
+			Entry entry = {key, p_item};
+			p_table->push_back(entry);
+		}
+		else if (p_item)
+			(*p_table)[i].p_item_ = p_item;
+		else
+		{
+			(*p_table)[i] = p_table->back();
+			p_table->pop_back();
+		}
+
+		if (p_table->empty())
+			p_table.reset();
+		Publish(p_table.release());
+		return;
+	}
+
+
+	/** \brief Looks up the item registered for key
+	 *  \param[in] key data pointer of the map (and further keys)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return the item (stays valid while the caller holds it); empty if no item of a map
+	 *  with this key and extent is registered
+	 */
+	template <class T, class Key>
+	std::shared_ptr<const T> Registry<T,Key>::Find(const Key &key, const int &width, const int &height) const
+	{
+		if (p_table_.load(std::memory_order_relaxed) == 0L)
+			return std::shared_ptr<const T>();
+
+		std::shared_ptr<const T> p_item;
+		++n_readers_;
+		const Table *p_table = p_table_.load();
+		if (p_table != 0L)
+			for (std::size_t i=0; i<p_table->size(); ++i)
+				if ( ((*p_table)[i].key_ == key) && ((*p_table)[i].p_item_->width_ == width)
+						&& ((*p_table)[i].p_item_->height_ == height) )
+				{
+					p_item = (*p_table)[i].p_item_;
+					break;
+				}
+
+		// the last lookup deletes replaced tables, unless a writer is busy (it will do so)
+		if ( (--n_readers_ == 0) && has_retired_ )
+		{
+			std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+			if (lock.owns_lock())
+				Reclaim();
+		}
+		return p_item;
+	}
+
+
+	/** \brief Makes a table the current one (called with mutex_ locked)
+	 *  \param[in] p_table the new table (null pointer: empty registry; owned by the registry)
+	 */
+	template <class T, class Key>
+	void Registry<T,Key>::Publish(Table *p_table)
+	{
+		const Table *p_replaced = p_table_.exchange(p_table);
+		if (p_replaced != 0L)
+		{
+			retired_.push_back(p_replaced);
+			has_retired_ = true;
+		}
+		Reclaim();
+		return;
+	}
+
+
+	/** \brief Deletes replaced tables if no lookup is running (called with mutex_ locked)
+	 *
+	 *  \details A lookup that starts after this check reads the current table, since
+	 *  it increments n_readers_ before it loads p_table_.
+	 */
+	template <class T, class Key>
+	void Registry<T,Key>::Reclaim() const
+	{
+		if (n_readers_ != 0)
+			return;
+		for (std::size_t i=0; i<retired_.size(); ++i)
+			delete retired_[i];
+		retired_.clear();
+		has_retired_ = false;
+		return;
+	}
+
+} // END OF NAMESPACE o_data_structures
+
+#endif // END OF REGISTRY_HPP_
@@ -0,0 +1,76 @@
+/** \file
+ * 		ResumableSearch.hpp
+ *
+ *  \brief
+ *  	A* search that can be spread over several calls (time slicing)
+ *
+ *  \details
+ *  	astar::FindPath(..) runs a search to its end. A long or unreachable query on a
+ *  	large maze can take several milliseconds, longer than a game tick. Class
+ *  	ResumableSearch owns an AStar together with its own Workspace, so open and
+ *  	closed list survive between calls of Step(..). A scheduler can give every
+ *  	search a budget of expansions per frame and continue it in the next one.
+ *
+ *  \sa
+ *  	AStar.hpp
+ */
+
+#pragma once
+#ifndef RESUMABLE_SEARCH_HPP_
+#define RESUMABLE_SEARCH_HPP_
+
+#include "AStar.hpp"  // SearchStatus and the search itself
+
+namespace astar
+{
+
+	/** \brief A* search on one map that runs in steps of limited numbers of expansions
+	 *
+	 *  \details Usage:
+	 *  - Start(..) sets up a search (a running search is cancelled)
+	 *  - Step(..) is called until it returns anything but search_in_progress
+	 *  - if search_found is returned the path is in the output buffer (get_path_length())
+	 *
+	 *  All MapNodes of a search are released as soon as it ends, is cancelled
+	 *  or the object is destroyed; the memory of the Workspace is kept for the next
+	 *  search on the same object. Objects can be moved (not copied); a moved from
+	 *  object is idle.
+	 *
+	 *  \note The output buffer and the map data (owned by caller) must stay valid until the
+	 *  search ended or was cancelled.
+	 */
+	class ResumableSearch
+	{
+	public :
+		explicit ResumableSearch(const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				int* pOutBuffer, const int nOutBufferSize);
+		ResumableSearch(ResumableSearch &&other);
+		ResumableSearch &operator=(ResumableSearch &&other);
+		~ResumableSearch();
+
+		void Start(const int nStartX, const int nStartY, const int nTargetX, const int nTargetY);
+		SearchStatus Step(const unsigned int &max_expansions);
+		void Cancel();
+
+		//! \brief state of the current search (search_idle if there is none)
+		inline SearchStatus get_status() const {
+			return status_;
+		}
+
+		int get_path_length() const;
+		unsigned int get_nodes_expanded() const;
+
+	protected :
+		struct State;
+
+		ResumableSearch();
+		ResumableSearch(const ResumableSearch &);
+		ResumableSearch &operator=(const ResumableSearch &);
+
+		State *p_state_;       //< map, workspace and AStar of the search (null pointer if moved from)
+		SearchStatus status_;  //< state of the current search
+	}; // END OF CLASS ResumableSearch
+
+} // END OF NAMESPACE astar
+
+#endif // END OF RESUMABLE_SEARCH_HPP_
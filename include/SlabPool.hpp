@@ -0,0 +1,123 @@
+/** \file
+ * 		SlabPool.hpp
+ *
+ *  \brief
+ *  	Provides an arena allocator for objects of one type (class SlabPool)
+ *
+ *  \details
+ *  	SlabPool hands out objects from contiguous slabs of SlabSize objects.
+ *  	Objects are never freed one by one; instead all objects are released
+ *  	at once by reset() in O(1). Slabs are kept for reuse, so a pool that
+ *  	lives longer than a single search (e.g. one pool per thread) stops
+ *  	allocating heap memory once it has grown to the size of the largest search.
+ */
+
+#pragma once
+#ifndef SLAB_POOL_HPP_
+#define SLAB_POOL_HPP_
+
+#include <vector>  // list of slabs
+
+namespace o_data_structures
+{
+
+	/** \brief Arena allocator for objects of type T
+	 *
+	 *  \details
+	 *  - allocate() returns a default constructed object (T must be default
+	 *    constructible and assignable)
+	 *  - reset() releases all objects handed out so far
+	 *  - Counters for diagnostics:
+	 *    - heap_allocations_ : number of slabs allocated from the heap
+	 *    - allocations_ : number of objects handed out
+	 *    - resets_ : number of calls to reset()
+	 *
+	 *  \note Pointers handed out by allocate() are invalid after reset().
+	 *  SlabPool isn't thread safe; use one pool per thread.
+	 */
+	template <class T, unsigned int SlabSize = 4096>
+	class SlabPool
+	{
+	public :
+		SlabPool();
+		~SlabPool();
+
+		T *allocate();
+		void reset();
+
+		//! \brief number of objects the pool can hand out without touching the heap
+		unsigned long long capacity() const {return slabs_.size()*SlabSize;}
+
+		unsigned long long heap_allocations_;  //< slabs allocated from the heap (since construction)
+		unsigned long long allocations_;       //< objects handed out (since construction)
+		unsigned long long resets_;            //< calls to reset() (since construction)
+
+	protected :
+		SlabPool(const SlabPool &);
+		SlabPool &operator=(const SlabPool &);
+
+		std::vector<T*> slabs_;       //< slabs of SlabSize objects each
+		std::size_t current_slab_;    //< index of the slab in use
+		unsigned int next_in_slab_;   //< index of the next free object within the current slab
+	}; // END OF CLASS SlabPool
+
+
+
+	//! \brief Constructor (doesn't allocate memory)
+	template <class T, unsigned int SlabSize>
+	SlabPool<T,SlabSize>::SlabPool() :
+			heap_allocations_(0), allocations_(0), resets_(0),
+			current_slab_(0), next_in_slab_(0)
+	{
+		// nothing to do here
+	}
+
+
+	//! \brief Destructor (frees all slabs)
+	template <class T, unsigned int SlabSize>
+	SlabPool<T,SlabSize>::~SlabPool()
+	{
+		for(std::size_t i=0; i<slabs_.size(); ++i)
+			delete[] slabs_[i];
+	}
+
+
+	/** \brief Hands out an object
+	 *  \details A new slab is allocated only if all slabs are in use
+	 *  \return Pointer to a default constructed object (owned by the pool)
+	 */
+	template <class T, unsigned int SlabSize>
+	T *SlabPool<T,SlabSize>::allocate()
+	{
+		if (next_in_slab_ == SlabSize)
+		{
+			++current_slab_;
+			next_in_slab_ = 0;
+		}
+		if (current_slab_ == slabs_.size())
+		{
+			slabs_.push_back(new T[SlabSize]);
+			++heap_allocations_;
+		}
+		++allocations_;
+		T *object = &slabs_[current_slab_][next_in_slab_++];
+		*object = T();
+		return object;
+	}
+
+
+	/** \brief Releases all objects in O(1)
+	 *  \details memory is kept and reused by subsequent calls to allocate()
+	 */
+	template <class T, unsigned int SlabSize>
+	void SlabPool<T,SlabSize>::reset()
+	{
+		current_slab_ = 0;
+		next_in_slab_ = 0;
+		++resets_;
+		return;
+	}
+
+} // END OF NAMESPACE o_data_structures
+
+#endif // END OF SLAB_POOL_HPP_
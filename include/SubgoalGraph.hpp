@@ -0,0 +1,143 @@
+/** \file
+ * 		SubgoalGraph.hpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (simple subgoal graphs)
+ *
+ *  \details
+ *  	Shortest paths on a grid only need to turn at the convex corners of
+ *  	obstacles. Class SubgoalGraph places a subgoal next to every such corner
+ *  	and connects subgoals that are directly h-reachable (see below). A query
+ *  	connects start and target to the graph, searches only among subgoals and
+ *  	refines every edge of the result into a monotone staircase of grid moves.
+ *
+ *  	The graph of a map is built once and registered by the maps data pointer
+ *  	(see RegisterSubgoalGraph(..) and Registry.hpp).
+ *
+ * 	\references
+ * 		- T. Uras, S. Koenig, C. Hernandez: Subgoal Graphs for Optimal Pathfinding
+ * 		  in Eight-Neighbor Grids. ICAPS 2013, S. 224-232.
+ */
+
+#pragma once
+#ifndef SUBGOAL_GRAPH_HPP_
+#define SUBGOAL_GRAPH_HPP_
+
+#include <cstdlib>  // abs(..)
+#include <memory>   // shared ownership of registered graphs
+#include <vector>   // compact graph arrays
+
+namespace subgoal
+{
+
+	/** \brief Simple subgoal graph of a 4-connected grid map
+	 *
+	 *  \details A traversable grid point s is a subgoal if a diagonal neighbour b of s
+	 *  is blocked while both grid points adjacent to s and b are traversable
+	 *  (s lies at a convex corner of the obstacle containing b).
+	 *
+	 *  Two grid points are h-reachable if a path of manhattan length exists between
+	 *  them (a monotone staircase). Subgoal t is directly h-reachable from s if such
+	 *  a path exists that doesn't pass another subgoal. Both are computed by a
+	 *  scan of the four quadrants around s: a grid point is reached if it is traversable
+	 *  and its neighbour towards s is reached and not a subgoal.
+	 *
+	 *  Edges in compressed row format: the neighbours of subgoal v are
+	 *  edge_head_[first_edge_[v]] .. edge_head_[first_edge_[v+1]-1]; the length of
+	 *  an edge is the manhattan distance of its ends.
+	 *
+	 *  Algorithm	|	Worst case
+	 *  ------------|---------------
+	 *  Space		|	O(width*height + edges)
+	 *  construction|	O(subgoals * width*height)
+	 *  query		|	O(width*height + subgoals*log(subgoals) + edges)
+	 *
+	 *  \note The graph is only valid as long as the map data doesn't change.
+	 */
+	class SubgoalGraph
+	{
+	public :
+		explicit SubgoalGraph(const int &width, const int &height, const unsigned char *data);
+
+		int FindPath(const unsigned int &start, const unsigned int &target,
+				int *pOutBuffer, const int &nOutBufferSize, unsigned int &nodes_expanded) const;
+		std::size_t get_memory_footprint() const;
+
+		/** \brief manhattan distance of two grid points
+		 *  \param[in] a id of the first grid point
+		 *  \param[in] b id of the second grid point
+		 *  \return manhattan distance
+		 */
+		inline int get_distance(const unsigned int &a, const unsigned int &b) const {
+			return abs((int) (a%width_) - (int) (b%width_)) + abs((int) (a/width_) - (int) (b/width_));
+		}
+
+		const int width_;                            //< width of the map
+		const int height_;                           //< height of the map
+		const unsigned char *data_;                  //< grid data of the map (owned by caller)
+		unsigned int n_subgoals_;                    //< number of subgoals
+		std::vector<int> subgoal_of_cell_;           //< subgoal of every grid point (no_subgoal_ if it isn't one)
+		std::vector<unsigned int> cell_of_subgoal_;  //< grid point of every subgoal
+		std::vector<unsigned int> first_edge_;       //< first edge of every subgoal (n_subgoals_+1 entries)
+		std::vector<unsigned int> edge_head_;        //< directly h-reachable subgoal of every edge
+
+		static const int no_subgoal_ = -1;  //< subgoal of grid points that aren't subgoals
+
+	protected :
+		SubgoalGraph();
+		SubgoalGraph(const SubgoalGraph &);
+		SubgoalGraph &operator=(const SubgoalGraph &);
+
+		bool is_traversable(const int &x, const int &y) const;
+		bool IsSubgoal(const int &x, const int &y) const;
+		bool ScanQuadrants(const unsigned int &origin, const unsigned int &goal,
+				std::vector<unsigned int> &subgoals) const;
+		int Refine(const unsigned int &from, const unsigned int &to,
+				int *pOutBuffer, const int &nOutBufferSize, const int &n) const;
+	}; // END OF CLASS SubgoalGraph
+
+
+	std::shared_ptr<const SubgoalGraph> RegisterSubgoalGraph(const unsigned char *data, const int &width, const int &height);
+	void UnregisterSubgoalGraph(const unsigned char *data);
+	std::shared_ptr<const SubgoalGraph> FindSubgoalGraph(const unsigned char *data, const int &width, const int &height);
+
+
+	/** \brief Interface to search the subgoal graph of a map
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \return Returns the length of the shortest path between Start and
+	 *  Target, or -1 if no such path exists
+	 *
+	 *  \note Without a registered SubgoalGraph for pMap the query is answered by
+	 *  astar::FindPath(..).
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize);
+
+
+	/** \brief Interface to search the subgoal graph with additional diagnostic capabilities
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[out] nodes_expanded number of expanded subgoals
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+} // END OF NAMESPACE subgoal
+
+#endif // END OF SUBGOAL_GRAPH_HPP_
@@ -1,9 +1,7 @@
 
-#include <queue>
 #include <vector>
-#include <thread>
-#include <mutex>
 #include "BinaryHeap.hpp"
+#include "BucketQueue.hpp"
 
 #ifndef UNIFORMCOSTSEARCH_HPP_
 #define UNIFORMCOSTSEARCH_HPP_
@@ -20,6 +18,9 @@
 	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
 	 *  stored (excluding the starting position)
 	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \note FindPath(..) may be called concurrently from several threads;
+	 *  every thread reuses its own search memory (see UcsWorkspace in UniformCostSearch.cpp).
 	 */
 	int FindPath(const int nStartX, const int nStartY,
 				 const int nTargetX, const int nTargetY,
@@ -27,4 +28,56 @@
 				 int* pOutBuffer, const int nOutBufferSize);
 
 
+	/** \brief Interface to use uniform cost search with additional diagnostic capabilities
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[out] nodes_expanded number of nodes put on the open list
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded);
+
+
+	/** \brief Interface to use uniform cost search with choice of the open list
+	 *
+	 *  \details Parameters and return value as above plus:
+	 *  \param[in] policy open list to be used (binary heap or buckets)
+	 *  \note NOT compatible to paradox requirements!!
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded,
+				 const o_data_structures::OpenListPolicy &policy);
+
+
+	/** \brief Batch interface: distances from many sources to many targets
+	 *
+	 *  \details Runs the breadth first searches of 64 sources at once: bit i of a word per
+	 *  grid point marks that search i reached it, so one sweep over the frontier grid
+	 *  points advances all 64 searches with one OR of words per neighbour. A batch ends
+	 *  as soon as all its distances are known. More than 64 sources are split into batches.
+	 *
+	 *  \param[in] pSources ids (x + y*nMapWidth) of the sources
+	 *  \param[in] nSources number of sources
+	 *  \param[in] pTargets ids of the targets
+	 *  \param[in] nTargets number of targets
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutDistances nSources*nTargets distances (row i: source i, column k: target k),
+	 *  -1 where no path exists
+	 *
+	 *  \return number of sweeps (for diagnostics)
+	 *
+	 *  \note May be called concurrently from several threads (see BatchWorkspace in UniformCostSearch.cpp).
+	 */
+	int FindDistances(const int* pSources, const int nSources,
+					  const int* pTargets, const int nTargets,
+					  const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+					  int* pOutDistances);
+
+
 #endif
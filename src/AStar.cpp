@@ -45,6 +45,42 @@
 namespace astar
 {
 
+	const unsigned int AStar::unlimited_expansions_;
+
+
+	/** \brief Workspace of the calling thread
+	 *
+	 *  \details The workspace outlives single searches, so once it has grown to the
+	 *  size needed by the largest search, AStar doesn't allocate heap memory anymore
+	 *  (see NodePool::heap_allocations_).
+	 *  A thread must not run two searches on its workspace at the same time.
+	 *
+	 *  \return Reference to the workspace of the calling thread
+	 */
+	Workspace &ThreadWorkspace()
+	{
+		static thread_local Workspace workspace;
+		return workspace;
+	}
+
+
+	/** \brief Makes the lists of the workspace ready for maps with n_nodes nodes
+	 *  \details Memory only grows; ids already known keep their state.
+	 *  \param[in] n_nodes number of nodes of the map to be searched
+	 */
+	void Workspace::Reserve(const unsigned int &n_nodes)
+	{
+		open_list_.resize_ids(n_nodes);
+		bucket_list_.ids_.resize(n_nodes);
+		if (bucket_list_.nodes_.size() < n_nodes)
+			bucket_list_.nodes_.resize(n_nodes);
+#if !defined (ASTAR_CLOSED_LIST_RBTREE)
+		closed_list_.resize(n_nodes);
+#endif
+		return;
+	}
+
+
 	int FindPath(const int nStartX, const int nStartY,
 				 const int nTargetX, const int nTargetY,
 				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
@@ -92,6 +128,85 @@ namespace astar
 	}
 
 
+	/** \brief Interface function that delegates the task of finding a path to a class AStar object
+	 *
+	 *  \details Version of Interface with additional diagnostic capbilities
+	 *  and choice of the open list; NOT compatible to paradox requirements!!
+	 *  Parameters and return value as above plus:
+	 *
+	 *  \param[in] policy open list to be used by AStar (binary heap or buckets)
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded,
+				 const o_data_structures::OpenListPolicy &policy)
+	{
+		int return_value;
+		o_graph::Map map(nMapWidth,nMapHeight,pMap);
+		AStar Pathfinder(map,pOutBuffer,nOutBufferSize);
+		Pathfinder.open_list_policy_ = policy;
+		return_value = Pathfinder.FindPath(nStartX, nStartY, nTargetX, nTargetY);
+		nodes_expanded = Pathfinder.nodes_expanded_;
+		return return_value;
+	}
+
+
+	/** \brief Interface function that delegates the task of finding a path to a class AStar object
+	 *
+	 *  \details Version of Interface with additional diagnostic capbilities,
+	 *  choice of the open list and of the heuristic; NOT compatible to paradox requirements!!
+	 *  Parameters and return value as above plus:
+	 *
+	 *  \param[in] heuristic heuristic to be used by AStar; heuristic_landmarks uses the
+	 *  Landmarks registered for pMap (see RegisterLandmarks(..)), manhattan distance if none are registered
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded,
+				 const o_data_structures::OpenListPolicy &policy, const o_graph::HeuristicPolicy &heuristic)
+	{
+		int return_value;
+		o_graph::Map map(nMapWidth,nMapHeight,pMap);
+		AStar Pathfinder(map,pOutBuffer,nOutBufferSize);
+		Pathfinder.open_list_policy_ = policy;
+		Pathfinder.heuristic_policy_ = heuristic;
+		return_value = Pathfinder.FindPath(nStartX, nStartY, nTargetX, nTargetY);
+		nodes_expanded = Pathfinder.nodes_expanded_;
+		return return_value;
+	}
+
+
+	/** \brief Interface function that delegates the task of finding a bounded suboptimal path
+	 *  to a class AStar object (weighted A*)
+	 *
+	 *  \details For clients that accept longer paths if they are found faster;
+	 *  NOT compatible to paradox requirements!! Parameters as above plus:
+	 *
+	 *  \param[in] epsilon admissible relative excess length of the path; values <= 0 yield shortest paths
+	 *
+	 *  \return Returns the length L of a path between Start and Target with
+	 *  L <= (1+epsilon)*(length of the shortest path), or -1 if no such path exists
+	 *  or the bound exceeds nOutBufferSize
+	 */
+	int FindBoundedPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, const float epsilon,
+				 unsigned int &nodes_expanded)
+	{
+		int return_value;
+		o_graph::Map map(nMapWidth,nMapHeight,pMap);
+		AStar Pathfinder(map,pOutBuffer,nOutBufferSize);
+		if (epsilon > 0.f)
+			Pathfinder.weight_ = 1.f + epsilon;
+		return_value = Pathfinder.FindPath(nStartX, nStartY, nTargetX, nTargetY);
+		nodes_expanded = Pathfinder.nodes_expanded_;
+		return return_value;
+	}
+
+
 
 
 	/** \brief Constructor
@@ -100,26 +215,56 @@ namespace astar
 	 *  \param[in] size_buffer length of the buffer p_buffer
 	 */
 	AStar::AStar(o_graph::Map &map, int *p_buffer, int size_buffer) :
-			map_(map), p_output_buffer_(p_buffer), output_buffer_size_(size_buffer), nodes_expanded_(0),
-			open_list_(0.1*map.width_*map_.height_)
+			nodes_expanded_(0), path_length_(-1),
+			open_list_policy_(o_data_structures::open_list_binary_heap),
+			heuristic_policy_(o_graph::heuristic_manhattan), weight_(1.f),
+			output_buffer_size_(size_buffer), p_output_buffer_(p_buffer), map_(map),
+			node_pool_(ThreadWorkspace().node_pool_), open_list_(ThreadWorkspace().open_list_),
+			bucket_list_(ThreadWorkspace().bucket_list_), closed_list_(ThreadWorkspace().closed_list_),
+			target_id_(0)
 	{
-		// nothing to do here
+		ThreadWorkspace().Reserve(map_.width_*map_.height_);
+	}
+
+
+	/** \brief Constructor using a Workspace provided by the caller
+	 *  \param[in] map Reference to the game map represented by an instance of class Map
+	 *  \param[in] p_buffer Pointer to the output buffer where the path is written to (Memory ownership by caller)
+	 *  \param[in] size_buffer length of the buffer p_buffer
+	 *  \param[in] workspace Lists and NodePool used by the search (emptied at the end of FindPath(..))
+	 */
+	AStar::AStar(o_graph::Map &map, int *p_buffer, int size_buffer, Workspace &workspace) :
+			nodes_expanded_(0), path_length_(-1),
+			open_list_policy_(o_data_structures::open_list_binary_heap),
+			heuristic_policy_(o_graph::heuristic_manhattan), weight_(1.f),
+			output_buffer_size_(size_buffer), p_output_buffer_(p_buffer), map_(map),
+			node_pool_(workspace.node_pool_), open_list_(workspace.open_list_),
+			bucket_list_(workspace.bucket_list_), closed_list_(workspace.closed_list_), target_id_(0)
+	{
+		workspace.Reserve(map_.width_*map_.height_);
 	}
 
 
 	/** \brief Node Expansion in A*-Algorithm
 	 *
 	 *  \detail Method to expand the node just visited by AStars main loop (AStar::FindPath(..))
-	 *  and put new nodes on the open list
+	 *  and put new nodes on the open list. Successors are taken from the neighbour mask
+	 *  (y-1, y+1, x-1, x+1: the order of the former neighbour list); the backward
+	 *  node (predecessors predecessor) is skipped.
 	 *
 	 *  \param[in] Pointer to the node that will be expanded (aka was just visited)
 	 */
 	void AStar::ExpandNode(MapNode *predecessor)
 	{
-		map_.fill_neighbour_list(predecessor);
-		while(!map_.neighbour_list_.is_empty())
+		const unsigned int id = predecessor->id_;
+		const unsigned int backward_id = (predecessor->p_predecessor_ != 0L) ?
+				predecessor->p_predecessor_->id_ : 0u-1u;
+		const unsigned int mask = map_.get_neighbour_mask(id);
+		for (unsigned int i=o_graph::NeighbourMasks::n_moves_[mask]; i>0; --i)
 		{
-			unsigned int successor_id = map_.neighbour_list_.pop();
+			unsigned int successor_id = map_.get_neighbour(id, o_graph::NeighbourMasks::moves_[mask][i-1]);
+			if (successor_id == backward_id)
+				continue;
 
 			// search closed list for successor
 			if (closed_list_.find(successor_id))
@@ -127,43 +272,103 @@ namespace astar
 
 			int path_cost = predecessor->path_cost_ + 1; // 1 = distance(predecessor, successor);
 
-			// search open list if item with successor_id already exists
-			unsigned int search_index;
-			bool search_success = open_list_.find_(
-					search_index,
-					[&successor_id] (OpenListItem &item) {return item.data_->id_ == successor_id;} );
+			// check open list if item with successor_id already exists (O(1) by id)
+			MapNode *p_successor = FindOpen(successor_id);
+			bool search_success = (p_successor != 0L);
 
 			if (search_success)
-				if(path_cost >= open_list_.A_[search_index].data_->path_cost_ )
+				if(path_cost >= p_successor->path_cost_ )
 					continue;
 
-			float fvalue = map_.get_heuristic(successor_id) + (double) path_cost;
+			float fvalue;
+			if (weight_ > 1.f)
+				fvalue = (float) path_cost + weight_*(float) map_.get_distance_bound(successor_id);
+			else if (open_list_policy_ == o_data_structures::open_list_buckets)
+				fvalue = (float) (map_.get_distance_bound(successor_id) + path_cost);
+			else
+				fvalue = map_.get_heuristic(successor_id) + (double) path_cost;
 
-			if (output_buffer_size_ < (int) fvalue)
+			// weighted f-values overestimate; the buffer check needs a lower bound of the path length
+			int length_bound = (weight_ > 1.f) ?
+					path_cost + map_.get_distance_bound(successor_id) : (int) fvalue;
+			if (output_buffer_size_ < length_bound)
 				continue;
 
 			++nodes_expanded_;
 
-			if (search_success)
+			if (!search_success)
 			{
-				open_list_.A_[search_index].data_->p_predecessor_ = predecessor;
-				open_list_.A_[search_index].data_->path_cost_ = path_cost;
-				open_list_.change_key(search_index, fvalue);
-			}
-			else
-			{
-				MapNode *p_successor = new MapNode();
+				p_successor = node_pool_.allocate();
 				p_successor->id_ = successor_id;
-				p_successor->p_predecessor_ = predecessor;
-				p_successor->path_cost_ = path_cost;
-				p_successor->fvalue_ = fvalue;
-				open_list_.insert(fvalue, p_successor);
 			}
+			p_successor->p_predecessor_ = predecessor;
+			p_successor->path_cost_ = path_cost;
+			p_successor->fvalue_ = fvalue;
+			PushOpen(p_successor, search_success);
 		}
 		return;
 	}
 
 
+	/** \brief Looks up a node on the open list by its id (O(1) for both open lists)
+	 *  \param[in] id The id of the node
+	 *  \return Pointer to the node if it is on the open list; null pointer otherwise
+	 */
+	AStar::MapNode *AStar::FindOpen(const unsigned int &id) const
+	{
+		if (open_list_policy_ == o_data_structures::open_list_buckets)
+			return bucket_list_.ids_.is_set(id) ? bucket_list_.nodes_[id] : 0L;
+		return open_list_.contains(id) ? open_list_.data(id) : 0L;
+	}
+
+
+	/** \brief Puts a node on the open list (or updates its position)
+	 *  \param[in] node The node (its fvalue_ and path_cost_ need to be set)
+	 *  \param[in] is_update true if node is already on the open list
+	 */
+	void AStar::PushOpen(MapNode *node, const bool &is_update)
+	{
+		if (open_list_policy_ == o_data_structures::open_list_buckets)
+		{
+			// outdated entries of updated nodes stay in the queue (see PopOpen())
+			bucket_list_.queue_.insert((unsigned int) node->fvalue_, node);
+			bucket_list_.ids_.set(node->id_);
+			bucket_list_.nodes_[node->id_] = node;
+		}
+		else if (is_update)
+			open_list_.change_key_by_id(node->id_, node->fvalue_);
+		else
+			open_list_.insert(node->id_, node->fvalue_, node);
+		return;
+	}
+
+
+	/** \brief Removes the node with minimum f-value from the open list
+	 *  \details For the bucket open list outdated entries (of nodes that were
+	 *  reinserted with a lower f-value and are closed already) are skipped.
+	 *  \return Pointer to the removed node; null pointer if the open list is empty
+	 */
+	AStar::MapNode *AStar::PopOpen()
+	{
+		if (open_list_policy_ == o_data_structures::open_list_buckets)
+		{
+			while (!bucket_list_.queue_.is_empty())
+			{
+				MapNode *node = bucket_list_.queue_.pop();
+				if (closed_list_.find(node->id_))
+					continue;
+				bucket_list_.ids_.unset(node->id_);
+				return node;
+			}
+			return 0L;
+		}
+
+		if (open_list_.is_empty())
+			return 0L;
+		return open_list_.pop(0);
+	}
+
+
 	/** \brief Reconstructs the shortest path found by AStar::FindPath() and writes it to Buffer p_output_buffer
 	 *
 	 *  \details BacktrackPath(..) will trace back the path by looking
@@ -214,55 +419,97 @@ namespace astar
 	{
 		int path_length = -1; // will be set to actual length if path exists
 
-		MapNode *p_start_node = new MapNode();
-		p_start_node->id_ = map_.get_id(iS,jS);
+		if (Start(iS, jS, iT, jT) && (Step(unlimited_expansions_) == search_found))
+			path_length = path_length_;
 
-		unsigned int target_node_id = map_.get_id(iT,jT);
+		ClearLists(); // release nodes taken from node_pool_ for starting node and by ExpandNode(..)
+		return path_length;
+	}
+
+
+	/** \brief Sets up a search from (iS,jS) to (iT,jT) to be run by Step(..)
+	 *
+	 *  \details The lists need to be empty (a new AStar or ClearLists() after the last search).
+	 *
+	 *  \param[in] iS The zero based x-coordinate of the start position
+	 *  \param[in] jS The zero based y-coordinate of the start position
+	 *  \param[in] iT The zero based x-coordinate of the target position
+	 *  \param[in] jT The zero based y-coordinate of the target position
+	 *
+	 *  \return false if start and target are known to be in different components
+	 *  (nothing was put on the open list); true otherwise
+	 */
+	bool AStar::Start(const int &iS, const int &jS, const int &iT, const int &jT)
+	{
+		path_length_ = -1;
+		target_id_ = map_.get_id(iT,jT);
+		if (!map_.is_reachable(map_.get_id(iS,jS), target_id_))
+			return false;
+
+		MapNode *p_start_node = node_pool_.allocate();
+		p_start_node->id_ = map_.get_id(iS,jS);
 
 		map_.set_heuristic(iT,jT);
-		open_list_.insert(p_start_node->fvalue_,p_start_node);
+		if (heuristic_policy_ == o_graph::heuristic_landmarks)
+			map_.p_landmarks_ = o_graph::FindLandmarks(map_.data_, map_.width_, map_.height_);
+		else
+			map_.p_landmarks_.reset();
+		PushOpen(p_start_node, false);
+		return true;
+	}
+
 
-		do
+	/** \brief Runs AStars main loop for a limited number of iterations
+	 *
+	 *  \details Moves at most max_expansions nodes from the open to the closed list
+	 *  (and expands them). The lists keep their state between calls, so a search
+	 *  set up by Start(..) can be spread over several calls. Nothing is released:
+	 *  the caller empties the lists by ClearLists() once the search is done.
+	 *
+	 *  \param[in] max_expansions maximum number of nodes to be taken from the open list
+	 *  \return search_found (path written to p_output_buffer_, length in path_length_),
+	 *  search_unreachable (open list exhausted) or search_in_progress (budget used up)
+	 */
+	SearchStatus AStar::Step(const unsigned int &max_expansions)
+	{
+		MapNode *p_current_node;
+		for (unsigned int n = 0; n < max_expansions; ++n)
 		{
+			if ((p_current_node = PopOpen()) == 0L)
+				return search_unreachable;
+
 			// move current note from open- to closed list
-			MapNode *p_current_node = open_list_.A_[0].data_;
-			open_list_.remove(0);
 			closed_list_.insert(p_current_node->id_, p_current_node );
 
 			// check if target reached
-			if (p_current_node->id_ == target_node_id)
+			if (p_current_node->id_ == target_id_)
 			{
-				path_length = BacktrackPath(p_current_node);
-				break;
+				path_length_ = BacktrackPath(p_current_node);
+				return search_found;
 			}
 
 			ExpandNode(p_current_node);
-
-		} while (open_list_.n_items_ != 0);
-
-		ClearLists(); // free memory allocated for starting node and by ExpandNode(..)
-		return path_length;
+		}
+		return search_in_progress;
 	}
 
 
-	/** \brief Frees memory allocated by expand_node(..)
-	 *
-	 *  \detail Memory for GraphNodes is allocated by expand_node(..) but
-	 *  the nodes (and ownership of memory) are transferred to open_list_ and closed_list_;
-	 * 	ClearLists() goes through both lists items and deletes the their data field (==graph node).
+	/** \brief Empties both lists and releases all nodes generated by the search
 	 *
-	 *  \note Note that both lists only manage nodes through pointers.
-	 *  They didn't allocate memory for nodes, so they aren't in charge of deleting them.
+	 *  \detail Memory for MapNodes is taken from node_pool_ by FindPath(..) and ExpandNode(..);
+	 *  the lists only manage nodes through pointers.
+	 * 	All nodes are released at once by resetting the pool (O(1)).
+	 * 	The closed list starts a new generation (O(1)) and the open list only
+	 * 	resets the positions of the nodes still stored in it.
+	 * 	The bucket open list keeps its buckets and starts a new generation of ids.
 	 */
 	void AStar::ClearLists()
 	{
-		closed_list_.traverse_LRN(
-				[](ClosedListItem *item) { delete item->data_; },
-				closed_list_.root_);
-		for(unsigned int i=0; i< open_list_.n_items_; ++i)
-		{
-			delete open_list_.A_[i].data_;
-		}
+		open_list_.clear();
+		bucket_list_.queue_.clear();
+		bucket_list_.ids_.next_generation();
+		closed_list_.clear();
+		node_pool_.reset();
 		return;
 	}
 
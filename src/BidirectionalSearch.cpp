@@ -0,0 +1,506 @@
+/** \file
+ * 		BidirectionalSearch.cpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (bidirectional breadth first search)
+ *
+ *  \details
+ *		Both directions are breadth first searches that expand whole levels.
+ *		Every grid point reached by a direction is marked with a generation stamp
+ *		of that direction (together with its distance and predecessor). A grid
+ *		point marked by both directions is a meeting point; the length of the
+ *		path through it is the sum of both distances. mu denotes the length of
+ *		the shortest path through any meeting point found so far.
+ *
+ *		Termination: if the forward search has visited all grid points with
+ *		distance <= lF and the backward search all grid points with distance <= lB,
+ *		every path of length <= lF + lB has a grid point visited by both directions.
+ *		So the search stops as soon as lF + lB >= mu and mu is the length of a
+ *		shortest path.
+ *
+ *		Two-thread mode: a direction first writes distance and predecessor of a
+ *		grid point, then publishes its stamp and then reads the stamp of the other
+ *		direction (all stamp accesses sequentially consistent). For a grid point
+ *		reached by both directions at least one of them sees the stamp of the
+ *		other (and its distance), so no meeting point is lost. mu and the meeting
+ *		point are published under a mutex; mu and the completed levels are
+ *		atomics that are read without lock by the termination test.
+ *		The second thread is started once per calling thread (BackwardWorker)
+ *		and only woken up for each search.
+ *
+ * 	\references
+ * 		- I. Pohl: Bi-directional search. Machine Intelligence 6, 1971, S. 127-140.
+ */
+
+
+#include <atomic>   // stamps, mu and levels shared between the directions
+#include <climits>  // INT_MAX
+#include <condition_variable>  // handing a search to the backward worker
+#include <mutex>    // publishing a meeting point
+#include <thread>   // two-thread mode
+#include <vector>   // frontiers
+#include "BidirectionalSearch.hpp"
+#include "Map.hpp"
+#include "ComponentLabels.hpp"
+
+namespace bidirectional
+{
+
+	static const int no_path = INT_MAX;              //< mu before a meeting point was found
+	static const int level_exhausted = INT_MAX / 2;  //< completed level of a direction without frontier
+
+
+	/** \brief State of one direction of the search
+	 *
+	 *  \details stamps_[id] == generation of the search <=> id was reached by this direction.
+	 *  distances_ and predecessors_ are only valid for reached grid points; they are
+	 *  written once per search (before the stamp) and never need clearing.
+	 */
+	struct SearchSide
+	{
+		SearchSide() :
+			n_nodes_(0), stamps_(0L), distances_(0L), predecessors_(0L),
+			level_(0), completed_level_(0), nodes_expanded_(0)
+		{
+			// nothing to do here
+		}
+
+		~SearchSide()
+		{
+			delete[] stamps_;
+			delete[] distances_;
+			delete[] predecessors_;
+		}
+
+		/** \brief Makes sure the buffers can hold n_nodes nodes
+		 *  \param[in] n_nodes number of nodes of the map to be searched
+		 */
+		void Reserve(const unsigned int &n_nodes)
+		{
+			if (n_nodes <= n_nodes_)
+				return;
+			delete[] stamps_;
+			delete[] distances_;
+			delete[] predecessors_;
+			n_nodes_ = n_nodes;
+			stamps_ = new std::atomic<unsigned int>[n_nodes_];
+			distances_ = new int[n_nodes_];
+			predecessors_ = new unsigned int[n_nodes_];
+			WipeStamps();
+			return;
+		}
+
+		//! \brief resets all stamps (after wrap around of the generation counter)
+		void WipeStamps()
+		{
+			for (unsigned int id=0; id<n_nodes_; ++id)
+				stamps_[id].store(0, std::memory_order_relaxed);
+			return;
+		}
+
+		unsigned int n_nodes_;                   //< number of nodes the buffers can hold
+		std::atomic<unsigned int> *stamps_;      //< generation in which a node was reached
+		int *distances_;                         //< distance of every reached node from the origin
+		unsigned int *predecessors_;             //< predecessor of every reached node (towards the origin)
+		std::vector<unsigned int> frontier_;     //< nodes with distance level_
+		std::vector<unsigned int> next_frontier_;//< nodes with distance level_+1 (under construction)
+		int level_;                              //< distance of the nodes on frontier_
+		std::atomic<int> completed_level_;       //< all nodes with distance <= completed_level_ are reached
+		unsigned int nodes_expanded_;            //< for diagnostics
+
+	private :
+		SearchSide(const SearchSide &);
+		SearchSide &operator=(const SearchSide &);
+	};
+
+
+	struct Workspace;
+
+
+	/** \brief Second thread of the two-thread mode
+	 *
+	 *  \details Runs the backward direction of the searches of one calling thread.
+	 *  The thread is started with the first search in two-thread mode and waits
+	 *  for the next search afterwards, so a query doesn't start and join a thread.
+	 */
+	class BackwardWorker
+	{
+	public :
+		BackwardWorker();
+		~BackwardWorker();
+
+		void Start(Workspace *workspace, o_graph::Map *map);
+		void Wait();
+
+	private :
+		void Loop();
+
+		std::thread thread_;                 //< the second thread (started on first use)
+		std::mutex mutex_;                   //< guards p_workspace_, p_map_ and quit_
+		std::condition_variable condition_;  //< signals a new search or its end
+		Workspace *p_workspace_;             //< search to be run (null pointer: idle)
+		o_graph::Map *p_map_;                //< map of the backward direction
+		bool quit_;                          //< set when the calling thread ends
+
+		BackwardWorker(const BackwardWorker &);
+		BackwardWorker &operator=(const BackwardWorker &);
+	};
+
+
+	/** \brief Memory used by FindPath(..) that is kept between calls
+	 *  \details Every calling thread owns one workspace (see ThreadWorkspace());
+	 *  in two-thread mode the second thread works on the backward side of it.
+	 */
+	struct Workspace
+	{
+		Workspace() :
+			generation_(0), best_length_(no_path), meeting_id_(0), stop_(false)
+		{
+			// nothing to do here
+		}
+
+		/** \brief Makes sure both directions can hold n_nodes nodes
+		 *  \param[in] n_nodes number of nodes of the map to be searched
+		 */
+		void Reserve(const unsigned int &n_nodes)
+		{
+			forward_.Reserve(n_nodes);
+			backward_.Reserve(n_nodes);
+			return;
+		}
+
+		//! \brief starts a new search (all stamps of the previous search become invalid)
+		void NextGeneration()
+		{
+			++generation_;
+			if (generation_ == 0)
+			{
+				forward_.WipeStamps();
+				backward_.WipeStamps();
+				generation_ = 1;
+			}
+			best_length_.store(no_path);
+			stop_.store(false);
+			return;
+		}
+
+		unsigned int generation_;        //< stamp of the current search
+		SearchSide forward_;             //< search from start
+		SearchSide backward_;            //< search from target
+		std::mutex meeting_mutex_;       //< guards best_length_ and meeting_id_ on update
+		std::atomic<int> best_length_;   //< mu: length of the shortest path found so far
+		unsigned int meeting_id_;        //< meeting point of the path with length mu
+		std::atomic<bool> stop_;         //< set when the termination test succeeded
+		BackwardWorker worker_;          //< second thread in two-thread mode (declared last: stops first)
+
+	private :
+		Workspace(const Workspace &);
+		Workspace &operator=(const Workspace &);
+	};
+
+
+	/** \brief Workspace of the calling thread
+	 *  \return Reference to the Workspace of the calling thread
+	 */
+	Workspace &ThreadWorkspace()
+	{
+		static thread_local Workspace workspace;
+		return workspace;
+	}
+
+
+	/** \brief Starts a direction of the search at its origin
+	 *  \param[in] workspace Workspace of the search
+	 *  \param[in] side The direction
+	 *  \param[in] origin id of the start (forward) or target (backward)
+	 */
+	void InitSide(Workspace &workspace, SearchSide &side, const unsigned int &origin)
+	{
+		side.frontier_.clear();
+		side.distances_[origin] = 0;
+		side.predecessors_[origin] = origin;
+		side.stamps_[origin].store(workspace.generation_);
+		side.frontier_.push_back(origin);
+		side.level_ = 0;
+		side.completed_level_.store(0);
+		side.nodes_expanded_ = 0;
+		return;
+	}
+
+
+	/** \brief Records a meeting point if it gives a shorter path
+	 *  \param[in] workspace Workspace of the search
+	 *  \param[in] id The meeting point
+	 *  \param[in] length Length of the path through id
+	 */
+	void PublishMeeting(Workspace &workspace, const unsigned int &id, const int &length)
+	{
+		std::lock_guard<std::mutex> lock(workspace.meeting_mutex_);
+		if (length < workspace.best_length_.load())
+		{
+			workspace.meeting_id_ = id;
+			workspace.best_length_.store(length);
+		}
+		return;
+	}
+
+
+	/** \brief Expands one level of a direction
+	 *
+	 *  \param[in] workspace Workspace of the search
+	 *  \param[in] side The direction to be expanded
+	 *  \param[in] other The opposite direction
+	 *  \param[in] map The game map (owned by the calling thread)
+	 *  \param[in] order memory order of stamp accesses (see file documentation)
+	 */
+	void ExpandLevel(Workspace &workspace, SearchSide &side, const SearchSide &other,
+			o_graph::Map &map, const std::memory_order &order)
+	{
+		const unsigned int generation = workspace.generation_;
+		const int distance = side.level_ + 1;
+		o_graph::MapNode node;
+
+		side.next_frontier_.clear();
+		for (std::size_t i=0; i<side.frontier_.size(); ++i)
+		{
+			node.id_ = side.frontier_[i];
+			map.fill_neighbour_list(&node);
+			while (!map.neighbour_list_.is_empty())
+			{
+				unsigned int id = map.neighbour_list_.pop();
+				if (side.stamps_[id].load(std::memory_order_relaxed) == generation)
+					continue; // own stamps are only written by this thread
+
+				side.distances_[id] = distance;
+				side.predecessors_[id] = node.id_;
+				side.stamps_[id].store(generation, order);
+				side.next_frontier_.push_back(id);
+				++side.nodes_expanded_;
+
+				if (other.stamps_[id].load(order) == generation)
+					PublishMeeting(workspace, id, distance + other.distances_[id]);
+			}
+		}
+
+		side.frontier_.swap(side.next_frontier_);
+		side.level_ = distance;
+		side.completed_level_.store(side.frontier_.empty() ? level_exhausted : distance, order);
+		return;
+	}
+
+
+	/** \brief Termination test (see file documentation)
+	 *  \param[in] workspace Workspace of the search
+	 *  \param[in] side The direction that just completed a level
+	 *  \param[in] other The opposite direction
+	 *  \return true if mu is the length of a shortest path or no path exists
+	 */
+	bool IsFinished(const Workspace &workspace, const SearchSide &side, const SearchSide &other)
+	{
+		int best_length = workspace.best_length_.load();
+		if (best_length == no_path)
+			return side.frontier_.empty();  // component of the origin exhausted without meeting
+		return side.completed_level_.load() + other.completed_level_.load() >= best_length;
+	}
+
+
+	/** \brief Main loop of a direction in two-thread mode
+	 *  \param[in] workspace Workspace of the search
+	 *  \param[in] side The direction to be expanded
+	 *  \param[in] other The opposite direction
+	 *  \param[in] map The game map (owned by the calling thread)
+	 */
+	void RunSide(Workspace *workspace, SearchSide *side, const SearchSide *other, o_graph::Map *map)
+	{
+		while (!workspace->stop_.load())
+		{
+			ExpandLevel(*workspace, *side, *other, *map, std::memory_order_seq_cst);
+			if (IsFinished(*workspace, *side, *other))
+				workspace->stop_.store(true);
+		}
+		return;
+	}
+
+
+	BackwardWorker::BackwardWorker() :
+		p_workspace_(0L), p_map_(0L), quit_(false)
+	{
+		// nothing to do here
+	}
+
+
+	//! \brief Stops the second thread (if it was started)
+	BackwardWorker::~BackwardWorker()
+	{
+		if (!thread_.joinable())
+			return;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			quit_ = true;
+		}
+		condition_.notify_all();
+		thread_.join();
+	}
+
+
+	/** \brief Hands the backward direction of a search to the second thread
+	 *  \param[in] workspace Workspace of the search (both directions initialised)
+	 *  \param[in] map The game map of the backward direction (not used by the calling thread)
+	 */
+	void BackwardWorker::Start(Workspace *workspace, o_graph::Map *map)
+	{
+		if (!thread_.joinable())
+			thread_ = std::thread(&BackwardWorker::Loop, this);
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			p_workspace_ = workspace;
+			p_map_ = map;
+		}
+		condition_.notify_all();
+		return;
+	}
+
+
+	//! \brief Blocks until the backward direction of the current search is done
+	void BackwardWorker::Wait()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (p_workspace_ != 0L)
+			condition_.wait(lock);
+		return;
+	}
+
+
+	//! \brief Main loop of the second thread: runs one backward direction per search
+	void BackwardWorker::Loop()
+	{
+		std::unique_lock<std::mutex> lock(mutex_);
+		while (true)
+		{
+			while ((p_workspace_ == 0L) && !quit_)
+				condition_.wait(lock);
+			if (p_workspace_ == 0L)
+				return;
+
+			Workspace *workspace = p_workspace_;
+			o_graph::Map *map = p_map_;
+			lock.unlock();
+			RunSide(workspace, &workspace->backward_, &workspace->forward_, map);
+			lock.lock();
+			p_workspace_ = 0L;
+			condition_.notify_all();
+		}
+	}
+
+
+	/** \brief Writes the path through the meeting point to pOutBuffer
+	 *
+	 *  \param[in] workspace Workspace of the search
+	 *  \param[in] nPathLength length of the path (mu)
+	 *  \param[out] pOutBuffer Buffer to write the path to (owned by caller, at least nPathLength entries)
+	 */
+	void ReconstructPath(const Workspace &workspace, const int &nPathLength, int* pOutBuffer)
+	{
+		const SearchSide &forward = workspace.forward_;
+		const SearchSide &backward = workspace.backward_;
+
+		// meeting point and its predecessors towards start
+		unsigned int id = workspace.meeting_id_;
+		while (forward.distances_[id] > 0)
+		{
+			pOutBuffer[forward.distances_[id]-1] = id;
+			id = forward.predecessors_[id];
+		}
+
+		// successors of the meeting point towards target
+		id = workspace.meeting_id_;
+		while (backward.distances_[id] > 0)
+		{
+			id = backward.predecessors_[id];
+			pOutBuffer[nPathLength - backward.distances_[id] - 1] = id;
+		}
+		return;
+	}
+
+
+	//! \brief Interface to use the bidirectional search (see BidirectionalSearch.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize)
+	{
+		unsigned int nodes_expanded;
+		return FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+				pOutBuffer, nOutBufferSize, nodes_expanded, search_alternating);
+	}
+
+
+	//! \brief Interface with diagnostics (alternating mode), see BidirectionalSearch.hpp
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		return FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+				pOutBuffer, nOutBufferSize, nodes_expanded, search_alternating);
+	}
+
+
+	/** \brief bidirectional searchs main loop
+	 *
+	 *  \details Parameters and return value see BidirectionalSearch.hpp
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded,
+				 const SearchMode &mode)
+	{
+		nodes_expanded = 0;
+		o_graph::Map forward_map(nMapWidth, nMapHeight, pMap);
+		unsigned int nStartId = forward_map.get_id(nStartX, nStartY);
+		unsigned int nTargetId = forward_map.get_id(nTargetX, nTargetY);
+
+		if (nStartId == nTargetId)
+			return 0;
+		if (!forward_map.is_reachable(nStartId, nTargetId))
+			return -1;
+
+		Workspace &workspace = ThreadWorkspace();
+		workspace.Reserve(nMapWidth*nMapHeight);
+		workspace.NextGeneration();
+		SearchSide &forward = workspace.forward_;
+		SearchSide &backward = workspace.backward_;
+		InitSide(workspace, forward, nStartId);
+		InitSide(workspace, backward, nTargetId);
+
+		if (mode == search_two_threads)
+		{
+			o_graph::Map backward_map(forward_map);
+			workspace.worker_.Start(&workspace, &backward_map);
+			RunSide(&workspace, &forward, &backward, &forward_map);
+			workspace.worker_.Wait();
+		}
+		else
+		{
+			bool finished = false;
+			while (!finished)
+			{
+				bool expand_forward = (forward.frontier_.size() <= backward.frontier_.size());
+				SearchSide &side = expand_forward ? forward : backward;
+				SearchSide &other = expand_forward ? backward : forward;
+				ExpandLevel(workspace, side, other, forward_map, std::memory_order_relaxed);
+				finished = IsFinished(workspace, side, other);
+			}
+		}
+
+		nodes_expanded = forward.nodes_expanded_ + backward.nodes_expanded_;
+		int nPathLength = workspace.best_length_.load();
+		if (nPathLength == no_path)
+			return -1;
+		if (nPathLength <= nOutBufferSize)
+			ReconstructPath(workspace, nPathLength, pOutBuffer);
+		return nPathLength;
+	}
+
+} // END OF NAMESPACE bidirectional
@@ -0,0 +1,394 @@
+/** \file
+ * 		BitboardSearch.cpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (bit-parallel breadth first search)
+ *
+ *  \details
+ *		The map is stored as bitboard of 8x8 tiles: bit 8*(y%8) + x%8 of word
+ *		(y/8)*nPitch + x/8 belongs to the grid point (x,y); the map is padded to
+ *		whole tiles (nPitch tiles per row of tiles). One step of the wavefront turns
+ *		the frontier of level k into the frontier of level k+1 by shifting every
+ *		frontier word left, right, up and down (with carries into the neighbouring
+ *		tiles) and masking with the traversable and not yet visited grid points.
+ *
+ *		Only words containing frontier bits are processed, so a step costs
+ *		O(frontier words) and not O(map size / 64). This matters in mazes where
+ *		the wavefront is thin but spread over the whole map. Square tiles
+ *		(instead of 64 grid points of a row) keep more frontier bits per word,
+ *		since the wavefront of a BFS runs diagonally across the rows.
+ *
+ *		The path is reconstructed from the distance of every visited grid point
+ *		modulo 3 (two bitboards): neighbours of a visited grid point differ in
+ *		distance by at most 1, so the predecessor on a shortest path is the
+ *		visited neighbour with distance k-1 (mod 3).
+ *
+ * 	\references
+ * 		- Mehlhorn, Kurt; Sanders, Peter (2008). "Chapter 9. Graph Traversal".
+ * 		  Algorithms and Data Structures: The Basic Toolbox. Springer.
+ */
+
+
+#include <vector>
+#include "BitboardSearch.hpp"
+#include "GenerationStamps.hpp"
+#include "ComponentLabels.hpp"
+
+namespace bitboard
+{
+
+	typedef unsigned long long Word;   //< 8x8 tile of grid points
+	static const int nTileSize = 8;    //< extent of a tile in x- and y-direction
+
+	static const Word nFileFirst = 0x0101010101010101ULL;  //< grid points with x%8 == 0
+	static const Word nFileLast = 0x8080808080808080ULL;   //< grid points with x%8 == 7
+
+
+	/** \brief calculates the index of the tile a grid point belongs to
+	 *  \param[in] x x-coordinate of the grid point
+	 *  \param[in] y y-coordinate of the grid point
+	 *  \param[in] nPitch number of tiles per row of tiles
+	 *  \return index of the word
+	 */
+	inline unsigned int GetWord(const int &x, const int &y, const int &nPitch) {
+		return (y/nTileSize)*nPitch + x/nTileSize;
+	}
+
+
+	/** \brief calculates the bit of a grid point within its tile
+	 *  \param[in] x x-coordinate of the grid point
+	 *  \param[in] y y-coordinate of the grid point
+	 *  \return word with the bit of (x,y) set
+	 */
+	inline Word GetBit(const int &x, const int &y) {
+		return (Word) 1 << ((y%nTileSize)*nTileSize + x%nTileSize);
+	}
+
+
+	//! \brief A word of the wavefront (index of the word and its frontier bits)
+	struct FrontierWord
+	{
+		FrontierWord(const unsigned int &id, const Word &bits) :
+			id(id), bits(bits)
+		{
+			// nothing to do here
+		}
+
+		unsigned int id;  //< index of the word (see GetWord(..))
+		Word bits;        //< grid points of the word that belong to the frontier
+	};
+
+
+	/** \brief Memory used by FindPath(..) that is kept between calls
+	 *
+	 *  \details Every thread owns one workspace (see ThreadWorkspace()).
+	 *  Words of the bitboards are initialized on first use during a search
+	 *  (marked by generation stamps), so neither packing the map nor clearing
+	 *  the bitboards costs O(map size) per search.
+	 *  pNext is zero outside of a wavefront step.
+	 */
+	struct Workspace
+	{
+		Workspace() :
+			nWords(0), pMask(0L), pVisited(0L), pLevelBit0(0L), pLevelBit1(0L), pNext(0L)
+		{
+			// nothing to do here
+		}
+
+		~Workspace()
+		{
+			delete[] pMask;
+			delete[] pVisited;
+			delete[] pLevelBit0;
+			delete[] pLevelBit1;
+			delete[] pNext;
+		}
+
+		/** \brief Makes sure the bitboards can hold nWordsRequired words
+		 *  \param[in] nWordsRequired number of words of the map to be searched
+		 */
+		void Reserve(const unsigned int nWordsRequired)
+		{
+			if (nWordsRequired <= nWords)
+				return;
+			delete[] pMask;
+			delete[] pVisited;
+			delete[] pLevelBit0;
+			delete[] pLevelBit1;
+			delete[] pNext;
+			nWords = nWordsRequired;
+			sWords.resize(nWords);
+			sWords.next_generation(); // words of the old bitboards are invalid
+			pMask = new Word[nWords];
+			pVisited = new Word[nWords];
+			pLevelBit0 = new Word[nWords];
+			pLevelBit1 = new Word[nWords];
+			pNext = new Word[nWords]();
+			return;
+		}
+
+		unsigned int nWords;                             //< number of words the bitboards can hold
+		o_data_structures::GenerationStamps<> sWords;    //< marks words initialized during the current search
+		Word *pMask;                                     //< traversable grid points
+		Word *pVisited;                                  //< grid points reached by the wavefront
+		Word *pLevelBit0;                                //< bit 0 of (distance from start) % 3
+		Word *pLevelBit1;                                //< bit 1 of (distance from start) % 3
+		Word *pNext;                                     //< candidates for the next frontier
+		std::vector<unsigned int> vCandidates;           //< words with nonzero pNext
+		std::vector<FrontierWord> vFrontier;             //< current frontier
+		std::vector<FrontierWord> vNextFrontier;         //< frontier under construction
+
+	private :
+		Workspace(const Workspace &);
+		Workspace &operator=(const Workspace &);
+	};
+
+
+	/** \brief Workspace of the calling thread
+	 *  \return Reference to the Workspace of the calling thread
+	 */
+	Workspace &ThreadWorkspace()
+	{
+		static thread_local Workspace workspace;
+		return workspace;
+	}
+
+
+	/** \brief Initializes a word of the bitboards on its first use during a search
+	 *
+	 *  \param[in] workspace Workspace of the search
+	 *  \param[in] id Index of the word
+	 *  \param[in] pMap A pointer to the grid data
+	 *  \param[in] nMapWidth the width of the map
+	 *  \param[in] nMapHeight the height of the map
+	 *  \param[in] nPitch number of tiles per row of tiles
+	 */
+	inline void InitWord(Workspace &workspace, const unsigned int &id,
+			const unsigned char* pMap, const int &nMapWidth, const int &nMapHeight, const int &nPitch)
+	{
+		if (workspace.sWords.is_set(id))
+			return;
+		workspace.sWords.set(id);
+
+		int x_first = (id % nPitch) * nTileSize;
+		int y_first = (id / nPitch) * nTileSize;
+		int x_end = (x_first + nTileSize < nMapWidth) ? x_first + nTileSize : nMapWidth;
+		int y_end = (y_first + nTileSize < nMapHeight) ? y_first + nTileSize : nMapHeight;
+
+		Word mask = 0;
+		for (int y=y_first; y<y_end; ++y)
+		{
+			const unsigned char *pRow = pMap + y*nMapWidth;
+			for (int x=x_first; x<x_end; ++x)
+				mask |= (Word) (pRow[x] == 1) << ((y-y_first)*nTileSize + x-x_first);
+		}
+
+		workspace.pMask[id] = mask;
+		workspace.pVisited[id] = 0;
+		workspace.pLevelBit0[id] = 0;
+		workspace.pLevelBit1[id] = 0;
+		return;
+	}
+
+
+	/** \brief Adds candidate bits for the next frontier
+	 *  \param[in] workspace Workspace of the search
+	 *  \param[in] id Index of the word
+	 *  \param[in] bits candidate grid points within the word
+	 */
+	inline void AddCandidates(Workspace &workspace, const unsigned int &id, const Word &bits)
+	{
+		if (bits == 0)
+			return;
+		if (workspace.pNext[id] == 0)
+			workspace.vCandidates.push_back(id);
+		workspace.pNext[id] |= bits;
+		return;
+	}
+
+
+	/** \brief checks if a grid point was reached with a certain distance (mod 3)
+	 *
+	 *  \param[in] workspace Workspace of the search
+	 *  \param[in] x x-coordinate of the grid point
+	 *  \param[in] y y-coordinate of the grid point
+	 *  \param[in] nPitch number of tiles per row of tiles
+	 *  \param[in] nLevelMod3 distance from start modulo 3
+	 *  \return true if (x,y) was visited with a distance equal to nLevelMod3 (mod 3)
+	 */
+	inline bool IsOnLevel(const Workspace &workspace, const int &x, const int &y,
+			const int &nPitch, const int &nLevelMod3)
+	{
+		unsigned int id = GetWord(x, y, nPitch);
+		if (!workspace.sWords.is_set(id))
+			return false;
+		Word bit = GetBit(x, y);
+		if ((workspace.pVisited[id] & bit) == 0)
+			return false;
+		int nLevel = ((workspace.pLevelBit0[id] & bit) ? 1 : 0) + ((workspace.pLevelBit1[id] & bit) ? 2 : 0);
+		return nLevel == nLevelMod3;
+	}
+
+
+	/** \brief Writes the path to pOutBuffer starting from the target position
+	 *
+	 *  \param[in] workspace Workspace of the search (visited grid points and their distances)
+	 *  \param[in] nTargetX x-coordinate of the target
+	 *  \param[in] nTargetY y-coordinate of the target
+	 *  \param[in] nMapWidth the width of the map
+	 *  \param[in] nMapHeight the height of the map
+	 *  \param[in] nPitch number of tiles per row of tiles
+	 *  \param[in] nPathLength distance of the target from start
+	 *  \param[out] pOutBuffer Buffer to write the path to (owned by caller, at least nPathLength entries)
+	 */
+	void ReconstructPath(const Workspace &workspace, int nTargetX, int nTargetY,
+			const int &nMapWidth, const int &nMapHeight, const int &nPitch,
+			const int &nPathLength, int* pOutBuffer)
+	{
+		static const int dx[4] = {1, -1, 0, 0};
+		static const int dy[4] = {0, 0, 1, -1};
+
+		int x = nTargetX;
+		int y = nTargetY;
+		for (int nLevel=nPathLength; nLevel>0; --nLevel)
+		{
+			pOutBuffer[nLevel-1] = x + y*nMapWidth;
+			for (int i=0; i<4; ++i)
+			{
+				int x_from = x + dx[i];
+				int y_from = y + dy[i];
+				if ((x_from < 0) || (x_from >= nMapWidth) || (y_from < 0) || (y_from >= nMapHeight))
+					continue;
+				if (IsOnLevel(workspace, x_from, y_from, nPitch, (nLevel-1) % 3))
+				{
+					x = x_from;
+					y = y_from;
+					break;
+				}
+			}
+		}
+		return;
+	}
+
+
+	/** \brief Interface to use the bit-parallel breadth first search (see BitboardSearch.hpp)
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize)
+	{
+		unsigned int nodes_expanded;
+		return FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+				pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+
+	/** \brief bit-parallel breadth first searchs main loop
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *  \param[out] nodes_expanded number of grid points reached by the wavefront
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		const int nPitch = (nMapWidth + nTileSize - 1) / nTileSize;
+		const unsigned int nWords = nPitch*((nMapHeight + nTileSize - 1) / nTileSize);
+
+		Workspace &workspace = ThreadWorkspace();
+		workspace.Reserve(nWords);
+		workspace.sWords.next_generation();
+		workspace.vFrontier.clear();
+
+		Word *pNext = workspace.pNext;
+		std::vector<unsigned int> &vCandidates = workspace.vCandidates;
+
+		unsigned int nTargetWord = GetWord(nTargetX, nTargetY, nPitch);
+		Word nTargetBit = GetBit(nTargetX, nTargetY);
+		unsigned int nStartWord = GetWord(nStartX, nStartY, nPitch);
+		Word nStartBit = GetBit(nStartX, nStartY);
+
+		nodes_expanded = 0;
+		if ((nStartX == nTargetX) && (nStartY == nTargetY))
+			return 0;
+
+		const std::shared_ptr<const o_graph::ComponentLabels> pComponents = o_graph::FindComponents(pMap, nMapWidth, nMapHeight);
+		if (pComponents && !pComponents->connected(nStartX + nStartY*nMapWidth,
+				nTargetX + nTargetY*nMapWidth))
+			return -1;
+
+		InitWord(workspace, nStartWord, pMap, nMapWidth, nMapHeight, nPitch);
+		workspace.pVisited[nStartWord] |= nStartBit;
+		workspace.vFrontier.push_back(FrontierWord(nStartWord, nStartBit));
+
+		int nPathLength = -1;
+		int nLevel = 0;
+		while (!workspace.vFrontier.empty() && (nPathLength < 0))
+		{
+			++nLevel;
+
+			// shift every frontier word into its own and the neighbouring tiles
+			for (std::size_t i=0; i<workspace.vFrontier.size(); ++i)
+			{
+				unsigned int id = workspace.vFrontier[i].id;
+				Word bits = workspace.vFrontier[i].bits;
+				int tx = id % nPitch;
+
+				AddCandidates(workspace, id, ((bits << 1) & ~nFileFirst) | ((bits >> 1) & ~nFileLast)
+						| (bits << nTileSize) | (bits >> nTileSize));
+				if (tx > 0)
+					AddCandidates(workspace, id-1, (bits & nFileFirst) << (nTileSize-1));
+				if (tx < nPitch-1)
+					AddCandidates(workspace, id+1, (bits & nFileLast) >> (nTileSize-1));
+				if (id >= (unsigned int) nPitch)
+					AddCandidates(workspace, id-nPitch, bits << (nTileSize*(nTileSize-1)));
+				if (id + nPitch < nWords)
+					AddCandidates(workspace, id+nPitch, bits >> (nTileSize*(nTileSize-1)));
+			}
+
+			// mask candidates with traversable and not yet visited grid points
+			Word nLevelBit0 = (nLevel % 3 == 1) ? ~(Word) 0 : 0;
+			Word nLevelBit1 = (nLevel % 3 == 2) ? ~(Word) 0 : 0;
+			workspace.vNextFrontier.clear();
+			for (std::size_t i=0; i<vCandidates.size(); ++i)
+			{
+				unsigned int id = vCandidates[i];
+				Word bits = pNext[id];
+				pNext[id] = 0;
+
+				InitWord(workspace, id, pMap, nMapWidth, nMapHeight, nPitch);
+				bits &= workspace.pMask[id] & ~workspace.pVisited[id];
+				if (bits == 0)
+					continue;
+
+				workspace.pVisited[id] |= bits;
+				workspace.pLevelBit0[id] |= bits & nLevelBit0;
+				workspace.pLevelBit1[id] |= bits & nLevelBit1;
+				nodes_expanded += __builtin_popcountll(bits);
+				workspace.vNextFrontier.push_back(FrontierWord(id, bits));
+
+				if ((id == nTargetWord) && (bits & nTargetBit))
+					nPathLength = nLevel;
+			}
+			vCandidates.clear();
+			workspace.vFrontier.swap(workspace.vNextFrontier);
+		}
+
+		if ((nPathLength > 0) && (nPathLength <= nOutBufferSize))
+			ReconstructPath(workspace, nTargetX, nTargetY, nMapWidth, nMapHeight, nPitch,
+					nPathLength, pOutBuffer);
+		return nPathLength;
+	}
+
+} // END OF NAMESPACE bitboard
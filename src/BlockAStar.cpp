@@ -0,0 +1,517 @@
+/** \file
+ * 		BlockAStar.cpp
+ *
+ * 	\brief
+ *		Provides pathfinding capabilities on blocks of 4x4 grid points (Block A*)
+ *
+ * 	\details
+ * 		Contains definitions to accompnying header BlockAStar.hpp
+ * 		and the database shared by all searches.
+ * 		This file is part of project pdx_pathfinding
+ */
+
+#include <atomic>     // fast path of SharedDatabase()
+#include <climits>    // INT_MAX
+#include <cstdlib>    // abs(..)
+#include <cstring>    // std::memcmp
+#include <fstream>    // persistence
+#include <mutex>      // first use of the shared database from several threads
+#include "BlockAStar.hpp"
+
+namespace blockastar
+{
+
+	const int LocalDistanceDatabase::block_size_;
+	const unsigned int LocalDistanceDatabase::n_patterns_;
+	const unsigned char LocalDistanceDatabase::unreachable_;
+
+	static const char file_magic[8] = "PDXLDB1";       //< first bytes of a database file
+	static const unsigned int boundary_mask = 0xF99Fu; //< grid points of a block with neighbours in other blocks
+
+
+	/** \brief FNV-1a checksum of the distances
+	 *  \param[in] distances The distances
+	 *  \return checksum
+	 */
+	static unsigned long long DistancesChecksum(const std::vector<unsigned char> &distances)
+	{
+		unsigned long long checksum = 14695981039346656037ULL;
+		for (std::size_t i=0; i<distances.size(); ++i)
+		{
+			checksum ^= distances[i];
+			checksum *= 1099511628211ULL;
+		}
+		return checksum;
+	}
+
+
+	/** \brief Constructor: breadth first search from every traversable grid point of every pattern
+	 *  \details About 0.1 s; the database is built only once per process (see SharedDatabase()).
+	 */
+	LocalDistanceDatabase::LocalDistanceDatabase() :
+		distances_(n_patterns_ << 8, unreachable_), checksum_(0)
+	{
+		unsigned int queue[16];
+		for (unsigned int pattern=0; pattern<n_patterns_; ++pattern)
+		{
+			unsigned char *table = &distances_[pattern << 8];
+			for (unsigned int from=0; from<16; ++from)
+			{
+				if (((pattern >> from) & 1u) == 0)
+					continue;
+				unsigned char *row = table + (from << 4);
+				unsigned int n_queued = 0;
+				row[from] = 0;
+				queue[n_queued++] = from;
+				for (unsigned int head=0; head<n_queued; ++head)
+				{
+					const unsigned int cell = queue[head];
+					unsigned int neighbours[4];
+					unsigned int n_neighbours = 0;
+					if ((cell & 3) < 3)  neighbours[n_neighbours++] = cell+1;
+					if ((cell & 3) > 0)  neighbours[n_neighbours++] = cell-1;
+					if (cell < 12)       neighbours[n_neighbours++] = cell+4;
+					if (cell >= 4)       neighbours[n_neighbours++] = cell-4;
+					for (unsigned int i=0; i<n_neighbours; ++i)
+					{
+						const unsigned int neighbour = neighbours[i];
+						if ( (((pattern >> neighbour) & 1u) == 0) || (row[neighbour] != unreachable_) )
+							continue;
+						row[neighbour] = (unsigned char) (row[cell] + 1);
+						queue[n_queued++] = neighbour;
+					}
+				}
+			}
+		}
+		checksum_ = DistancesChecksum(distances_);
+	}
+
+
+	//! \brief Constructor without any distances (to be read by Load(..))
+	LocalDistanceDatabase::LocalDistanceDatabase(const Empty &) :
+		distances_(), checksum_(0)
+	{
+		// nothing to do here
+	}
+
+
+	//! \brief memory used by the database (bytes)
+	std::size_t LocalDistanceDatabase::get_memory_footprint() const
+	{
+		return sizeof(LocalDistanceDatabase) + distances_.capacity();
+	}
+
+
+	/** \brief Writes the database to a file (format see LocalDistanceDatabase)
+	 *  \param[in] file_name Path of the file
+	 *  \return Error code: 0 on success; -1 otherwise
+	 */
+	int LocalDistanceDatabase::Save(const std::string &file_name) const
+	{
+		std::ofstream stream(file_name.c_str(), std::ofstream::out | std::ofstream::binary);
+		if (!stream.good())
+			return -1;
+
+		const int block_size = block_size_;
+		stream.write(file_magic, sizeof(file_magic));
+		stream.write(reinterpret_cast<const char *>(&block_size), sizeof(block_size));
+		stream.write(reinterpret_cast<const char *>(&checksum_), sizeof(checksum_));
+		stream.write(reinterpret_cast<const char *>(&distances_[0]), distances_.size());
+		return stream.good() ? 0 : -1;
+	}
+
+
+	/** \brief Reads a database from a file
+	 *
+	 *  \details Load(..) is a factory function: ownership of the database
+	 *  is transferred to caller.
+	 *
+	 *  \param[in] file_name Path of the file
+	 *  \return the database; null pointer if the file can't be read or is damaged (checksum)
+	 */
+	LocalDistanceDatabase *LocalDistanceDatabase::Load(const std::string &file_name)
+	{
+		std::ifstream stream(file_name.c_str(), std::ifstream::in | std::ifstream::binary);
+		if (!stream.good())
+			return 0L;
+
+		char magic[sizeof(file_magic)];
+		int block_size;
+		unsigned long long checksum;
+		stream.read(magic, sizeof(magic));
+		stream.read(reinterpret_cast<char *>(&block_size), sizeof(block_size));
+		stream.read(reinterpret_cast<char *>(&checksum), sizeof(checksum));
+		if ( !stream.good() || (std::memcmp(magic, file_magic, sizeof(file_magic)) != 0)
+				|| (block_size != block_size_) )
+			return 0L;
+
+		LocalDistanceDatabase *p_database = new LocalDistanceDatabase(Empty());
+		p_database->distances_.resize(n_patterns_ << 8);
+		stream.read(reinterpret_cast<char *>(&p_database->distances_[0]), p_database->distances_.size());
+		p_database->checksum_ = DistancesChecksum(p_database->distances_);
+		if (!stream.good() || (p_database->checksum_ != checksum))
+		{
+			delete p_database;
+			return 0L;
+		}
+		return p_database;
+	}
+
+
+
+
+	static std::mutex database_mutex;                                  //< guards creation of shared_database
+	static std::atomic<const LocalDistanceDatabase *> shared_database(0L); //< database of all searches (never released)
+
+
+	/** \brief Provides the database shared by all searches
+	 *
+	 *  \details On the first call the database is read from file_name if that file holds
+	 *  a valid database; otherwise it is built and saved to file_name.
+	 *  Later calls return the same database.
+	 *
+	 *  \param[in] file_name database file (empty: neither read nor saved)
+	 *  \return the database (owned by this module, valid until the end of the process)
+	 */
+	const LocalDistanceDatabase &PrepareDatabase(const std::string &file_name)
+	{
+		std::lock_guard<std::mutex> lock(database_mutex);
+		const LocalDistanceDatabase *p_shared = shared_database;
+		if (p_shared != 0L)
+			return *p_shared;
+
+		LocalDistanceDatabase *p_database = file_name.empty() ? 0L : LocalDistanceDatabase::Load(file_name);
+		if (p_database == 0L)
+		{
+			p_database = new LocalDistanceDatabase();
+			if (!file_name.empty())
+				p_database->Save(file_name);
+		}
+		shared_database = p_database;
+		return *p_database;
+	}
+
+
+	//! \brief database used by the searches (built on first use, see PrepareDatabase(..))
+	const LocalDistanceDatabase &SharedDatabase()
+	{
+		const LocalDistanceDatabase *p_shared = shared_database;
+		if (p_shared != 0L)
+			return *p_shared;
+		return PrepareDatabase(std::string());
+	}
+
+
+
+
+	//! \brief workspace of the interface functions (one per thread)
+	static Workspace &ThreadWorkspace()
+	{
+		static thread_local Workspace workspace;
+		return workspace;
+	}
+
+
+	//! \brief Interface to use Block A* (see BlockAStar.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize)
+	{
+		unsigned int nodes_expanded;
+		return FindPath(nStartX, nStartY, nTargetX, nTargetY,
+				pMap, nMapWidth, nMapHeight, pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+
+	//! \brief Interface with diagnostics (see BlockAStar.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		int return_value;
+		o_graph::Map map(nMapWidth,nMapHeight,pMap);
+		BlockAStar Pathfinder(map,pOutBuffer,nOutBufferSize);
+		return_value = Pathfinder.FindPath(nStartX, nStartY, nTargetX, nTargetY);
+		nodes_expanded = Pathfinder.nodes_expanded_;
+		return return_value;
+	}
+
+
+	/** \brief Constructor
+	 *  \param[in] map Reference to the game map represented by an instance of class Map
+	 *  \param[in] p_buffer Pointer to the output buffer where the path is written to (Memory ownership by caller)
+	 *  \param[in] size_buffer length of the buffer p_buffer
+	 */
+	BlockAStar::BlockAStar(o_graph::Map &map, int *p_buffer, int size_buffer) :
+			nodes_expanded_(0), output_buffer_size_(size_buffer), p_output_buffer_(p_buffer), map_(map),
+			database_(SharedDatabase()), workspace_(ThreadWorkspace()),
+			n_blocks_x_((map.width_ + 3) / 4), n_blocks_y_((map.height_ + 3) / 4),
+			target_x_(0), target_y_(0)
+	{
+		// nothing to do here
+	}
+
+
+	/** \brief Constructor using a Workspace provided by the caller
+	 *  \param[in] map Reference to the game map represented by an instance of class Map
+	 *  \param[in] p_buffer Pointer to the output buffer where the path is written to (Memory ownership by caller)
+	 *  \param[in] size_buffer length of the buffer p_buffer
+	 *  \param[in] workspace Lists used by the search
+	 */
+	BlockAStar::BlockAStar(o_graph::Map &map, int *p_buffer, int size_buffer, Workspace &workspace) :
+			nodes_expanded_(0), output_buffer_size_(size_buffer), p_output_buffer_(p_buffer), map_(map),
+			database_(SharedDatabase()), workspace_(workspace),
+			n_blocks_x_((map.width_ + 3) / 4), n_blocks_y_((map.height_ + 3) / 4),
+			target_x_(0), target_y_(0)
+	{
+		// nothing to do here
+	}
+
+
+	/** \brief block index of a grid point
+	 *  \param[in] id id of the grid point (see Map.hpp)
+	 *  \return the block index (see Workspace)
+	 */
+	unsigned int BlockAStar::get_block_index(const unsigned int &id) const
+	{
+		const unsigned int x = id % map_.width_;
+		const unsigned int y = id / map_.width_;
+		return (((y >> 2)*n_blocks_x_ + (x >> 2)) << 4) | ((y & 3) << 2) | (x & 3);
+	}
+
+
+	/** \brief pattern of a block (read from the map on first use in a search)
+	 *  \param[in] block The block
+	 *  \return the pattern (see LocalDistanceDatabase)
+	 */
+	unsigned int BlockAStar::get_pattern(const unsigned int &block)
+	{
+		if (workspace_.known_.is_set(block))
+			return workspace_.patterns_[block];
+
+		const int x0 = (block % n_blocks_x_)*4;
+		const int y0 = (block / n_blocks_x_)*4;
+		unsigned int pattern = 0;
+		for (int dy=0; (dy<4) && (y0+dy<map_.height_); ++dy)
+		{
+			const unsigned char *row = map_.data_ + (y0+dy)*map_.width_;
+			for (int dx=0; (dx<4) && (x0+dx<map_.width_); ++dx)
+				if (row[x0+dx] == o_graph::Map::terrain_traversable_)
+					pattern |= 1u << (dy*4 + dx);
+		}
+		workspace_.known_.set(block);
+		workspace_.patterns_[block] = (unsigned short) pattern;
+		workspace_.ingress_[block] = 0;
+		return pattern;
+	}
+
+
+	/** \brief Updates a grid point reached from a neighbouring block
+	 *
+	 *  \details An improved grid point becomes an ingress grid point of its block
+	 *  and the block is put on the open list (or its key decreased).
+	 *
+	 *  \param[in] cell block index of the reached grid point
+	 *  \param[in] g path cost of cell via parent
+	 *  \param[in] h heuristic of cell (manhattan distance to the target)
+	 *  \param[in] parent block index of the predecessor
+	 */
+	void BlockAStar::RelaxCell(const unsigned int &cell, const int &g, const int &h, const unsigned int &parent)
+	{
+		const unsigned int block = cell >> 4;
+		const unsigned int local = cell & 15;
+		if (((get_pattern(block) >> local) & 1u) == 0)
+			return;
+		if (workspace_.reached_.is_set(cell) && (workspace_.g_[cell] <= g))
+			return;
+
+		workspace_.reached_.set(cell);
+		workspace_.g_[cell] = g;
+		workspace_.parents_[cell] = parent;
+		workspace_.ingress_[block] |= (unsigned short) (1u << local);
+
+		const unsigned long long key = get_key(g+h, g);
+		o_data_structures::IndexedBinaryHeap<unsigned long long, unsigned int> &open_list = workspace_.open_list_;
+		if (!open_list.contains(block))
+			open_list.insert(block, key, block);
+		else if (key < open_list.A_[open_list.position(block)].key_)
+			open_list.change_key_by_id(block, key);
+		return;
+	}
+
+
+	/** \brief Relaxes all grid points of a block from its ingress grid points
+	 *  and steps from improved boundary grid points into the neighbouring blocks
+	 *  \param[in] block The block (taken from the open list)
+	 */
+	void BlockAStar::ExpandBlock(const unsigned int &block)
+	{
+		const unsigned char *table = database_.get_table(get_pattern(block));
+		const unsigned int base = block << 4;
+		const unsigned int ingress = workspace_.ingress_[block];
+		workspace_.ingress_[block] = 0;
+
+		int best[16];
+		unsigned int from[16];
+		for (unsigned int x=0; x<16; ++x)
+			best[x] = INT_MAX;
+		for (unsigned int mask=ingress; mask!=0; mask&=mask-1)
+		{
+			const unsigned int y = __builtin_ctz(mask);
+			const int g = workspace_.g_[base+y];
+			const unsigned char *row = table + (y << 4);
+			for (unsigned int x=0; x<16; ++x)
+			{
+				const int candidate = (row[x] == LocalDistanceDatabase::unreachable_) ? INT_MAX : g + row[x];
+				from[x] = (candidate < best[x]) ? y : from[x];
+				best[x] = (candidate < best[x]) ? candidate : best[x];
+			}
+		}
+
+		// grid points improved now or reached from outside haven't been passed on yet
+		unsigned int improved = ingress;
+		for (unsigned int x=0; x<16; ++x)
+		{
+			if (best[x] == INT_MAX)
+				continue;
+			const unsigned int cell = base + x;
+			if (workspace_.reached_.is_set(cell) && (workspace_.g_[cell] <= best[x]))
+				continue;
+			workspace_.reached_.set(cell);
+			workspace_.g_[cell] = best[x];
+			workspace_.parents_[cell] = base + from[x];
+			improved |= 1u << x;
+		}
+
+		const unsigned int bx = block % n_blocks_x_;
+		const unsigned int by = block / n_blocks_x_;
+		for (unsigned int mask=improved & boundary_mask; mask!=0; mask&=mask-1)
+		{
+			const unsigned int x = __builtin_ctz(mask);
+			const unsigned int cell = base + x;
+			const int g = workspace_.g_[cell] + 1;
+			const int dx = bx*4 + (x & 3) - target_x_;
+			const int dy = by*4 + (x >> 2) - target_y_;
+			if (((x & 3) == 3) && (bx+1 < n_blocks_x_))
+				RelaxCell(((block+1) << 4) | (x-3), g, abs(dx+1) + abs(dy), cell);
+			if (((x & 3) == 0) && (bx > 0))
+				RelaxCell(((block-1) << 4) | (x+3), g, abs(dx-1) + abs(dy), cell);
+			if ((x >= 12) && (by+1 < n_blocks_y_))
+				RelaxCell(((block+n_blocks_x_) << 4) | (x-12), g, abs(dx) + abs(dy+1), cell);
+			if ((x < 4) && (by > 0))
+				RelaxCell(((block-n_blocks_x_) << 4) | (x+12), g, abs(dx) + abs(dy-1), cell);
+		}
+		return;
+	}
+
+
+	/** \brief Searches the shortest path from (iS,jS) to (iT,jT)
+	 *
+	 *  \param[in] iS The zero based x-coordinate of the start position
+	 *  \param[in] jS The zero based y-coordinate of the start position
+	 *  \param[in] iT The zero based x-coordinate of the target position
+	 *  \param[in] jT The zero based y-coordinate of the target position
+	 *
+	 *	\return length of the path from starting position to target; -1 if no path exist
+	 */
+	int BlockAStar::FindPath(const int &iS, const int &jS, const int &iT, const int &jT)
+	{
+		const unsigned int start_id = map_.get_id(iS,jS);
+		const unsigned int target_id = map_.get_id(iT,jT);
+		if ( (map_.data_[start_id] != o_graph::Map::terrain_traversable_)
+				|| (map_.data_[target_id] != o_graph::Map::terrain_traversable_)
+				|| !map_.is_reachable(start_id, target_id) )
+			return -1;
+		if (start_id == target_id)
+			return 0;
+
+		const unsigned int n_blocks = n_blocks_x_*n_blocks_y_;
+		if (workspace_.g_.size() < (n_blocks << 4))
+		{
+			workspace_.g_.resize(n_blocks << 4);
+			workspace_.parents_.resize(n_blocks << 4);
+			workspace_.patterns_.resize(n_blocks);
+			workspace_.ingress_.resize(n_blocks);
+		}
+		workspace_.reached_.resize(n_blocks << 4);
+		workspace_.known_.resize(n_blocks);
+		workspace_.reached_.next_generation();
+		workspace_.known_.next_generation();
+		workspace_.open_list_.resize_ids(n_blocks);
+		workspace_.open_list_.clear();
+
+		target_x_ = iT;
+		target_y_ = jT;
+		const unsigned int start_cell = get_block_index(start_id);
+		const unsigned int target_cell = get_block_index(target_id);
+		RelaxCell(start_cell, 0, abs(iS - iT) + abs(jS - jT), start_cell);
+
+		int path_length = INT_MAX;
+		o_data_structures::IndexedBinaryHeap<unsigned long long, unsigned int> &open_list = workspace_.open_list_;
+		while (!open_list.is_empty() && (get_f(open_list.A_[0].key_) < path_length))
+		{
+			ExpandBlock(open_list.pop(0));
+			++nodes_expanded_;
+			if (workspace_.reached_.is_set(target_cell) && (workspace_.g_[target_cell] < path_length))
+				path_length = workspace_.g_[target_cell];
+		}
+		open_list.clear();
+		if (path_length == INT_MAX)
+			return -1;
+
+		BacktrackPath(start_cell, target_cell, path_length);
+		return path_length;
+	}
+
+
+	/** \brief Writes the path found into the output buffer
+	 *
+	 *  \details Predecessors in other blocks are neighbours; the grid points between a grid
+	 *  point and a predecessor in the same block are found by descending the LDDB distances.
+	 *  Grid points beyond the buffer size are skipped.
+	 *
+	 *  \param[in] start_cell block index of the start
+	 *  \param[in] target_cell block index of the target
+	 *  \param[in] path_length length of the path
+	 */
+	void BlockAStar::BacktrackPath(const unsigned int &start_cell, const unsigned int &target_cell,
+			const int &path_length) const
+	{
+		int n = path_length;
+		unsigned int cell = target_cell;
+		while (cell != start_cell)
+		{
+			const unsigned int parent = workspace_.parents_[cell];
+			if ((parent >> 4) == (cell >> 4))
+			{
+				const unsigned int base = cell & ~15u;
+				const unsigned int pattern = workspace_.patterns_[cell >> 4];
+				const unsigned char *row = database_.get_table(pattern) + ((parent & 15) << 4);
+				for (unsigned int local=cell & 15; local!=(parent & 15); )
+				{
+					if (--n < output_buffer_size_)
+						p_output_buffer_[n] = get_id(base + local);
+					unsigned int neighbours[4];
+					unsigned int n_neighbours = 0;
+					if ((local & 3) < 3)  neighbours[n_neighbours++] = local+1;
+					if ((local & 3) > 0)  neighbours[n_neighbours++] = local-1;
+					if (local < 12)       neighbours[n_neighbours++] = local+4;
+					if (local >= 4)       neighbours[n_neighbours++] = local-4;
+					for (unsigned int i=0; i<n_neighbours; ++i)
+						if (((pattern >> neighbours[i]) & 1u) && (row[neighbours[i]] + 1 == row[local]))
+						{
+							local = neighbours[i];
+							break;
+						}
+				}
+			}
+			else if (--n < output_buffer_size_)
+				p_output_buffer_[n] = get_id(cell);
+			cell = parent;
+		}
+		return;
+	}
+
+} // END OF NAMESPACE blockastar
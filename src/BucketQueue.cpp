@@ -0,0 +1,13 @@
+/** \file
+ * 		BucketQueue.cpp
+ *
+ *  \brief
+ *  	Provides a bucket based priority queue for monotone integer keys (class BucketQueue)
+ *
+ *	\details
+ *		Accompanying .cpp file to BucketQueue.hpp;
+ *		This file is a stub since BucketQueue is
+ *		a template class.
+ */
+
+#include "BucketQueue.hpp"
@@ -0,0 +1,137 @@
+/** \file
+ * 		ComponentLabels.cpp
+ *
+ *  \brief
+ *  	Connected components of a game map (class ComponentLabels)
+ *
+ *	\details
+ *		Contains definitions to accompanying header ComponentLabels.hpp
+ *		and the registry of labels for maps passed by their data pointer.
+ */
+
+#include "ComponentLabels.hpp"
+#include "Registry.hpp"  // registered labels
+
+namespace o_graph
+{
+
+	const int ComponentLabels::blocked_;
+
+
+	/** \brief finds the root of an element (with path halving)
+	 *  \param[in,out] parent Forest of the union find
+	 *  \param[in] id The element
+	 *  \return root of the tree containing id
+	 */
+	inline int FindRoot(std::vector<int> &parent, int id)
+	{
+		while (parent[id] != id)
+		{
+			parent[id] = parent[parent[id]];
+			id = parent[id];
+		}
+		return id;
+	}
+
+
+	/** \brief unites the trees of two elements (smaller root index becomes root)
+	 *  \param[in,out] parent Forest of the union find
+	 *  \param[in] id_a first element
+	 *  \param[in] id_b second element
+	 */
+	inline void Unite(std::vector<int> &parent, const int &id_a, const int &id_b)
+	{
+		int root_a = FindRoot(parent, id_a);
+		int root_b = FindRoot(parent, id_b);
+		if (root_a < root_b)
+			parent[root_b] = root_a;
+		else if (root_b < root_a)
+			parent[root_a] = root_b;
+		return;
+	}
+
+
+	/** \brief Constructor (labels the map)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 */
+	ComponentLabels::ComponentLabels(const int &width, const int &height, const unsigned char *data) :
+			width_(width), height_(height), n_components_(0), labels_(width*height, blocked_)
+	{
+		// first pass: labels_ serves as union find forest
+		for (int y=0; y<height_; ++y)
+			for (int x=0; x<width_; ++x)
+			{
+				int id = x + y*width_;
+				if (data[id] != 1)
+					continue;
+				labels_[id] = id;
+				if ((x > 0) && (data[id-1] == 1))
+					Unite(labels_, id, id-1);
+				if ((y > 0) && (data[id-width_] == 1))
+					Unite(labels_, id, id-width_);
+			}
+
+		// second pass: every parent has a smaller index than its child (roots are
+		// the smallest index of their tree), so the parent of id is labelled already
+		for (int id=0; id<width_*height_; ++id)
+		{
+			if (labels_[id] == blocked_)
+				continue;
+			if (labels_[id] == id)
+				labels_[id] = -2 - n_components_++;  // negative marks final labels
+			else
+				labels_[id] = labels_[labels_[id]];
+		}
+		for (int id=0; id<width_*height_; ++id)
+			if (labels_[id] != blocked_)
+				labels_[id] = -2 - labels_[id];
+	}
+
+
+
+	static o_data_structures::Registry<ComponentLabels> registry;  //< labels of all registered maps
+
+
+	/** \brief Labels a map and registers the labels for pathfinders
+	 *
+	 *  \details Pathfinders look up the labels by the data pointer of the map
+	 *  (see FindComponents(..)). Registering a map again replaces its labels.
+	 *
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return the labels
+	 *
+	 *  \note Labels must be registered again if the map data changes.
+	 */
+	std::shared_ptr<const ComponentLabels> RegisterComponents(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Register(data, std::make_shared<const ComponentLabels>(width, height, data));
+	}
+
+
+	/** \brief Removes the labels of a map from the registry
+	 *  \param[in] data grid data of the map
+	 *  \note Pathfinders that use them keep them alive until they are done.
+	 */
+	void UnregisterComponents(const unsigned char *data)
+	{
+		registry.Unregister(data);
+		return;
+	}
+
+
+	/** \brief Looks up the registered labels of a map
+	 *  \param[in] data grid data of the map
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return labels of the map; empty if no labels of a map with this data and extent are registered
+	 */
+	std::shared_ptr<const ComponentLabels> FindComponents(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Find(data, width, height);
+	}
+
+} // END OF NAMESPACE o_graph
@@ -0,0 +1,630 @@
+/** \file
+ * 		ContractionHierarchy.cpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (contraction hierarchies)
+ *
+ *	\details
+ *		Contains definitions to accompanying header ContractionHierarchy.hpp,
+ *		the builder of the hierarchy (class HierarchyBuilder), the query and
+ *		the registry of hierarchies for maps passed by their data pointer.
+ *
+ *		Query: Dijkstra searches from start and target alternately settle nodes
+ *		along upward edges. Every node settled by one direction and reached by the
+ *		other is a meeting point. A direction stops when its smallest key is not
+ *		smaller than the best path found. Nodes that can be reached shorter by a
+ *		downward edge from a reached node aren't expanded (stall on demand).
+ */
+
+#include <algorithm>   // std::max, std::min
+#include <climits>     // INT_MAX
+#include "ContractionHierarchy.hpp"
+#include "Registry.hpp"             // registered hierarchies
+#include "AStar.hpp"                // fallback without registered hierarchy
+#include "GenerationStamps.hpp"     // reached nodes of witness searches and queries
+#include "IndexedBinaryHeap.hpp"    // node order, witness searches and queries
+
+namespace ch
+{
+
+	const int ContractionHierarchy::no_node_;
+	const int ContractionHierarchy::no_middle_;
+	const int ContractionHierarchy::max_witness_settled_;
+
+	static const int infinity = INT_MAX;  //< distance of unreached nodes
+
+
+	/** \brief Contracts the nodes of a map and records their order and all edges
+	 *
+	 *  \details Nodes are numbered in order of the grid points here; class
+	 *  ContractionHierarchy renumbers them by rank afterwards.
+	 */
+	class HierarchyBuilder
+	{
+	public :
+		//! \brief edge during construction (stored at both ends)
+		struct Arc
+		{
+			unsigned int head_;  //< other end of the edge
+			int weight_;         //< length
+			int middle_;         //< bypassed node (no_middle_ for grid moves)
+		};
+
+		//! \brief shortcut required by the contraction of a node
+		struct Shortcut
+		{
+			unsigned int tail_;  //< first end
+			unsigned int head_;  //< second end
+			int weight_;         //< length of the path via the contracted node
+		};
+
+		explicit HierarchyBuilder(const unsigned int &n_nodes);
+		void AddArc(const unsigned int &tail, const unsigned int &head, const int &weight, const int &middle);
+		void Run();
+
+		std::vector< std::vector<Arc> > arcs_;  //< edges of every node (to nodes contracted later)
+		std::vector<unsigned int> rank_;        //< position of every node in the contraction order
+
+	private :
+		HierarchyBuilder();
+		HierarchyBuilder(const HierarchyBuilder &);
+		HierarchyBuilder &operator=(const HierarchyBuilder &);
+
+		int Priority(const unsigned int &node);
+		int FindShortcuts(const unsigned int &node);
+		void WitnessSearch(const unsigned int &source, const unsigned int &excluded, const int &limit);
+
+		std::vector<int> deleted_neighbours_;    //< number of contracted neighbours of every node
+		std::vector<int> level_;                 //< hierarchy level of every node
+		std::vector<Shortcut> shortcuts_;        //< result of FindShortcuts(..)
+		std::vector<int> witness_distance_;      //< tentative distances of the witness search
+		o_data_structures::GenerationStamps<unsigned int> witness_reached_;  //< nodes with valid distance
+		o_data_structures::IndexedBinaryHeap<int, unsigned int> witness_queue_;
+	};
+
+
+	/** \brief Constructor
+	 *  \param[in] n_nodes number of nodes (edges are added by AddArc(..))
+	 */
+	HierarchyBuilder::HierarchyBuilder(const unsigned int &n_nodes) :
+			arcs_(n_nodes), rank_(n_nodes),
+			deleted_neighbours_(n_nodes, 0), level_(n_nodes, 0), witness_distance_(n_nodes),
+			witness_reached_(n_nodes), witness_queue_(n_nodes)
+	{
+		// nothing to do here
+	}
+
+
+	/** \brief Adds an undirected edge or shortens an existing one
+	 *  \param[in] tail first end of the edge
+	 *  \param[in] head second end of the edge
+	 *  \param[in] weight length of the edge
+	 *  \param[in] middle bypassed node (no_middle_ for grid moves)
+	 */
+	void HierarchyBuilder::AddArc(const unsigned int &tail, const unsigned int &head, const int &weight, const int &middle)
+	{
+		for (std::size_t a=0; a<arcs_[tail].size(); ++a)
+			if (arcs_[tail][a].head_ == head)
+			{
+				if (weight >= arcs_[tail][a].weight_)
+					return;
+				arcs_[tail][a].weight_ = weight;
+				arcs_[tail][a].middle_ = middle;
+				for (std::size_t b=0; b<arcs_[head].size(); ++b)
+					if (arcs_[head][b].head_ == tail)
+					{
+						arcs_[head][b].weight_ = weight;
+						arcs_[head][b].middle_ = middle;
+					}
+				return;
+			}
+
+		Arc arc = {head, weight, middle};
+		arcs_[tail].push_back(arc);
+		arc.head_ = tail;
+		arcs_[head].push_back(arc);
+		return;
+	}
+
+
+	/** \brief Dijkstra search in the remaining graph (limited to max_witness_settled_ nodes)
+	 *  \param[in] source The node to start from
+	 *  \param[in] excluded The node to be contracted (not used by witnesses)
+	 *  \param[in] limit The search stops at nodes with larger distance
+	 */
+	void HierarchyBuilder::WitnessSearch(const unsigned int &source, const unsigned int &excluded, const int &limit)
+	{
+		witness_reached_.next_generation();
+		witness_queue_.clear();
+		witness_reached_.set(source);
+		witness_distance_[source] = 0;
+		witness_queue_.insert(source, 0, source);
+
+		int n_settled = 0;
+		while ( !witness_queue_.is_empty() && (witness_queue_.A_[0].key_ <= limit)
+				&& (n_settled < ContractionHierarchy::max_witness_settled_) )
+		{
+			unsigned int node = witness_queue_.pop(0);
+			++n_settled;
+			for (std::size_t a=0; a<arcs_[node].size(); ++a)
+			{
+				const Arc &arc = arcs_[node][a];
+				if (arc.head_ == excluded)
+					continue;
+				int distance = witness_distance_[node] + arc.weight_;
+				if (!witness_reached_.is_set(arc.head_))
+				{
+					witness_reached_.set(arc.head_);
+					witness_distance_[arc.head_] = distance;
+					witness_queue_.insert(arc.head_, distance, arc.head_);
+				}
+				else if ( (distance < witness_distance_[arc.head_]) && witness_queue_.contains(arc.head_) )
+				{
+					witness_distance_[arc.head_] = distance;
+					witness_queue_.change_key_by_id(arc.head_, distance);
+				}
+			}
+		}
+		return;
+	}
+
+
+	/** \brief Finds the shortcuts needed if a node was contracted now
+	 *  \param[in] node The node
+	 *  \return number of shortcuts (stored in shortcuts_)
+	 */
+	int HierarchyBuilder::FindShortcuts(const unsigned int &node)
+	{
+		shortcuts_.clear();
+		const std::vector<Arc> &arcs = arcs_[node];
+		for (std::size_t i=0; i+1<arcs.size(); ++i)
+		{
+			int limit = 0;
+			for (std::size_t j=i+1; j<arcs.size(); ++j)
+				limit = std::max(limit, arcs[i].weight_ + arcs[j].weight_);
+
+			WitnessSearch(arcs[i].head_, node, limit);
+			for (std::size_t j=i+1; j<arcs.size(); ++j)
+			{
+				int via = arcs[i].weight_ + arcs[j].weight_;
+				if ( !witness_reached_.is_set(arcs[j].head_) || (witness_distance_[arcs[j].head_] > via) )
+				{
+					Shortcut shortcut = {arcs[i].head_, arcs[j].head_, via};
+					shortcuts_.push_back(shortcut);
+				}
+			}
+		}
+		return shortcuts_.size();
+	}
+
+
+	/** \brief priority of a node in the contraction order (smaller is contracted first)
+	 *  \param[in] node The node
+	 *  \return 2*edge difference + contracted neighbours + hierarchy level
+	 */
+	int HierarchyBuilder::Priority(const unsigned int &node)
+	{
+		const int degree = arcs_[node].size();
+		return 2*(FindShortcuts(node) - degree) + deleted_neighbours_[node] + level_[node];
+	}
+
+
+	//! \brief Contracts all nodes (fills rank_ and adds all shortcuts to arcs_)
+	void HierarchyBuilder::Run()
+	{
+		o_data_structures::IndexedBinaryHeap<int, unsigned int> order(arcs_.size());
+		for (unsigned int node=0; node<arcs_.size(); ++node)
+			order.insert(node, Priority(node), node);
+
+		unsigned int rank = 0;
+		while (!order.is_empty())
+		{
+			// lazy update: contract the top node only if its priority is still minimal
+			unsigned int node = order.A_[0].data_;
+			order.change_key_by_id(node, Priority(node));
+			if (order.A_[0].data_ != node)
+				continue;
+			order.pop(0);
+
+			// shortcuts_ is still the result for node (computed by Priority(node))
+			std::vector<Shortcut> shortcuts(shortcuts_);
+			for (std::size_t s=0; s<shortcuts.size(); ++s)
+				AddArc(shortcuts[s].tail_, shortcuts[s].head_, shortcuts[s].weight_, node);
+			rank_[node] = rank++;
+
+			// the remaining edges of node lead upwards, neighbours forget their edge to node
+			const std::vector<Arc> &arcs = arcs_[node];
+			for (std::size_t a=0; a<arcs.size(); ++a)
+			{
+				unsigned int neighbour = arcs[a].head_;
+				std::vector<Arc> &neighbour_arcs = arcs_[neighbour];
+				for (std::size_t b=0; b<neighbour_arcs.size(); ++b)
+					if (neighbour_arcs[b].head_ == node)
+					{
+						neighbour_arcs[b] = neighbour_arcs.back();
+						neighbour_arcs.pop_back();
+						break;
+					}
+				++deleted_neighbours_[neighbour];
+				level_[neighbour] = std::max(level_[neighbour], level_[node]+1);
+				order.change_key_by_id(neighbour, Priority(neighbour));
+			}
+		}
+		return;
+	}
+
+
+
+
+	/** \brief Constructor (builds the hierarchy)
+	 *  \param[in] map The game map
+	 */
+	ContractionHierarchy::ContractionHierarchy(const o_graph::Map &map) :
+			width_(map.width_), height_(map.height_), n_nodes_(0), n_shortcuts_(0),
+			node_of_cell_(map.width_*map.height_, no_node_)
+	{
+		// nodes in grid order and grid moves
+		std::vector<unsigned int> cells;
+		for (int id=0; id<width_*height_; ++id)
+			if (map.data_[id] == o_graph::Map::terrain_traversable_)
+			{
+				node_of_cell_[id] = cells.size();
+				cells.push_back(id);
+			}
+		n_nodes_ = cells.size();
+
+		HierarchyBuilder builder(n_nodes_);
+		for (unsigned int node=0; node<n_nodes_; ++node)
+		{
+			int x = cells[node]%width_;
+			int y = cells[node]/width_;
+			if ( (x+1 < width_) && (node_of_cell_[cells[node]+1] != no_node_) )
+				builder.AddArc(node, node_of_cell_[cells[node]+1], 1, no_middle_);
+			if ( (y+1 < height_) && (node_of_cell_[cells[node]+width_] != no_node_) )
+				builder.AddArc(node, node_of_cell_[cells[node]+width_], 1, no_middle_);
+		}
+		builder.Run();
+
+		// renumber by rank and keep upward edges only
+		const std::vector<unsigned int> &rank = builder.rank_;
+		cell_of_node_.resize(n_nodes_);
+		first_edge_.assign(n_nodes_+1, 0);
+		for (unsigned int node=0; node<n_nodes_; ++node)
+		{
+			cell_of_node_[rank[node]] = cells[node];
+			node_of_cell_[cells[node]] = rank[node];
+			for (std::size_t a=0; a<builder.arcs_[node].size(); ++a)
+				if (rank[builder.arcs_[node][a].head_] > rank[node])
+					++first_edge_[rank[node]+1];
+		}
+		for (unsigned int node=0; node<n_nodes_; ++node)
+			first_edge_[node+1] += first_edge_[node];
+
+		edge_head_.resize(first_edge_[n_nodes_]);
+		edge_weight_.resize(first_edge_[n_nodes_]);
+		edge_middle_.resize(first_edge_[n_nodes_]);
+		std::vector<unsigned int> next_edge(first_edge_.begin(), first_edge_.end()-1);
+		for (unsigned int node=0; node<n_nodes_; ++node)
+			for (std::size_t a=0; a<builder.arcs_[node].size(); ++a)
+			{
+				const HierarchyBuilder::Arc &arc = builder.arcs_[node][a];
+				if (rank[arc.head_] < rank[node])
+					continue;
+				unsigned int e = next_edge[rank[node]]++;
+				edge_head_[e] = rank[arc.head_];
+				edge_weight_[e] = arc.weight_;
+				edge_middle_[e] = (arc.middle_ == no_middle_) ? no_middle_ : (int) rank[arc.middle_];
+				if (arc.middle_ != no_middle_)
+					++n_shortcuts_;
+			}
+
+		// children of shortcuts (edges exist since the middle was contracted before both ends)
+		edge_children_.assign(2*edge_head_.size(), 0);
+		for (unsigned int node=0; node<n_nodes_; ++node)
+			for (unsigned int e=first_edge_[node]; e<first_edge_[node+1]; ++e)
+				if (edge_middle_[e] != no_middle_)
+				{
+					edge_children_[2*e] = FindEdge(node, edge_middle_[e]);
+					edge_children_[2*e+1] = FindEdge(edge_middle_[e], edge_head_[e]);
+				}
+	}
+
+
+	/** \brief Finds the edge between two nodes
+	 *  \param[in] a first node
+	 *  \param[in] b second node
+	 *  \return index of the edge; -1 if there is none
+	 */
+	int ContractionHierarchy::FindEdge(const unsigned int &a, const unsigned int &b) const
+	{
+		const unsigned int lower = std::min(a, b);
+		const unsigned int upper = std::max(a, b);
+		for (unsigned int e=first_edge_[lower]; e<first_edge_[lower+1]; ++e)
+			if (edge_head_[e] == upper)
+				return e;
+		return -1;
+	}
+
+
+	/** \brief Writes the grid points of an edge (shortcuts unpacked recursively)
+	 *
+	 *  \param[in] a node to start from
+	 *  \param[in] b node to go to (an edge between a and b must exist)
+	 *  \param[out] pOutBuffer grid points from a to b (excluding a) are written here
+	 *  \return number of grid points written (length of the edge)
+	 */
+	int ContractionHierarchy::UnpackEdge(const unsigned int &a, const unsigned int &b, int *pOutBuffer) const
+	{
+		//! \brief edge still to be unpacked
+		struct PendingEdge
+		{
+			unsigned int from_;  //< end the path enters the edge
+			unsigned int to_;    //< end the path leaves the edge
+			unsigned int edge_;  //< index of the edge
+		};
+		static thread_local std::vector<PendingEdge> stack;
+
+		int n = 0;
+		stack.clear();
+		PendingEdge pending = {a, b, (unsigned int) FindEdge(a, b)};
+		stack.push_back(pending);
+		while (!stack.empty())
+		{
+			pending = stack.back();
+			stack.pop_back();
+			const int middle = edge_middle_[pending.edge_];
+			if (middle == no_middle_)
+			{
+				pOutBuffer[n++] = cell_of_node_[pending.to_];
+				continue;
+			}
+
+			// children: (lower end, middle) and (middle, upper end)
+			const bool upward = (pending.from_ < pending.to_);
+			PendingEdge first = {pending.from_, (unsigned int) middle, edge_children_[2*pending.edge_ + (upward ? 0 : 1)]};
+			PendingEdge second = {(unsigned int) middle, pending.to_, edge_children_[2*pending.edge_ + (upward ? 1 : 0)]};
+			stack.push_back(second);
+			stack.push_back(first);
+		}
+		return n;
+	}
+
+
+	/** \brief memory used by the hierarchy
+	 *  \return size of all arrays in bytes
+	 */
+	std::size_t ContractionHierarchy::get_memory_footprint() const
+	{
+		return sizeof(ContractionHierarchy)
+				+ node_of_cell_.capacity()*sizeof(int)
+				+ cell_of_node_.capacity()*sizeof(unsigned int)
+				+ first_edge_.capacity()*sizeof(unsigned int)
+				+ edge_head_.capacity()*sizeof(unsigned int)
+				+ edge_weight_.capacity()*sizeof(int)
+				+ edge_middle_.capacity()*sizeof(int)
+				+ edge_children_.capacity()*sizeof(unsigned int);
+	}
+
+
+
+
+	//! \brief one direction of a query
+	struct QuerySide
+	{
+		std::vector<int> distance_;        //< tentative distances
+		std::vector<int> predecessor_;     //< predecessor of every reached node (-1 at the origin)
+		o_data_structures::GenerationStamps<unsigned int> reached_;  //< nodes with valid distance
+		o_data_structures::IndexedBinaryHeap<int, unsigned int> queue_;
+
+		/** \brief starts a search
+		 *  \param[in] n_nodes number of nodes of the hierarchy
+		 *  \param[in] origin node to start from
+		 */
+		void Init(const unsigned int &n_nodes, const unsigned int &origin)
+		{
+			if (distance_.size() < n_nodes)
+			{
+				distance_.resize(n_nodes);
+				predecessor_.resize(n_nodes);
+				reached_.resize(n_nodes);
+				queue_.resize_ids(n_nodes);
+			}
+			reached_.next_generation();
+			queue_.clear();
+			reached_.set(origin);
+			distance_[origin] = 0;
+			predecessor_[origin] = -1;
+			queue_.insert(origin, 0, origin);
+			return;
+		}
+	};
+
+
+	/** \brief Settles the next node of a direction
+	 *
+	 *  \param[in] hierarchy The contraction hierarchy
+	 *  \param[in,out] side The direction
+	 *  \param[in] other The opposite direction
+	 *  \param[in,out] best_length length of the shortest path found so far
+	 *  \param[in,out] meeting meeting point of that path
+	 */
+	void SettleNode(const ContractionHierarchy &hierarchy, QuerySide &side, const QuerySide &other,
+			int &best_length, int &meeting)
+	{
+		const unsigned int node = side.queue_.pop(0);
+		const int distance = side.distance_[node];
+		if ( other.reached_.is_set(node) && (distance + other.distance_[node] < best_length) )
+		{
+			best_length = distance + other.distance_[node];
+			meeting = node;
+		}
+
+		// stall on demand
+		for (unsigned int e=hierarchy.first_edge_[node]; e<hierarchy.first_edge_[node+1]; ++e)
+		{
+			unsigned int head = hierarchy.edge_head_[e];
+			if ( side.reached_.is_set(head) && (side.distance_[head] + hierarchy.edge_weight_[e] < distance) )
+				return;
+		}
+
+		for (unsigned int e=hierarchy.first_edge_[node]; e<hierarchy.first_edge_[node+1]; ++e)
+		{
+			unsigned int head = hierarchy.edge_head_[e];
+			int head_distance = distance + hierarchy.edge_weight_[e];
+			if (!side.reached_.is_set(head))
+			{
+				side.reached_.set(head);
+				side.distance_[head] = head_distance;
+				side.predecessor_[head] = node;
+				side.queue_.insert(head, head_distance, head);
+			}
+			else if ( (head_distance < side.distance_[head]) && side.queue_.contains(head) )
+			{
+				side.distance_[head] = head_distance;
+				side.predecessor_[head] = node;
+				side.queue_.change_key_by_id(head, head_distance);
+			}
+		}
+		return;
+	}
+
+
+	/** \brief Shortest path between two nodes (see file documentation)
+	 *
+	 *  \param[in] hierarchy The contraction hierarchy
+	 *  \param[in] start The node to start from
+	 *  \param[in] target The node to go to
+	 *  \param[out] pOutBuffer Buffer for the grid points of the path
+	 *  \param[in] nOutBufferSize length of pOutBuffer (the path is only written if it fits)
+	 *  \param[out] nodes_expanded number of settled nodes
+	 *  \return length of the path; -1 if no path exists
+	 */
+	int Query(const ContractionHierarchy &hierarchy, const unsigned int &start, const unsigned int &target,
+			int* pOutBuffer, const int &nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		static thread_local QuerySide sides[2];
+		static thread_local std::vector<unsigned int> chain;
+
+		QuerySide &forward = sides[0];
+		QuerySide &backward = sides[1];
+		forward.Init(hierarchy.n_nodes_, start);
+		backward.Init(hierarchy.n_nodes_, target);
+
+		int best_length = infinity;
+		int meeting = -1;
+		nodes_expanded = 0;
+		int direction = 0;
+		while (true)
+		{
+			bool forward_active = !forward.queue_.is_empty() && (forward.queue_.A_[0].key_ < best_length);
+			bool backward_active = !backward.queue_.is_empty() && (backward.queue_.A_[0].key_ < best_length);
+			if (!forward_active && !backward_active)
+				break;
+			if (!backward_active)
+				direction = 0;
+			else if (!forward_active)
+				direction = 1;
+			SettleNode(hierarchy, sides[direction], sides[1-direction], best_length, meeting);
+			++nodes_expanded;
+			direction = 1 - direction;
+		}
+
+		if (meeting < 0)
+			return -1;
+		if (best_length > nOutBufferSize)
+			return best_length;
+
+		// start .. meeting (predecessors of the forward search reversed)
+		chain.clear();
+		for (int node=meeting; node>=0; node=forward.predecessor_[node])
+			chain.push_back(node);
+		int n = 0;
+		for (std::size_t i=chain.size()-1; i>0; --i)
+			n += hierarchy.UnpackEdge(chain[i], chain[i-1], pOutBuffer+n);
+
+		// meeting .. target
+		for (int node=meeting; backward.predecessor_[node]>=0; node=backward.predecessor_[node])
+			n += hierarchy.UnpackEdge(node, backward.predecessor_[node], pOutBuffer+n);
+		return best_length;
+	}
+
+
+
+
+	static o_data_structures::Registry<ContractionHierarchy> registry;  //< hierarchies of all registered maps
+
+
+	/** \brief Builds the contraction hierarchy of a map and registers it for ch::FindPath(..)
+	 *
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return the hierarchy
+	 *
+	 *  \note The hierarchy must be registered again if the map data changes.
+	 */
+	std::shared_ptr<const ContractionHierarchy> RegisterContractionHierarchy(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Register(data, std::make_shared<const ContractionHierarchy>(o_graph::Map(width, height, data)));
+	}
+
+
+	/** \brief Removes the contraction hierarchy of a map from the registry
+	 *  \param[in] data grid data of the map
+	 *  \note Pathfinders that use it keep it alive until they are done.
+	 */
+	void UnregisterContractionHierarchy(const unsigned char *data)
+	{
+		registry.Unregister(data);
+		return;
+	}
+
+
+	/** \brief Looks up the registered contraction hierarchy of a map
+	 *  \param[in] data grid data of the map
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return hierarchy of the map; empty if none is registered for this data and extent
+	 */
+	std::shared_ptr<const ContractionHierarchy> FindContractionHierarchy(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Find(data, width, height);
+	}
+
+
+
+
+	//! \brief Interface to use the contraction hierarchy (see ContractionHierarchy.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize)
+	{
+		unsigned int nodes_expanded;
+		return FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+				pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+
+	//! \brief Interface with diagnostics (see ContractionHierarchy.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		const std::shared_ptr<const ContractionHierarchy> p_hierarchy = FindContractionHierarchy(pMap, nMapWidth, nMapHeight);
+		if (!p_hierarchy)
+			return astar::FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+					pOutBuffer, nOutBufferSize, nodes_expanded);
+
+		nodes_expanded = 0;
+		int start = p_hierarchy->get_node(nStartX + nStartY*nMapWidth);
+		int target = p_hierarchy->get_node(nTargetX + nTargetY*nMapWidth);
+		if ( (start == ContractionHierarchy::no_node_) || (target == ContractionHierarchy::no_node_) )
+			return -1;
+		if (start == target)
+			return 0;
+		return Query(*p_hierarchy, start, target, pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+} // END OF NAMESPACE ch
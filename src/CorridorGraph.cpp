@@ -0,0 +1,538 @@
+/** \file
+ * 		CorridorGraph.cpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (search on a corridor contracted map)
+ *
+ *	\details
+ *		Contains definitions to accompanying header CorridorGraph.hpp
+ *		and the registry of corridor graphs for maps passed by their data pointer.
+ *
+ *		The search runs on the nodes of the graph plus two virtual nodes for a
+ *		start and a target inside a corridor (n_nodes_ and n_nodes_+1). The virtual start
+ *		has arcs to both ends of its corridor (and to the virtual target if both lie in
+ *		the same corridor), the ends of the targets corridor get an arc to the virtual target.
+ */
+
+#include <algorithm>  // std::reverse
+#include <cstdlib>    // std::abs
+#include "CorridorGraph.hpp"
+#include "Registry.hpp"           // registered graphs
+#include "AStar.hpp"              // fallback without registered graph
+#include "ComponentLabels.hpp"    // O(1) rejection of unreachable targets
+#include "GenerationStamps.hpp"   // seen and closed nodes of the search
+#include "IndexedBinaryHeap.hpp"  // open list of the search
+
+namespace corridor
+{
+
+	const int CorridorGraph::no_node_;
+	const int CorridorGraph::no_corridor_;
+
+
+	/** \brief Constructor (contracts the corridors of a map)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] data grid data of the map (see Map.hpp; must outlive the graph)
+	 */
+	CorridorGraph::CorridorGraph(const int &width, const int &height, const unsigned char *data) :
+			width_(width), height_(height), data_(data), n_nodes_(0),
+			node_of_cell_(width*height, no_node_), corridor_of_cell_(width*height, no_corridor_),
+			position_(width*height, 0)
+	{
+		// nodes: traversable grid points with degree != 2
+		for (int id=0; id<width_*height_; ++id)
+		{
+			if (!is_traversable(id))
+				continue;
+			const int x = id % width_;
+			const int y = id / width_;
+			int degree = ((x > 0) && is_traversable(id-1)) + ((x+1 < width_) && is_traversable(id+1))
+					+ ((y > 0) && is_traversable(id-width_)) + ((y+1 < height_) && is_traversable(id+width_));
+			if (degree != 2)
+			{
+				node_of_cell_[id] = n_nodes_++;
+				cell_of_node_.push_back(id);
+			}
+		}
+
+		// corridors starting at the nodes, then cycles without node (one of their grid points becomes a node)
+		for (unsigned int v=0; v<n_nodes_; ++v)
+			AddCorridors(cell_of_node_[v]);
+		for (int id=0; id<width_*height_; ++id)
+			if ( is_traversable(id) && (node_of_cell_[id] == no_node_) && (corridor_of_cell_[id] == no_corridor_) )
+			{
+				node_of_cell_[id] = n_nodes_++;
+				cell_of_node_.push_back(id);
+				AddCorridors(id);
+			}
+
+		// arcs in both directions (compressed row format)
+		first_arc_.assign(n_nodes_+1, 0);
+		for (std::size_t c=0; c<corridor_tail_.size(); ++c)
+			if (corridor_tail_[c] != corridor_head_[c])
+			{
+				++first_arc_[corridor_tail_[c]+1];
+				++first_arc_[corridor_head_[c]+1];
+			}
+		for (unsigned int v=0; v<n_nodes_; ++v)
+			first_arc_[v+1] += first_arc_[v];
+		arc_head_.resize(first_arc_[n_nodes_]);
+		arc_weight_.resize(first_arc_[n_nodes_]);
+		arc_corridor_.resize(first_arc_[n_nodes_]);
+		std::vector<unsigned int> next_arc(first_arc_.begin(), first_arc_.end()-1);
+		for (std::size_t c=0; c<corridor_tail_.size(); ++c)
+		{
+			if (corridor_tail_[c] == corridor_head_[c])
+				continue;
+			unsigned int a = next_arc[corridor_tail_[c]]++;
+			arc_head_[a] = corridor_head_[c];
+			arc_weight_[a] = corridor_length_[c];
+			arc_corridor_[a] = 2*c;
+			a = next_arc[corridor_head_[c]]++;
+			arc_head_[a] = corridor_tail_[c];
+			arc_weight_[a] = corridor_length_[c];
+			arc_corridor_[a] = 2*c + 1;
+		}
+	}
+
+
+	/** \brief checks if a grid point is traversable
+	 *  \param[in] id The grid point
+	 *  \return true if traversable
+	 */
+	bool CorridorGraph::is_traversable(const int &id) const
+	{
+		return data_[id] == 1;
+	}
+
+
+	/** \brief next grid point of a corridor
+	 *  \param[in] id inner grid point of a corridor
+	 *  \param[in] previous the neighbour of id the walk comes from
+	 *  \return the other traversable neighbour of id
+	 */
+	unsigned int CorridorGraph::OtherNeighbour(const unsigned int &id, const unsigned int &previous) const
+	{
+		const int x = id % width_;
+		const int y = id / width_;
+		if ( (x > 0) && (id-1 != previous) && is_traversable(id-1) )
+			return id-1;
+		if ( (x+1 < width_) && (id+1 != previous) && is_traversable(id+1) )
+			return id+1;
+		if ( (y > 0) && (id-width_ != previous) && is_traversable(id-width_) )
+			return id-width_;
+		return id+width_;
+	}
+
+
+	/** \brief neighbour of an inner grid point towards one end of its corridor
+	 *  \param[in] id inner grid point of a corridor
+	 *  \param[in] to_tail true: towards the tail; false: towards the head
+	 *  \return the neighbour
+	 */
+	unsigned int CorridorGraph::NeighbourTowards(const unsigned int &id, const bool &to_tail) const
+	{
+		const int c = corridor_of_cell_[id];
+		if (to_tail && (position_[id] == 1))
+			return cell_of_node_[corridor_tail_[c]];
+		if (!to_tail && (position_[id] == corridor_length_[c]-1))
+			return cell_of_node_[corridor_head_[c]];
+
+		const int position = to_tail ? position_[id]-1 : position_[id]+1;
+		const unsigned int neighbours[4] = {id-1, id+1, id-width_, id+width_};
+		const bool inside[4] = {id%width_ > 0, (int) (id%width_)+1 < width_, id >= (unsigned int) width_,
+				(int) (id/width_)+1 < height_};
+		for (int k=0; k<4; ++k)
+			if ( inside[k] && (corridor_of_cell_[neighbours[k]] == c) && (position_[neighbours[k]] == position) )
+				return neighbours[k];
+		return id;  // not reached
+	}
+
+
+	/** \brief follows all corridors starting at a node
+	 *  \param[in] id grid point of the node
+	 */
+	void CorridorGraph::AddCorridors(const unsigned int &id)
+	{
+		const int x = id % width_;
+		const int y = id / width_;
+		if ( (x > 0) && is_traversable(id-1) )
+			AddCorridor(id, id-1);
+		if ( (x+1 < width_) && is_traversable(id+1) )
+			AddCorridor(id, id+1);
+		if ( (y > 0) && is_traversable(id-width_) )
+			AddCorridor(id, id-width_);
+		if ( (y+1 < height_) && is_traversable(id+width_) )
+			AddCorridor(id, id+width_);
+		return;
+	}
+
+
+	/** \brief follows a corridor from a node and stores it
+	 *  \param[in] tail grid point of the node
+	 *  \param[in] first traversable neighbour of tail
+	 *  \note Corridors already known (from their other end) are skipped.
+	 */
+	void CorridorGraph::AddCorridor(const unsigned int &tail, const unsigned int &first)
+	{
+		if (corridor_of_cell_[first] != no_corridor_)
+			return;
+		if ( (node_of_cell_[first] != no_node_) && (first < tail) )
+			return;
+
+		const int c = corridor_tail_.size();
+		unsigned int previous = tail;
+		unsigned int current = first;
+		int length = 1;
+		while (node_of_cell_[current] == no_node_)
+		{
+			corridor_of_cell_[current] = c;
+			position_[current] = length;
+			unsigned int next = OtherNeighbour(current, previous);
+			previous = current;
+			current = next;
+			++length;
+		}
+		corridor_tail_.push_back(node_of_cell_[tail]);
+		corridor_head_.push_back(node_of_cell_[current]);
+		corridor_length_.push_back(length);
+		corridor_first_.push_back(first);
+		corridor_last_.push_back(previous);
+		return;
+	}
+
+
+	/** \brief writes the grid points of a walk along a corridor
+	 *  \param[in] previous grid point the walk comes from
+	 *  \param[in] current first grid point of the walk
+	 *  \param[in] stop last grid point of the walk
+	 *  \param[out] pOutBuffer buffer for the path (owned by caller)
+	 *  \param[in] nOutBufferSize length of pOutBuffer
+	 *  \param[in] n number of grid points of the path before the walk
+	 *  \return number of grid points of the path after the walk
+	 */
+	int CorridorGraph::Walk(unsigned int previous, unsigned int current, const unsigned int &stop,
+			int *pOutBuffer, const int &nOutBufferSize, int n) const
+	{
+		while (true)
+		{
+			if (n < nOutBufferSize)
+				pOutBuffer[n] = current;
+			++n;
+			if (current == stop)
+				break;
+			unsigned int next = OtherNeighbour(current, previous);
+			previous = current;
+			current = next;
+		}
+		return n;
+	}
+
+
+	/** \brief memory used by the graph
+	 *  \return size of all arrays in bytes
+	 */
+	std::size_t CorridorGraph::get_memory_footprint() const
+	{
+		return sizeof(CorridorGraph)
+				+ (node_of_cell_.capacity() + corridor_of_cell_.capacity() + position_.capacity())*sizeof(int)
+				+ cell_of_node_.capacity()*sizeof(unsigned int)
+				+ (corridor_tail_.capacity() + corridor_head_.capacity() + corridor_first_.capacity()
+						+ corridor_last_.capacity())*sizeof(unsigned int)
+				+ corridor_length_.capacity()*sizeof(int)
+				+ (first_arc_.capacity() + arc_head_.capacity() + arc_corridor_.capacity())*sizeof(unsigned int)
+				+ arc_weight_.capacity()*sizeof(int);
+	}
+
+
+
+
+	//! \brief memory of the search kept between queries (one per thread)
+	struct SearchWorkspace
+	{
+		std::vector<int> g_;             //< path cost of nodes
+		std::vector<int> predecessors_;  //< predecessor of nodes
+		std::vector<int> arcs_;          //< arc to nodes from their predecessor (negative: virtual arc)
+		o_data_structures::GenerationStamps<unsigned int> seen_;    //< nodes with valid g_
+		o_data_structures::GenerationStamps<unsigned int> closed_;  //< expanded nodes
+		o_data_structures::IndexedBinaryHeap<int, unsigned int> open_list_;  //< keyed by f
+	};
+
+	//! \brief virtual arcs (see file documentation)
+	enum VirtualArc
+	{
+		arc_start_to_tail = -1,   //< virtual start to the tail of its corridor
+		arc_start_to_head = -2,   //< virtual start to the head of its corridor
+		arc_start_to_target = -3, //< virtual start to virtual target (same corridor)
+		arc_tail_to_target = -4,  //< tail of the targets corridor to virtual target
+		arc_head_to_target = -5   //< head of the targets corridor to virtual target
+	};
+
+
+	/** \brief Updates a node reached by the search
+	 *
+	 *  \param[in,out] workspace memory of the search
+	 *  \param[in] node The reached node
+	 *  \param[in] h heuristic of node (manhattan distance to the target)
+	 *  \param[in] g path cost of node via predecessor
+	 *  \param[in] predecessor The expanded node
+	 *  \param[in] arc arc from predecessor to node
+	 */
+	void RelaxNode(SearchWorkspace &workspace, const unsigned int &node, const int &h,
+			const int &g, const int &predecessor, const int &arc)
+	{
+		if (workspace.closed_.is_set(node))
+			return;
+		if (!workspace.seen_.is_set(node))
+		{
+			workspace.seen_.set(node);
+			workspace.g_[node] = g;
+			workspace.predecessors_[node] = predecessor;
+			workspace.arcs_[node] = arc;
+			workspace.open_list_.insert(node, g+h, node);
+		}
+		else if (g < workspace.g_[node])
+		{
+			workspace.g_[node] = g;
+			workspace.predecessors_[node] = predecessor;
+			workspace.arcs_[node] = arc;
+			workspace.open_list_.change_key_by_id(node, g+h);
+		}
+		return;
+	}
+
+
+	/** \brief A* search on the corridor graph (see file documentation)
+	 *
+	 *  \param[in] start id of the start position
+	 *  \param[in] target id of the target position
+	 *  \param[out] pOutBuffer Buffer for the ids of the path (excluding start)
+	 *  \param[in] nOutBufferSize length of pOutBuffer (only the first nOutBufferSize
+	 *  grid points of longer paths are written)
+	 *  \param[out] nodes_expanded number of expanded nodes
+	 *  \return length of the path; -1 if no path exists
+	 */
+	int CorridorGraph::FindPath(const unsigned int &start, const unsigned int &target,
+			int *pOutBuffer, const int &nOutBufferSize, unsigned int &nodes_expanded) const
+	{
+		static thread_local SearchWorkspace workspace;
+
+		nodes_expanded = 0;
+		if ( !is_traversable(start) || !is_traversable(target) )
+			return -1;
+		if (start == target)
+			return 0;
+
+		const unsigned int virtual_start = n_nodes_;
+		const unsigned int virtual_target = n_nodes_+1;
+		const unsigned int start_node = (node_of_cell_[start] != no_node_) ? node_of_cell_[start] : virtual_start;
+		const unsigned int target_node = (node_of_cell_[target] != no_node_) ? node_of_cell_[target] : virtual_target;
+		const int start_corridor = corridor_of_cell_[start];
+		const int target_corridor = corridor_of_cell_[target];
+		const int target_x = target % width_;
+		const int target_y = target / width_;
+
+		workspace.g_.resize(n_nodes_+2);
+		workspace.predecessors_.resize(n_nodes_+2);
+		workspace.arcs_.resize(n_nodes_+2);
+		workspace.seen_.resize(n_nodes_+2);
+		workspace.closed_.resize(n_nodes_+2);
+		workspace.seen_.next_generation();
+		workspace.closed_.next_generation();
+		workspace.open_list_.resize_ids(n_nodes_+2);
+		workspace.open_list_.clear();
+
+		workspace.seen_.set(start_node);
+		workspace.g_[start_node] = 0;
+		workspace.predecessors_[start_node] = -1;
+		workspace.open_list_.insert(start_node, 0, start_node);
+
+		bool found = false;
+		while (!workspace.open_list_.is_empty())
+		{
+			const unsigned int node = workspace.open_list_.pop(0);
+			if (node == target_node)
+			{
+				found = true;
+				break;
+			}
+			workspace.closed_.set(node);
+			++nodes_expanded;
+
+			const int g = workspace.g_[node];
+			if (node == virtual_start)
+			{
+				const unsigned int tail = corridor_tail_[start_corridor];
+				const unsigned int head = corridor_head_[start_corridor];
+				RelaxNode(workspace, tail, std::abs((int) (cell_of_node_[tail]%width_) - target_x)
+						+ std::abs((int) (cell_of_node_[tail]/width_) - target_y),
+						g + position_[start], node, arc_start_to_tail);
+				RelaxNode(workspace, head, std::abs((int) (cell_of_node_[head]%width_) - target_x)
+						+ std::abs((int) (cell_of_node_[head]/width_) - target_y),
+						g + corridor_length_[start_corridor] - position_[start], node, arc_start_to_head);
+				if (start_corridor == target_corridor)
+					RelaxNode(workspace, virtual_target, 0, g + std::abs(position_[start] - position_[target]),
+							node, arc_start_to_target);
+				continue;
+			}
+
+			if (target_node == virtual_target)
+			{
+				if (node == corridor_tail_[target_corridor])
+					RelaxNode(workspace, virtual_target, 0, g + position_[target], node, arc_tail_to_target);
+				if (node == corridor_head_[target_corridor])
+					RelaxNode(workspace, virtual_target, 0, g + corridor_length_[target_corridor] - position_[target],
+							node, arc_head_to_target);
+			}
+			for (unsigned int a=first_arc_[node]; a<first_arc_[node+1]; ++a)
+			{
+				const unsigned int cell = cell_of_node_[arc_head_[a]];
+				RelaxNode(workspace, arc_head_[a], std::abs((int) (cell%width_) - target_x)
+						+ std::abs((int) (cell/width_) - target_y), g + arc_weight_[a], node, a);
+			}
+		}
+		if (!found)
+			return -1;
+
+		// walk the arcs of the path along their corridors
+		static thread_local std::vector<unsigned int> path;
+		path.clear();
+		for (int node=target_node; node!=(int) start_node; node=workspace.predecessors_[node])
+			path.push_back(node);
+		std::reverse(path.begin(), path.end());
+
+		int n = 0;
+		unsigned int previous = start_node;
+		for (std::size_t i=0; i<path.size(); ++i)
+		{
+			const unsigned int node = path[i];
+			const int arc = workspace.arcs_[node];
+			const unsigned int from = (previous == virtual_start) ? start : cell_of_node_[previous];
+			const unsigned int to = (node == virtual_target) ? target : cell_of_node_[node];
+			switch (arc)
+			{
+			case arc_start_to_tail :
+				n = Walk(start, NeighbourTowards(start, true), to, pOutBuffer, nOutBufferSize, n);
+				break;
+			case arc_start_to_head :
+				n = Walk(start, NeighbourTowards(start, false), to, pOutBuffer, nOutBufferSize, n);
+				break;
+			case arc_start_to_target :
+				n = Walk(start, NeighbourTowards(start, position_[target] < position_[start]), to,
+						pOutBuffer, nOutBufferSize, n);
+				break;
+			case arc_tail_to_target :
+				n = Walk(from, corridor_first_[target_corridor], to, pOutBuffer, nOutBufferSize, n);
+				break;
+			case arc_head_to_target :
+				n = Walk(from, corridor_last_[target_corridor], to, pOutBuffer, nOutBufferSize, n);
+				break;
+			default :
+				{
+					const unsigned int c = arc_corridor_[arc]/2;
+					const unsigned int first = (arc_corridor_[arc]%2 == 0) ? corridor_first_[c] : corridor_last_[c];
+					n = Walk(from, first, to, pOutBuffer, nOutBufferSize, n);
+				}
+			}
+			previous = node;
+		}
+		return n;
+	}
+
+
+
+
+	static o_data_structures::Registry<CorridorGraph> registry;  //< graphs of all registered maps
+
+
+	/** \brief Builds the corridor graph of a map and registers it for corridor::FindPath(..)
+	 *
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return the graph; empty if the map has less than CorridorGraph::min_tiles_per_node_
+	 *  traversable grid points per node (a previously registered graph is removed then)
+	 *
+	 *  \details Without a registered graph corridor::FindPath(..) answers with AStar,
+	 *  which is faster than a graph search that expands about every grid point anyway.
+	 *
+	 *  \note The graph must be registered again if the map data changes.
+	 */
+	std::shared_ptr<const CorridorGraph> RegisterCorridorGraph(const unsigned char *data, const int &width, const int &height)
+	{
+		const std::shared_ptr<const CorridorGraph> p_graph = std::make_shared<const CorridorGraph>(width, height, data);
+
+		// nodes plus the inner grid points of all corridors
+		std::size_t n_tiles = p_graph->n_nodes_;
+		for (std::size_t c=0; c<p_graph->corridor_length_.size(); ++c)
+			n_tiles += p_graph->corridor_length_[c] - 1;
+		if (n_tiles < CorridorGraph::min_tiles_per_node_*static_cast<std::size_t>(p_graph->n_nodes_))
+		{
+			registry.Unregister(data);
+			return std::shared_ptr<const CorridorGraph>();
+		}
+		return registry.Register(data, p_graph);
+	}
+
+
+	/** \brief Removes the corridor graph of a map from the registry
+	 *  \param[in] data grid data of the map
+	 *  \note Pathfinders that use it keep it alive until they are done.
+	 */
+	void UnregisterCorridorGraph(const unsigned char *data)
+	{
+		registry.Unregister(data);
+		return;
+	}
+
+
+	/** \brief Looks up the registered corridor graph of a map
+	 *  \param[in] data grid data of the map
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return graph of the map; empty if none is registered for this data and extent
+	 */
+	std::shared_ptr<const CorridorGraph> FindCorridorGraph(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Find(data, width, height);
+	}
+
+
+
+
+	//! \brief Interface to search the corridor graph (see CorridorGraph.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize)
+	{
+		unsigned int nodes_expanded;
+		return FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+				pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+
+	//! \brief Interface with diagnostics (see CorridorGraph.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		const std::shared_ptr<const CorridorGraph> p_graph = FindCorridorGraph(pMap, nMapWidth, nMapHeight);
+		if (!p_graph)
+			return astar::FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+					pOutBuffer, nOutBufferSize, nodes_expanded);
+
+		const unsigned int start = nStartX + nStartY*nMapWidth;
+		const unsigned int target = nTargetX + nTargetY*nMapWidth;
+		const std::shared_ptr<const o_graph::ComponentLabels> p_components = o_graph::FindComponents(pMap, nMapWidth, nMapHeight);
+		if ( p_components && !p_components->connected(start, target) )
+		{
+			nodes_expanded = 0;
+			return -1;
+		}
+		return p_graph->FindPath(start, target, pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+} // END OF NAMESPACE corridor
@@ -0,0 +1,13 @@
+/** \file
+ * 		DenseClosedList.cpp
+ *
+ *  \brief
+ *  	Provides a closed list for dense ids (class DenseClosedList)
+ *
+ *	\details
+ *		Accompanying .cpp file to DenseClosedList.hpp;
+ *		This file is a stub since DenseClosedList is
+ *		a template class.
+ */
+
+#include "DenseClosedList.hpp"
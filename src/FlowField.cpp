@@ -0,0 +1,216 @@
+/** \file
+ * 		FlowField.cpp
+ *
+ * 	\brief
+ *		Provides one-to-many pathfinding (flow fields)
+ *
+ * 	\details
+ * 		Contains definitions to accompnying header FlowField.hpp
+ * 		and the registry of flow fields for single targets.
+ * 		This file is part of project pdx_pathfinding
+ */
+
+#include <algorithm>  // std::sort, std::unique
+#include <memory>     // std::make_shared
+#include <utility>    // std::pair (key of the registry)
+#include "FlowField.hpp"
+#include "Registry.hpp"  // registered fields
+#include "AStar.hpp"     // fallback without registered field
+#include "Map.hpp"       // terrain symbols
+
+namespace flowfield
+{
+
+	const unsigned char FlowField::target_;
+	const unsigned char FlowField::unreached_;
+
+
+	/** \brief Constructor: breadth first search from all targets at once
+	 *
+	 *  \details A grid point reached from its neighbour n gets the move to n.
+	 *  Blocked targets are ignored.
+	 *
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 *  \param[in] targets ids of the targets
+	 */
+	FlowField::FlowField(const int &width, const int &height, const unsigned char *data,
+			const std::vector<unsigned int> &targets) :
+		width_(width), height_(height), data_(data), targets_(targets),
+		moves_(width*height, unreached_)
+	{
+		offsets_[0] = 1;
+		offsets_[1] = -1;
+		offsets_[2] = width_;
+		offsets_[3] = -width_;
+
+		std::sort(targets_.begin(), targets_.end());
+		targets_.erase(std::unique(targets_.begin(), targets_.end()), targets_.end());
+
+		std::vector<unsigned int> queue;
+		queue.reserve(width_*height_);
+		for (std::size_t i = 0; i < targets_.size(); ++i)
+			if (data_[targets_[i]] == o_graph::Map::terrain_traversable_)
+			{
+				moves_[targets_[i]] = target_;
+				queue.push_back(targets_[i]);
+			}
+
+		for (std::size_t head = 0; head < queue.size(); ++head)
+		{
+			const unsigned int id = queue[head];
+			const int x = id % width_;
+			const int y = id / width_;
+			// a neighbour in direction d gets the opposite move (d^1)
+			const bool exists[4] = {x+1 < width_, x > 0, y+1 < height_, y > 0};
+			for (int d = 0; d < 4; ++d)
+			{
+				if (!exists[d])
+					continue;
+				const unsigned int neighbour = id + offsets_[d];
+				if ((moves_[neighbour] != unreached_) || (data_[neighbour] != o_graph::Map::terrain_traversable_))
+					continue;
+				moves_[neighbour] = (unsigned char) (d ^ 1);
+				queue.push_back(neighbour);
+			}
+		}
+	}
+
+
+	/** \brief Follows the field from start to the nearest target
+	 *
+	 *  \param[in] start first grid point
+	 *  \param[out] pOutBuffer buffer for the path (excluding start)
+	 *  \param[in] nOutBufferSize length of pOutBuffer
+	 *  \return length of the path; -1 if no target can be reached or the path
+	 *  doesn't fit into the buffer (the buffer holds its beginning then)
+	 */
+	int FlowField::FindPath(const unsigned int &start, int *pOutBuffer, const int &nOutBufferSize) const
+	{
+		if (moves_[start] == unreached_)
+			return -1;
+
+		int n = 0;
+		unsigned int id = start;
+		while (moves_[id] != target_)
+		{
+			if (n == nOutBufferSize)
+				return -1;
+			id += offsets_[moves_[id]];
+			pOutBuffer[n++] = id;
+		}
+		return n;
+	}
+
+
+	/** \brief Distance to the nearest target (in O(distance))
+	 *  \param[in] id the grid point
+	 *  \return number of moves; -1 if no target can be reached
+	 */
+	int FlowField::get_distance(const unsigned int &id) const
+	{
+		if (moves_[id] == unreached_)
+			return -1;
+
+		int n = 0;
+		for (unsigned int current = id; moves_[current] != target_; current += offsets_[moves_[current]])
+			++n;
+		return n;
+	}
+
+
+	//! \brief memory used by the field (bytes)
+	std::size_t FlowField::get_memory_footprint() const
+	{
+		return sizeof(FlowField) + moves_.capacity() + targets_.capacity()*sizeof(unsigned int);
+	}
+
+
+
+
+	//! \brief Key of a registered field: data pointer of the map and target
+	typedef std::pair<const unsigned char*, unsigned int> FieldKey;
+
+	static o_data_structures::Registry<FlowField, FieldKey> registry;  //< fields of all registered targets
+
+
+	/** \brief Builds the flow field of a target and registers it for flowfield::FindPath(..)
+	 *
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] target id of the target
+	 *  \return the field
+	 *
+	 *  \details Registering a target again replaces its field; queries that are
+	 *  still following the old field keep it alive until they are done.
+	 *
+	 *  \note The field must be registered again if the map data changes.
+	 */
+	std::shared_ptr<const FlowField> RegisterFlowField(const unsigned char *data, const int &width, const int &height,
+			const unsigned int &target)
+	{
+		return registry.Register(std::make_pair(data, target),
+				std::make_shared<const FlowField>(width, height, data, std::vector<unsigned int>(1, target)));
+	}
+
+
+	/** \brief Removes the flow field of a target from the registry
+	 *  \param[in] data grid data of the map
+	 *  \param[in] target id of the target
+	 *  \note Queries that are following the field keep it alive until they are done.
+	 */
+	void UnregisterFlowField(const unsigned char *data, const unsigned int &target)
+	{
+		registry.Unregister(std::make_pair(data, target));
+		return;
+	}
+
+
+	/** \brief Looks up the registered flow field of a target
+	 *  \param[in] data grid data of the map
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] target id of the target
+	 *  \return field of the target (stays valid while the caller holds it, even if
+	 *  it is replaced or unregistered); empty if none is registered for this data, extent and target
+	 */
+	std::shared_ptr<const FlowField> FindFlowField(const unsigned char *data, const int &width, const int &height,
+			const unsigned int &target)
+	{
+		return registry.Find(std::make_pair(data, target), width, height);
+	}
+
+
+
+
+	//! \brief Interface to follow a registered flow field (see FlowField.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize)
+	{
+		unsigned int nodes_expanded;
+		return FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+				pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+
+	//! \brief Interface with diagnostics (see FlowField.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		const unsigned int target = nTargetX + nTargetY*nMapWidth;
+		const std::shared_ptr<const FlowField> p_field = FindFlowField(pMap, nMapWidth, nMapHeight, target);
+		if (!p_field)
+			return astar::FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+					pOutBuffer, nOutBufferSize, nodes_expanded);
+
+		nodes_expanded = 0;
+		return p_field->FindPath(nStartX + nStartY*nMapWidth, pOutBuffer, nOutBufferSize);
+	}
+
+} // END OF NAMESPACE flowfield
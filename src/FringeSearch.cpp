@@ -0,0 +1,225 @@
+/** \file
+ * 		FringeSearch.cpp
+ *
+ * 	\brief
+ *		Provides pathfinding capabilities with little memory (fringe search)
+ *
+ * 	\details
+ * 		Contains definitions to accompnying header FringeSearch.hpp
+ * 		This file is part of project pdx_pathfinding
+ */
+
+#include "FringeSearch.hpp"
+
+namespace fringe
+{
+
+	/** \brief Workspace of the calling thread
+	 *  \return Reference to the workspace of the calling thread
+	 */
+	Workspace &ThreadWorkspace()
+	{
+		static thread_local Workspace workspace;
+		return workspace;
+	}
+
+
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize)
+	{
+		unsigned int nodes_expanded;
+		return FindPath(nStartX, nStartY, nTargetX, nTargetY,
+				pMap, nMapWidth, nMapHeight, pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		int return_value;
+		o_graph::Map map(nMapWidth,nMapHeight,pMap);
+		FringeSearch Pathfinder(map,pOutBuffer,nOutBufferSize);
+		return_value = Pathfinder.FindPath(nStartX, nStartY, nTargetX, nTargetY);
+		nodes_expanded = Pathfinder.nodes_expanded_;
+		return return_value;
+	}
+
+
+	/** \brief Constructor
+	 *  \param[in] map Reference to the game map represented by an instance of class Map
+	 *  \param[in] p_buffer Pointer to the output buffer where the path is written to (Memory ownership by caller)
+	 *  \param[in] size_buffer length of the buffer p_buffer
+	 */
+	FringeSearch::FringeSearch(o_graph::Map &map, int *p_buffer, int size_buffer) :
+			nodes_expanded_(0), max_frontier_(0),
+			output_buffer_size_(size_buffer), p_output_buffer_(p_buffer), map_(map),
+			visited_(ThreadWorkspace().visited_), moves_(ThreadWorkspace().moves_),
+			now_(ThreadWorkspace().now_), later_(ThreadWorkspace().later_)
+	{
+		// nothing to do here
+	}
+
+
+	/** \brief Constructor using a Workspace provided by the caller
+	 *  \param[in] map Reference to the game map represented by an instance of class Map
+	 *  \param[in] p_buffer Pointer to the output buffer where the path is written to (Memory ownership by caller)
+	 *  \param[in] size_buffer length of the buffer p_buffer
+	 *  \param[in] workspace Lists and bitmaps used by the search
+	 */
+	FringeSearch::FringeSearch(o_graph::Map &map, int *p_buffer, int size_buffer, Workspace &workspace) :
+			nodes_expanded_(0), max_frontier_(0),
+			output_buffer_size_(size_buffer), p_output_buffer_(p_buffer), map_(map),
+			visited_(workspace.visited_), moves_(workspace.moves_),
+			now_(workspace.now_), later_(workspace.later_)
+	{
+		// nothing to do here
+	}
+
+
+	/** \brief Marks a grid point as visited and stores the move leading to it
+	 *  \param[in] id The grid point
+	 *  \param[in] move 0: x+1, 1: x-1, 2: y+1, 3: y-1
+	 */
+	void FringeSearch::Visit(const unsigned int &id, const unsigned int &move)
+	{
+		visited_[id >> 6] |= 1ULL << (id & 63);
+		unsigned int shift = (id & 3) << 1;
+		moves_[id >> 2] = (unsigned char) ((moves_[id >> 2] & ~(3u << shift)) | (move << shift));
+		return;
+	}
+
+
+	/** \brief Searches the shortest path from (iS,jS) to (iT,jT)
+	 *
+	 *  \details Iteration T pops grid points from the now list until it is empty;
+	 *  successors with the same f-value are visited at once and pushed to the now list,
+	 *  all others to the later list. Since the f-value of a successor is T or T+2,
+	 *  the later list holds exactly the frontier of the next iteration.
+	 *
+	 *  \param[in] iS The zero based x-coordinate of the start position
+	 *  \param[in] jS The zero based y-coordinate of the start position
+	 *  \param[in] iT The zero based x-coordinate of the target position
+	 *  \param[in] jT The zero based y-coordinate of the target position
+	 *
+	 *	\return length of the path from starting position to target; -1 if no path exist
+	 */
+	int FringeSearch::FindPath(const int &iS, const int &jS, const int &iT, const int &jT)
+	{
+		const unsigned int start_id = map_.get_id(iS,jS);
+		const unsigned int target_id = map_.get_id(iT,jT);
+		const unsigned int n_nodes = map_.width_*map_.height_;
+		const int width = map_.width_;
+		const unsigned char *data = map_.data_;
+
+		if (!map_.is_reachable(start_id, target_id))
+			return -1;
+
+		visited_.assign((n_nodes + 63) >> 6, 0ULL);
+		if (moves_.size() < ((n_nodes + 3) >> 2))
+			moves_.resize((n_nodes + 3) >> 2);
+		now_.clear();
+		later_.clear();
+
+		map_.set_heuristic(iT,jT);
+		int threshold = map_.get_manhattan(start_id);
+		Visit(start_id, 0);
+		now_.push_back(start_id);
+
+		while (!now_.empty())
+		{
+			while (!now_.empty())
+			{
+				const unsigned int id = now_.back();
+				now_.pop_back();
+				++nodes_expanded_;
+
+				if (id == target_id)
+				{
+					int path_length = BacktrackPath(target_id, threshold);
+					now_.clear();
+					later_.clear();
+					return path_length;
+				}
+
+				const int x = id % width;
+				const int y = id / width;
+				const int h = map_.get_manhattan(id);
+				unsigned int neighbours[4];
+				unsigned int moves[4];
+				int n_neighbours = 0;
+				if ((x+1 < width) && (data[id+1] == o_graph::Map::terrain_traversable_))
+				{ neighbours[n_neighbours] = id+1; moves[n_neighbours++] = 0; }
+				if ((x > 0) && (data[id-1] == o_graph::Map::terrain_traversable_))
+				{ neighbours[n_neighbours] = id-1; moves[n_neighbours++] = 1; }
+				if ((y+1 < map_.height_) && (data[id+width] == o_graph::Map::terrain_traversable_))
+				{ neighbours[n_neighbours] = id+width; moves[n_neighbours++] = 2; }
+				if ((y > 0) && (data[id-width] == o_graph::Map::terrain_traversable_))
+				{ neighbours[n_neighbours] = id-width; moves[n_neighbours++] = 3; }
+
+				for (int i = 0; i < n_neighbours; ++i)
+				{
+					const unsigned int neighbour = neighbours[i];
+					if (is_visited(neighbour))
+						continue;
+					if (map_.get_manhattan(neighbour) < h) // f-value stays at threshold
+					{
+						Visit(neighbour, moves[i]);
+						now_.push_back(neighbour);
+					}
+					else
+						later_.push_back((neighbour << 2) | moves[i]);
+				}
+				if (now_.size() + later_.size() > max_frontier_)
+					max_frontier_ = now_.size() + later_.size();
+			}
+
+			// next iteration: the frontier of f == threshold+2 becomes the now list
+			threshold += 2;
+			for (std::size_t i = 0; i < later_.size(); ++i)
+			{
+				const unsigned int id = later_[i] >> 2;
+				if (is_visited(id))
+					continue;
+				Visit(id, later_[i] & 3u);
+				now_.push_back(id);
+			}
+			later_.clear();
+		}
+
+		return -1;
+	}
+
+
+	/** \brief Reconstructs the shortest path from the stored moves and writes it to p_output_buffer_
+	 *
+	 *  \details The path is walked backwards from the target; grid points beyond
+	 *  the size of the buffer are discarded.
+	 *
+	 *  \param[in] target_id The target
+	 *  \param[in] path_length The length of the path (the threshold the target was expanded at)
+	 *  \return path_length
+	 */
+	int FringeSearch::BacktrackPath(const unsigned int &target_id, const int &path_length) const
+	{
+		const unsigned int width = map_.width_;
+		unsigned int id = target_id;
+		for (int n = path_length - 1; n >= 0; --n)
+		{
+			if (n < output_buffer_size_)
+				p_output_buffer_[n] = id;
+			switch ((moves_[id >> 2] >> ((id & 3) << 1)) & 3u)
+			{
+				case 0 : id -= 1; break;
+				case 1 : id += 1; break;
+				case 2 : id -= width; break;
+				default : id += width; break;
+			}
+		}
+		return path_length;
+	}
+
+} // END OF NAMESPACE fringe
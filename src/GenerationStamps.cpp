@@ -0,0 +1,13 @@
+/** \file
+ * 		GenerationStamps.cpp
+ *
+ *  \brief
+ *  	Provides a set of dense ids that can be emptied in O(1) (class GenerationStamps)
+ *
+ *	\details
+ *		Accompanying .cpp file to GenerationStamps.hpp;
+ *		This file is a stub since GenerationStamps is
+ *		a template class.
+ */
+
+#include "GenerationStamps.hpp"
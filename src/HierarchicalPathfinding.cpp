@@ -0,0 +1,543 @@
+/** \file
+ * 		HierarchicalPathfinding.cpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (hierarchical pathfinding, HPA*)
+ *
+ *	\details
+ *		Contains definitions to accompanying header HierarchicalPathfinding.hpp
+ *		and the registry of cluster graphs for maps passed by their data pointer.
+ *
+ *		Query:
+ *		- start and target in the same cluster: AStar restricted to the cluster;
+ *		  if the cluster doesn't connect both, the abstract graph is searched
+ *		- otherwise the distances from start (target) to the abstract nodes of its
+ *		  cluster are computed by a breadth first search inside the cluster. The
+ *		  abstract graph is searched by A* (Manhattan heuristic) from the virtual
+ *		  start node to the virtual target node, which are connected to the
+ *		  abstract nodes of their clusters by these distances.
+ */
+
+#include <algorithm>   // std::min, std::reverse
+#include <cstdlib>     // std::abs
+#include "HierarchicalPathfinding.hpp"
+#include "Registry.hpp"             // registered graphs
+#include "AStar.hpp"                // refinement inside a cluster
+#include "ComponentLabels.hpp"      // O(1) rejection of unreachable queries
+#include "GenerationStamps.hpp"     // visited abstract nodes
+#include "IndexedBinaryHeap.hpp"    // open list of the abstract search
+
+namespace hpa
+{
+
+	const int ClusterGraph::max_single_transition_;
+
+
+	/** \brief Constructor (clusters the map and builds the abstract graph)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] data grid data of the map (see Map.hpp), must outlive the graph
+	 *  \param[in] cluster_size extent of a cluster in x- and y-direction
+	 */
+	ClusterGraph::ClusterGraph(const int &width, const int &height, const unsigned char *data,
+			const int &cluster_size) :
+			width_(width), height_(height), data_(data), cluster_size_(cluster_size),
+			n_clusters_x_((width+cluster_size-1)/cluster_size),
+			n_clusters_y_((height+cluster_size-1)/cluster_size)
+	{
+		cluster_nodes_.resize(n_clusters_x_*n_clusters_y_);
+		std::vector<int> node_of(width_*height_, -1);
+
+		// entrances at vertical borders (between left and right cluster)
+		for (int x=cluster_size_; x<width_; x+=cluster_size_)
+			for (int y=0; y<height_; y+=cluster_size_)
+				AddEntrances(x-1, y, 0, 1, std::min(cluster_size_, height_-y), node_of);
+
+		// entrances at horizontal borders (between upper and lower cluster)
+		for (int y=cluster_size_; y<height_; y+=cluster_size_)
+			for (int x=0; x<width_; x+=cluster_size_)
+				AddEntrances(x, y-1, 1, 0, std::min(cluster_size_, width_-x), node_of);
+
+		// edges between the abstract nodes of a cluster
+		std::vector<int> distances;
+		for (std::size_t c=0; c<cluster_nodes_.size(); ++c)
+			for (std::size_t i=0; i<cluster_nodes_[c].size(); ++i)
+			{
+				unsigned int a = cluster_nodes_[c][i];
+				ClusterDistances(nodes_[a].id_, distances);
+				for (std::size_t j=0; j<cluster_nodes_[c].size(); ++j)
+				{
+					unsigned int b = cluster_nodes_[c][j];
+					int distance = distances[get_local_index(nodes_[b].id_)];
+					if ((a != b) && (distance > 0))
+						AddEdge(a, b, distance);
+				}
+			}
+	}
+
+
+	/** \brief Finds the entrances along a cluster border and adds their transitions
+	 *
+	 *  \param[in] x0 x-coordinate of the first grid point on the near side of the border
+	 *  \param[in] y0 y-coordinate of the first grid point on the near side of the border
+	 *  \param[in] dx direction along the border (x-component)
+	 *  \param[in] dy direction along the border (y-component)
+	 *  \param[in] length number of grid points along the border
+	 *  \param[in,out] node_of abstract node of every grid point (-1 if none)
+	 */
+	void ClusterGraph::AddEntrances(const int &x0, const int &y0, const int &dx, const int &dy,
+			const int &length, std::vector<int> &node_of)
+	{
+		const int across = (dx == 0) ? 1 : width_;  // id offset to the far side of the border
+		const int id0 = x0 + y0*width_;
+		const int step = dx + dy*width_;
+		int run_begin = -1;
+
+		for (int i=0; i<=length; ++i)
+		{
+			int id = id0 + i*step;
+			bool open = (i < length) && (data_[id] == 1) && (data_[id+across] == 1);
+			if (open && (run_begin < 0))
+				run_begin = i;
+			if (open || (run_begin < 0))
+				continue;
+
+			// entrance [run_begin, i-1] ends here
+			int run_end = i-1;
+			int transitions[2] = {(run_begin+run_end)/2, run_end};
+			int n_transitions = 1;
+			if (run_end-run_begin+1 >= max_single_transition_)
+			{
+				transitions[0] = run_begin;
+				n_transitions = 2;
+			}
+			for (int t=0; t<n_transitions; ++t)
+			{
+				unsigned int near_id = id0 + transitions[t]*step;
+				unsigned int a = AddNode(near_id, node_of);
+				unsigned int b = AddNode(near_id+across, node_of);
+				AddEdge(a, b, 1);
+				AddEdge(b, a, 1);
+			}
+			run_begin = -1;
+		}
+		return;
+	}
+
+
+	/** \brief Adds an abstract node for a grid point (if it has none yet)
+	 *  \param[in] id The grid point
+	 *  \param[in,out] node_of abstract node of every grid point (-1 if none)
+	 *  \return index of the abstract node
+	 */
+	unsigned int ClusterGraph::AddNode(const unsigned int &id, std::vector<int> &node_of)
+	{
+		if (node_of[id] >= 0)
+			return node_of[id];
+
+		Node node;
+		node.id_ = id;
+		node.cluster_ = get_cluster(id%width_, id/width_);
+		node_of[id] = nodes_.size();
+		cluster_nodes_[node.cluster_].push_back(nodes_.size());
+		nodes_.push_back(node);
+		return node_of[id];
+	}
+
+
+	/** \brief Adds a directed edge
+	 *  \param[in] a index of the source node
+	 *  \param[in] b index of the target node
+	 *  \param[in] cost number of moves from a to b
+	 */
+	void ClusterGraph::AddEdge(const unsigned int &a, const unsigned int &b, const int &cost)
+	{
+		Edge edge = {b, cost};
+		nodes_[a].edges_.push_back(edge);
+		return;
+	}
+
+
+	/** \brief index of a grid point within its cluster
+	 *  \param[in] id The grid point
+	 *  \return (x%cluster_size_) + (y%cluster_size_)*cluster_size_
+	 */
+	unsigned int ClusterGraph::get_local_index(const unsigned int &id) const
+	{
+		return (id%width_)%cluster_size_ + ((id/width_)%cluster_size_)*cluster_size_;
+	}
+
+
+	/** \brief Breadth first search restricted to the cluster of a grid point
+	 *
+	 *  \param[in] origin The grid point to start from (must be traversable)
+	 *  \param[out] distances distance of every grid point of the cluster by
+	 *  get_local_index(..); -1 if it can't be reached inside the cluster
+	 *  \return number of grid points reached
+	 */
+	int ClusterGraph::ClusterDistances(const unsigned int &origin, std::vector<int> &distances) const
+	{
+		const int x0 = (origin%width_) - (origin%width_)%cluster_size_;
+		const int y0 = (origin/width_) - (origin/width_)%cluster_size_;
+		const int x1 = std::min(x0+cluster_size_, width_);
+		const int y1 = std::min(y0+cluster_size_, height_);
+
+		distances.assign(cluster_size_*cluster_size_, -1);
+		std::vector<unsigned int> queue(1, origin);
+		distances[get_local_index(origin)] = 0;
+
+		for (std::size_t head=0; head<queue.size(); ++head)
+		{
+			const unsigned int id = queue[head];
+			const int x = id%width_;
+			const int y = id/width_;
+			const int distance = distances[get_local_index(id)] + 1;
+			const int neighbours[4][2] = {{x-1,y}, {x+1,y}, {x,y-1}, {x,y+1}};
+			for (int n=0; n<4; ++n)
+			{
+				const int nx = neighbours[n][0];
+				const int ny = neighbours[n][1];
+				if ((nx < x0) || (nx >= x1) || (ny < y0) || (ny >= y1))
+					continue;
+				const unsigned int neighbour = nx + ny*width_;
+				int &neighbour_distance = distances[get_local_index(neighbour)];
+				if ((data_[neighbour] != 1) || (neighbour_distance >= 0))
+					continue;
+				neighbour_distance = distance;
+				queue.push_back(neighbour);
+			}
+		}
+		return queue.size();
+	}
+
+
+	/** \brief Shortest path between two grid points inside their cluster (AStar)
+	 *
+	 *  \param[in] from The grid point to start from
+	 *  \param[in] to The grid point to go to (in the same cluster as from)
+	 *  \param[out] moves the grid points of the path (excluding from) are appended
+	 *  \param[in,out] nodes_expanded is increased by the nodes expanded by AStar
+	 *  \return length of the path; -1 if the cluster doesn't connect both grid points
+	 */
+	int ClusterGraph::RefineSegment(const unsigned int &from, const unsigned int &to,
+			std::vector<int> &moves, unsigned int &nodes_expanded) const
+	{
+		static thread_local std::vector<unsigned char> cluster_data;
+		static thread_local std::vector<int> buffer;
+
+		const int x0 = (from%width_) - (from%width_)%cluster_size_;
+		const int y0 = (from/width_) - (from/width_)%cluster_size_;
+		const int cluster_width = std::min(cluster_size_, width_-x0);
+		const int cluster_height = std::min(cluster_size_, height_-y0);
+
+		// AStar searches a copy of the cluster
+		cluster_data.resize(cluster_width*cluster_height);
+		buffer.resize(cluster_width*cluster_height);
+		for (int y=0; y<cluster_height; ++y)
+			for (int x=0; x<cluster_width; ++x)
+				cluster_data[x + y*cluster_width] = data_[(x0+x) + (y0+y)*width_];
+
+		unsigned int expanded = 0;
+		int length = astar::FindPath(from%width_-x0, from/width_-y0, to%width_-x0, to/width_-y0,
+				&cluster_data[0], cluster_width, cluster_height, &buffer[0], buffer.size(), expanded);
+		nodes_expanded += expanded;
+
+		for (int i=0; i<length; ++i)
+			moves.push_back( (x0 + buffer[i]%cluster_width) + (y0 + buffer[i]/cluster_width)*width_ );
+		return length;
+	}
+
+
+
+
+	//! \brief memory of the abstract search kept between queries (one per thread)
+	struct SearchWorkspace
+	{
+		std::vector<int> start_distances_;   //< distances inside the start cluster
+		std::vector<int> target_distances_;  //< distances inside the target cluster
+		std::vector<int> g_;                 //< path cost of abstract nodes
+		std::vector<int> predecessors_;      //< predecessor of abstract nodes (-1: start)
+		o_data_structures::GenerationStamps<unsigned int> seen_;    //< nodes with valid g_
+		o_data_structures::GenerationStamps<unsigned int> closed_;  //< expanded nodes
+		o_data_structures::IndexedBinaryHeap<int, unsigned int> open_list_;  //< keyed by f
+	};
+
+
+	/** \brief Updates an abstract node reached by the abstract search
+	 *
+	 *  \param[in,out] workspace memory of the abstract search
+	 *  \param[in] graph The cluster graph
+	 *  \param[in] node The reached node (graph.nodes_.size() is the virtual target)
+	 *  \param[in] g path cost of node via predecessor
+	 *  \param[in] predecessor The expanded node (-1 for the virtual start)
+	 *  \param[in] nTargetX x-coordinate of the target position
+	 *  \param[in] nTargetY y-coordinate of the target position
+	 */
+	void RelaxNode(SearchWorkspace &workspace, const ClusterGraph &graph, const unsigned int &node,
+			const int &g, const int &predecessor, const int &nTargetX, const int &nTargetY)
+	{
+		int h = 0;
+		if (node < graph.nodes_.size())
+			h = std::abs((int) (graph.nodes_[node].id_%graph.width_) - nTargetX)
+					+ std::abs((int) (graph.nodes_[node].id_/graph.width_) - nTargetY);
+
+		if (!workspace.seen_.is_set(node))
+		{
+			workspace.seen_.set(node);
+			workspace.g_[node] = g;
+			workspace.predecessors_[node] = predecessor;
+			workspace.open_list_.insert(node, g+h, node);
+		}
+		else if (g < workspace.g_[node])
+		{
+			workspace.g_[node] = g;
+			workspace.predecessors_[node] = predecessor;
+			workspace.open_list_.change_key_by_id(node, g+h);
+		}
+		return;
+	}
+
+
+	//! \brief Constructor (no path)
+	HierarchicalPath::HierarchicalPath() :
+			p_graph_(0L), length_(-1), next_waypoint_(0), segment_position_(0), nodes_expanded_(0)
+	{
+		// nothing to do here
+	}
+
+
+	/** \brief Searches the abstract graph (see file documentation)
+	 *
+	 *  \param[in] graph The cluster graph of the map (must outlive the refinement)
+	 *  \param[in] nStartX x-coordinate of the start position
+	 *  \param[in] nStartY y-coordinate of the start position
+	 *  \param[in] nTargetX x-coordinate of the target position
+	 *  \param[in] nTargetY y-coordinate of the target position
+	 *  \return length of the path; -1 if no path exists
+	 *
+	 *  \note Only the segments inside the start cluster might be refined already;
+	 *  the moves are delivered by Refine(..)
+	 */
+	int HierarchicalPath::Search(const ClusterGraph &graph, const int &nStartX, const int &nStartY,
+			const int &nTargetX, const int &nTargetY)
+	{
+		static thread_local SearchWorkspace workspace;
+
+		p_graph_ = &graph;
+		length_ = -1;
+		waypoints_.clear();
+		next_waypoint_ = 1;
+		segment_.clear();
+		segment_position_ = 0;
+		nodes_expanded_ = 0;
+
+		const unsigned int start = nStartX + nStartY*graph.width_;
+		const unsigned int target = nTargetX + nTargetY*graph.width_;
+		const unsigned int start_cluster = graph.get_cluster(nStartX, nStartY);
+		const unsigned int target_cluster = graph.get_cluster(nTargetX, nTargetY);
+
+		const std::shared_ptr<const o_graph::ComponentLabels> p_components = o_graph::FindComponents(graph.data_, graph.width_, graph.height_);
+		if ( p_components && !p_components->connected(start, target) )
+			return length_;
+
+		waypoints_.push_back(start);
+		if (start == target)
+		{
+			length_ = 0;
+			return length_;
+		}
+
+		if (start_cluster == target_cluster)
+		{
+			length_ = graph.RefineSegment(start, target, segment_, nodes_expanded_);
+			if (length_ >= 0)
+			{
+				waypoints_.push_back(target);
+				next_waypoint_ = waypoints_.size();
+				return length_;
+			}
+			segment_.clear();
+		}
+
+		// abstract nodes 0..N-1, virtual target N
+		const unsigned int n_nodes = graph.nodes_.size();
+		const unsigned int virtual_target = n_nodes;
+		workspace.g_.resize(n_nodes+1);
+		workspace.predecessors_.resize(n_nodes+1);
+		workspace.seen_.resize(n_nodes+1);
+		workspace.closed_.resize(n_nodes+1);
+		workspace.seen_.next_generation();
+		workspace.closed_.next_generation();
+		workspace.open_list_.resize_ids(n_nodes+1);
+		workspace.open_list_.clear();
+		nodes_expanded_ += graph.ClusterDistances(start, workspace.start_distances_);
+		nodes_expanded_ += graph.ClusterDistances(target, workspace.target_distances_);
+
+		// edges of the virtual start
+		for (std::size_t i=0; i<graph.cluster_nodes_[start_cluster].size(); ++i)
+		{
+			unsigned int node = graph.cluster_nodes_[start_cluster][i];
+			int distance = workspace.start_distances_[graph.get_local_index(graph.nodes_[node].id_)];
+			if (distance >= 0)
+				RelaxNode(workspace, graph, node, distance, -1, nTargetX, nTargetY);
+		}
+
+		bool found = false;
+		while (!workspace.open_list_.is_empty())
+		{
+			unsigned int node = workspace.open_list_.pop(0);
+			if (node == virtual_target)
+			{
+				found = true;
+				break;
+			}
+			workspace.closed_.set(node);
+			++nodes_expanded_;
+
+			const ClusterGraph::Node &abstract_node = graph.nodes_[node];
+			const int g = workspace.g_[node];
+			if (abstract_node.cluster_ == target_cluster)
+			{
+				int distance = workspace.target_distances_[graph.get_local_index(abstract_node.id_)];
+				if (distance >= 0)
+					RelaxNode(workspace, graph, virtual_target, g+distance, node, nTargetX, nTargetY);
+			}
+			for (std::size_t e=0; e<abstract_node.edges_.size(); ++e)
+			{
+				const ClusterGraph::Edge &edge = abstract_node.edges_[e];
+				if (!workspace.closed_.is_set(edge.target_))
+					RelaxNode(workspace, graph, edge.target_, g+edge.cost_, node, nTargetX, nTargetY);
+			}
+		}
+		if (!found)
+		{
+			waypoints_.clear();
+			return length_;
+		}
+
+		// waypoints: start, abstract nodes, target
+		for (int node=workspace.predecessors_[virtual_target]; node>=0; node=workspace.predecessors_[node])
+			waypoints_.push_back(graph.nodes_[node].id_);
+		std::reverse(waypoints_.begin()+1, waypoints_.end());
+		waypoints_.push_back(target);
+		length_ = workspace.g_[virtual_target];
+		return length_;
+	}
+
+
+	/** \brief Delivers the next moves of the path
+	 *
+	 *  \details Segments between waypoints are refined when their first move is
+	 *  delivered (AStar inside a cluster for segments within a cluster).
+	 *
+	 *  \param[out] pOutBuffer buffer for the moves (owned by caller)
+	 *  \param[in] n_moves maximum number of moves to be written
+	 *  \return number of moves written (less than n_moves at the end of the path)
+	 */
+	int HierarchicalPath::Refine(int *pOutBuffer, const int &n_moves)
+	{
+		int n = 0;
+		while (n < n_moves)
+		{
+			if (segment_position_ < segment_.size())
+			{
+				pOutBuffer[n++] = segment_[segment_position_++];
+				continue;
+			}
+			if (next_waypoint_ >= waypoints_.size())
+				break;
+
+			unsigned int from = waypoints_[next_waypoint_-1];
+			unsigned int to = waypoints_[next_waypoint_];
+			++next_waypoint_;
+			segment_.clear();
+			segment_position_ = 0;
+			if (from == to)
+				continue;
+			if ( p_graph_->get_cluster(from%p_graph_->width_, from/p_graph_->width_)
+					!= p_graph_->get_cluster(to%p_graph_->width_, to/p_graph_->width_) )
+				segment_.push_back(to);  // move across a cluster border
+			else
+				p_graph_->RefineSegment(from, to, segment_, nodes_expanded_);
+		}
+		return n;
+	}
+
+
+
+
+	static o_data_structures::Registry<ClusterGraph> registry;  //< graphs of all registered maps
+
+
+	/** \brief Builds the cluster graph of a map and registers it for hpa::FindPath(..)
+	 *
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return the graph
+	 *
+	 *  \note The graph must be registered again if the map data changes.
+	 */
+	std::shared_ptr<const ClusterGraph> RegisterClusterGraph(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Register(data, std::make_shared<const ClusterGraph>(width, height, data));
+	}
+
+
+	/** \brief Removes the cluster graph of a map from the registry
+	 *  \param[in] data grid data of the map
+	 *  \note Pathfinders that use it keep it alive until they are done.
+	 */
+	void UnregisterClusterGraph(const unsigned char *data)
+	{
+		registry.Unregister(data);
+		return;
+	}
+
+
+	/** \brief Looks up the registered cluster graph of a map
+	 *  \param[in] data grid data of the map
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return graph of the map; empty if none is registered for this data and extent
+	 */
+	std::shared_ptr<const ClusterGraph> FindClusterGraph(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Find(data, width, height);
+	}
+
+
+
+
+	//! \brief Interface to use hierarchical pathfinding (see HierarchicalPathfinding.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize)
+	{
+		unsigned int nodes_expanded;
+		return FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+				pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+
+	//! \brief Interface with diagnostics (see HierarchicalPathfinding.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		const std::shared_ptr<const ClusterGraph> p_graph = FindClusterGraph(pMap, nMapWidth, nMapHeight);
+		if (!p_graph)
+			return astar::FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+					pOutBuffer, nOutBufferSize, nodes_expanded);
+
+		static thread_local HierarchicalPath path;
+		int nPathLength = path.Search(*p_graph, nStartX, nStartY, nTargetX, nTargetY);
+		if ( (nPathLength > 0) && (nPathLength <= nOutBufferSize) )
+			path.Refine(pOutBuffer, nPathLength);
+		nodes_expanded = path.nodes_expanded_;
+		return nPathLength;
+	}
+
+} // END OF NAMESPACE hpa
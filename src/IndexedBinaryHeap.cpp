@@ -0,0 +1,13 @@
+/** \file
+ * 		IndexedBinaryHeap.cpp
+ *
+ *  \brief
+ *  	Provides a binary minimum heap with id -> position lookup (class IndexedBinaryHeap)
+ *
+ *	\details
+ *		Accompanying .cpp file to IndexedBinaryHeap.hpp;
+ *		This file is a stub since IndexedBinaryHeap is
+ *		a template class.
+ */
+
+#include "IndexedBinaryHeap.hpp"
@@ -0,0 +1,357 @@
+/** \file
+ * 		JumpPointSearch.cpp
+ *
+ * 	\brief
+ *		Provides pathfinding capabilities (Jump Point Search on a 4-connected grid)
+ *
+ * 	\details
+ * 		Contains definitions to accompanying header JumpPointSearch.hpp
+ * 		This file is part of project pdx_pathfinding
+ */
+
+#include "JumpPointSearch.hpp"
+
+
+namespace jps
+{
+
+	/** \brief Interface function that delegates the task of pathfinding to a class JumpPointSearch object
+	 *
+	 *  \details Same requirements as astar::FindPath(..); uses the workspace
+	 *  of the calling thread (astar::ThreadWorkspace()).
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 *
+	 *  \return Returns the length of the shortest path between Start and
+	 *  Target, or -1 if no such path exists
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize)
+	{
+		o_graph::Map map(nMapWidth,nMapHeight,pMap);
+		JumpPointSearch Pathfinder(map,pOutBuffer,nOutBufferSize);
+		return Pathfinder.FindPath(nStartX, nStartY, nTargetX, nTargetY);
+	}
+
+
+	/** \brief Interface function that delegates the task of finding a path to a class JumpPointSearch object
+	 *
+	 *  \details Version of Interface with additional diagnostic capbilities;
+	 *  NOT compatible to paradox requirements!!
+	 *  Parameters and return value as above plus:
+	 *
+	 *  \param[out] nodes_expanded number of insertions and updates of the open list
+	 */
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		int return_value;
+		o_graph::Map map(nMapWidth,nMapHeight,pMap);
+		JumpPointSearch Pathfinder(map,pOutBuffer,nOutBufferSize);
+		return_value = Pathfinder.FindPath(nStartX, nStartY, nTargetX, nTargetY);
+		nodes_expanded = Pathfinder.nodes_expanded_;
+		return return_value;
+	}
+
+
+
+
+	/** \brief Constructor
+	 *  \param[in] map Reference to the game map represented by an instance of class Map
+	 *  \param[in] p_buffer Pointer to the output buffer where the path is written to (Memory ownership by caller)
+	 *  \param[in] size_buffer length of the buffer p_buffer
+	 */
+	JumpPointSearch::JumpPointSearch(o_graph::Map &map, int *p_buffer, int size_buffer) :
+			nodes_expanded_(0), output_buffer_size_(size_buffer), p_output_buffer_(p_buffer),
+			map_(map), node_pool_(astar::ThreadWorkspace().node_pool_),
+			open_list_(astar::ThreadWorkspace().open_list_), closed_list_(astar::ThreadWorkspace().closed_list_),
+			x_target_(0), y_target_(0)
+	{
+		astar::ThreadWorkspace().Reserve(map_.width_*map_.height_);
+	}
+
+
+	/** \brief Constructor using a Workspace provided by the caller
+	 *  \param[in] map Reference to the game map represented by an instance of class Map
+	 *  \param[in] p_buffer Pointer to the output buffer where the path is written to (Memory ownership by caller)
+	 *  \param[in] size_buffer length of the buffer p_buffer
+	 *  \param[in] workspace Lists and NodePool used by the search (emptied at the end of FindPath(..))
+	 */
+	JumpPointSearch::JumpPointSearch(o_graph::Map &map, int *p_buffer, int size_buffer, astar::Workspace &workspace) :
+			nodes_expanded_(0), output_buffer_size_(size_buffer), p_output_buffer_(p_buffer),
+			map_(map), node_pool_(workspace.node_pool_),
+			open_list_(workspace.open_list_), closed_list_(workspace.closed_list_),
+			x_target_(0), y_target_(0)
+	{
+		workspace.Reserve(map_.width_*map_.height_);
+	}
+
+
+	/** \brief Scans a row starting at (x,y) for the next jump point
+	 *
+	 *  \detail A node of the row is a jump point if it is the target or if a
+	 *  vertical jump from it finds a jump point (vertical moves are natural
+	 *  successors of every horizontal move).
+	 *
+	 *  \param[in,out] x x-coordinate to start the scan at; x-coordinate of the jump point on success
+	 *  \param[in] y y-coordinate of the row
+	 *  \param[in] dx direction of the scan (-1 or +1)
+	 *  \return true if a jump point was found; false if the scan ran into an obstacle
+	 */
+	bool JumpPointSearch::JumpHorizontal(int &x, const int &y, const int &dx) const
+	{
+		while (is_free(x,y))
+		{
+			if ((x == x_target_) && (y == y_target_))
+				return true;
+
+			int y_probe = y-1;
+			if (JumpVertical(x, y_probe, -1))
+				return true;
+			y_probe = y+1;
+			if (JumpVertical(x, y_probe, +1))
+				return true;
+
+			x += dx;
+		}
+		return false;
+	}
+
+
+	/** \brief Scans a column starting at (x,y) for the next jump point
+	 *
+	 *  \detail A node of the column is a jump point if it is the target or if
+	 *  it has a forced horizontal neighbour, i.e. a traversable neighbour whose
+	 *  node behind (in direction -dy) is blocked.
+	 *
+	 *  \param[in] x x-coordinate of the column
+	 *  \param[in,out] y y-coordinate to start the scan at; y-coordinate of the jump point on success
+	 *  \param[in] dy direction of the scan (-1 or +1)
+	 *  \return true if a jump point was found; false if the scan ran into an obstacle
+	 */
+	bool JumpPointSearch::JumpVertical(const int &x, int &y, const int &dy) const
+	{
+		while (is_free(x,y))
+		{
+			if ((x == x_target_) && (y == y_target_))
+				return true;
+
+			if ( (is_free(x-1,y) && !is_free(x-1,y-dy)) ||
+				 (is_free(x+1,y) && !is_free(x+1,y-dy)) )
+				return true;
+
+			y += dy;
+		}
+		return false;
+	}
+
+
+	/** \brief Node Expansion in Jump Point Search
+	 *
+	 *  \detail Jumps from the node just visited in every direction that is
+	 *  canonical for the direction the node was reached from (see class documentation)
+	 *  and puts the jump points found on the open list.
+	 *  The starting node (no predecessor) jumps in all four directions.
+	 *
+	 *  \param[in] predecessor Pointer to the node that will be expanded (aka was just visited)
+	 */
+	void JumpPointSearch::IdentifySuccessors(MapNode *predecessor)
+	{
+		int x = map_.get_x(predecessor->id_);
+		int y = map_.get_y(predecessor->id_);
+
+		int dx = 0;
+		int dy = 0;
+		if (predecessor->p_predecessor_ != 0L)
+		{
+			int x_from = map_.get_x(predecessor->p_predecessor_->id_);
+			int y_from = map_.get_y(predecessor->p_predecessor_->id_);
+			dx = (x > x_from) - (x < x_from);
+			dy = (y > y_from) - (y < y_from);
+		}
+
+		if (dy == 0)
+		{
+			// horizontal move (or starting node): continue horizontally, turn vertically
+			for (int d=-1; d<=1; d+=2)
+			{
+				if (dx == -d)
+					continue;
+				int x_jump = x+d;
+				if (JumpHorizontal(x_jump, y, d))
+					PushSuccessor(predecessor, x_jump, y);
+			}
+			for (int d=-1; d<=1; d+=2)
+			{
+				int y_jump = y+d;
+				if (JumpVertical(x, y_jump, d))
+					PushSuccessor(predecessor, x, y_jump);
+			}
+		}
+		else
+		{
+			// vertical move: continue vertically, turn horizontally where forced
+			int y_jump = y+dy;
+			if (JumpVertical(x, y_jump, dy))
+				PushSuccessor(predecessor, x, y_jump);
+			for (int d=-1; d<=1; d+=2)
+			{
+				if (!is_free(x+d,y) || is_free(x+d,y-dy))
+					continue;
+				int x_jump = x+d;
+				if (JumpHorizontal(x_jump, y, d))
+					PushSuccessor(predecessor, x_jump, y);
+			}
+		}
+		return;
+	}
+
+
+	/** \brief Puts a jump point on the open list (or updates it)
+	 *  \param[in] predecessor The node the jump started at
+	 *  \param[in] x x-coordinate of the jump point
+	 *  \param[in] y y-coordinate of the jump point
+	 */
+	void JumpPointSearch::PushSuccessor(MapNode *predecessor, const int &x, const int &y)
+	{
+		unsigned int successor_id = map_.get_id(x,y);
+
+		// search closed list for successor
+		if (closed_list_.find(successor_id))
+			return;
+
+		int path_cost = predecessor->path_cost_ +
+				abs(x - map_.get_x(predecessor->id_)) + abs(y - map_.get_y(predecessor->id_));
+
+		// check open list if item with successor_id already exists (O(1) by id)
+		bool search_success = open_list_.contains(successor_id);
+
+		if (search_success)
+			if(path_cost >= open_list_.data(successor_id)->path_cost_ )
+				return;
+
+		float fvalue = map_.get_heuristic(successor_id) + (double) path_cost;
+
+		if (output_buffer_size_ < (int) fvalue)
+			return;
+
+		++nodes_expanded_;
+
+		MapNode *p_successor;
+		if (search_success)
+			p_successor = open_list_.data(successor_id);
+		else
+		{
+			p_successor = node_pool_.allocate();
+			p_successor->id_ = successor_id;
+		}
+		p_successor->p_predecessor_ = predecessor;
+		p_successor->path_cost_ = path_cost;
+		p_successor->fvalue_ = fvalue;
+
+		if (search_success)
+			open_list_.change_key_by_id(successor_id, fvalue);
+		else
+			open_list_.insert(successor_id, fvalue, p_successor);
+		return;
+	}
+
+
+	/** \brief Reconstructs the shortest path found by JumpPointSearch::FindPath() and writes it to Buffer p_output_buffer
+	 *
+	 *  \details Consecutive jump points lie on a common row or column;
+	 *  all nodes between them are written to the buffer (starting node excluded).
+	 *
+	 *  \param[in] target The final node on the path.
+	 *  \return Length of the path from to arrive at target node
+	 */
+	int JumpPointSearch::BacktrackPath(MapNode *target) const
+	{
+		int index = target->path_cost_;
+		MapNode *current = target;
+		while (current->p_predecessor_ != 0L)
+		{
+			int id = current->id_;
+			int id_from = current->p_predecessor_->id_;
+			int step = (map_.get_y(id) == map_.get_y(id_from)) ? 1 : map_.width_;
+			if (id < id_from)
+				step = -step;
+			for (; id != id_from; id -= step)
+				p_output_buffer_[--index] = id;
+			current = current->p_predecessor_;
+		}
+		return target->path_cost_;
+	}
+
+
+	/** \brief Jump Point Searchs main-loop: Finds the shortest path between a start- and target-position
+	 *
+	 *  \param[in] iS x-coordinate of the starting position
+	 *  \param[in] jS y-coordinate of the starting position
+	 *  \param[in] iT x-coordinate of the target position
+	 *  \param[in] jT y-coordinate of the target position
+	 *  \return length of the shortest path (or -1 if no path exists)
+	 */
+	int JumpPointSearch::FindPath(const int &iS, const int &jS, const int &iT, const int &jT)
+	{
+		int path_length = -1; // will be set to actual length if path exists
+
+		if (!map_.is_reachable(map_.get_id(iS,jS), map_.get_id(iT,jT)))
+			return path_length;
+
+		MapNode *p_start_node = node_pool_.allocate();
+		p_start_node->id_ = map_.get_id(iS,jS);
+
+		unsigned int target_node_id = map_.get_id(iT,jT);
+		x_target_ = iT;
+		y_target_ = jT;
+
+		map_.set_heuristic(iT,jT);
+		open_list_.insert(p_start_node->id_, p_start_node->fvalue_, p_start_node);
+
+		while (!open_list_.is_empty())
+		{
+			// move current node from open- to closed list
+			MapNode *p_current_node = open_list_.pop(0);
+			closed_list_.insert(p_current_node->id_, p_current_node );
+
+			// check if target reached
+			if (p_current_node->id_ == target_node_id)
+			{
+				path_length = BacktrackPath(p_current_node);
+				break;
+			}
+
+			IdentifySuccessors(p_current_node);
+		}
+
+		ClearLists(); // release nodes taken from node_pool_
+		return path_length;
+	}
+
+
+	/** \brief Empties both lists and releases all nodes generated by the search
+	 *  \detail see AStar::ClearLists()
+	 */
+	void JumpPointSearch::ClearLists()
+	{
+		open_list_.clear();
+		closed_list_.clear();
+		node_pool_.reset();
+		return;
+	}
+
+} // END OF NAMESPACE jps
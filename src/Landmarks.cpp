@@ -0,0 +1,167 @@
+/** \file
+ * 		Landmarks.cpp
+ *
+ *  \brief
+ *  	Landmark based heuristic for informed pathfinders (ALT / differential heuristic)
+ *
+ *	\details
+ *		Contains definitions to accompanying header Landmarks.hpp
+ *		and the registry of landmarks for maps passed by their data pointer.
+ */
+
+#include <algorithm>  // std::min
+#include "Landmarks.hpp"
+#include "Registry.hpp"         // registered landmarks
+#include "ComponentLabels.hpp"  // largest component of the map
+
+namespace o_graph
+{
+
+	const int Landmarks::unreached_;
+
+
+	/** \brief Constructor (selects the landmarks and computes their distance tables)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 *  \param[in] n_landmarks requested number of landmarks
+	 */
+	Landmarks::Landmarks(const int &width, const int &height, const unsigned char *data,
+			const unsigned int &n_landmarks) :
+			width_(width), height_(height), n_landmarks_(0), max_distance_(0)
+	{
+		// size of the largest component
+		ComponentLabels components(width_, height_, data);
+		std::vector<unsigned int> size(components.n_components_, 0);
+		for (int id=0; id<width_*height_; ++id)
+			if (components.label(id) != ComponentLabels::blocked_)
+				++size[components.label(id)];
+		int largest = -1;
+		for (int c=0; c<components.n_components_; ++c)
+			if ( (largest < 0) || (size[c] > size[largest]) )
+				largest = c;
+		if (largest < 0)
+			return;
+
+		n_landmarks_ = std::min(n_landmarks, size[largest]);
+		distances_.assign(width_*height_*n_landmarks_, unreached_);
+
+		// farthest point selection, starting at an arbitrary grid point of the largest component
+		std::vector<int> distances;
+		std::vector<int> min_distance(width_*height_, unreached_);
+		unsigned int candidate = 0;
+		while (components.label(candidate) != largest)
+			++candidate;
+		Distances(data, candidate, distances);
+		for (int id=0; id<width_*height_; ++id)
+			if (distances[id] > distances[candidate])
+				candidate = id;
+
+		for (unsigned int l=0; l<n_landmarks_; ++l)
+		{
+			ids_.push_back(candidate);
+			Distances(data, candidate, distances);
+			for (int id=0; id<width_*height_; ++id)
+			{
+				if (distances[id] == unreached_)
+					continue;
+				distances_[id*n_landmarks_ + l] = distances[id];
+				if (distances[id] > max_distance_)
+					max_distance_ = distances[id];
+				if ( (min_distance[id] == unreached_) || (distances[id] < min_distance[id]) )
+					min_distance[id] = distances[id];
+			}
+			for (int id=0; id<width_*height_; ++id)
+				if (min_distance[id] > min_distance[candidate])
+					candidate = id;
+		}
+	}
+
+
+	/** \brief breadth first search from a grid point
+	 *  \param[in] data grid data of the map
+	 *  \param[in] landmark The grid point to start from
+	 *  \param[out] distances distance of every grid point to landmark (unreached_ if not connected)
+	 */
+	void Landmarks::Distances(const unsigned char *data, const unsigned int &landmark,
+			std::vector<int> &distances) const
+	{
+		distances.assign(width_*height_, unreached_);
+		std::vector<unsigned int> queue(1, landmark);
+		distances[landmark] = 0;
+		for (std::size_t head=0; head<queue.size(); ++head)
+		{
+			const unsigned int id = queue[head];
+			const int x = id % width_;
+			const int y = id / width_;
+			const unsigned int neighbours[4] = {id-1, id+1, id-width_, id+width_};
+			const bool inside[4] = {x > 0, x+1 < width_, y > 0, y+1 < height_};
+			for (int k=0; k<4; ++k)
+				if ( inside[k] && (data[neighbours[k]] == 1) && (distances[neighbours[k]] == unreached_) )
+				{
+					distances[neighbours[k]] = distances[id] + 1;
+					queue.push_back(neighbours[k]);
+				}
+		}
+		return;
+	}
+
+
+	/** \brief memory used by the landmarks
+	 *  \return size of all tables in bytes
+	 */
+	std::size_t Landmarks::get_memory_footprint() const
+	{
+		return sizeof(Landmarks)
+				+ ids_.capacity()*sizeof(unsigned int)
+				+ distances_.capacity()*sizeof(int);
+	}
+
+
+
+	static o_data_structures::Registry<Landmarks> registry;  //< landmarks of all registered maps
+
+
+	/** \brief Selects landmarks of a map and registers them for pathfinders
+	 *
+	 *  \details Pathfinders using heuristic_landmarks look up the landmarks by the data
+	 *  pointer of the map (see FindLandmarks(..)). Registering a map again replaces its landmarks.
+	 *
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] n_landmarks number of landmarks (memory: 4 bytes per landmark and grid point)
+	 *  \return the landmarks
+	 *
+	 *  \note Landmarks must be registered again if the map data changes.
+	 */
+	std::shared_ptr<const Landmarks> RegisterLandmarks(const unsigned char *data, const int &width, const int &height,
+			const unsigned int &n_landmarks)
+	{
+		return registry.Register(data, std::make_shared<const Landmarks>(width, height, data, n_landmarks));
+	}
+
+
+	/** \brief Removes the landmarks of a map from the registry
+	 *  \param[in] data grid data of the map
+	 *  \note Pathfinders that use them keep them alive until they are done.
+	 */
+	void UnregisterLandmarks(const unsigned char *data)
+	{
+		registry.Unregister(data);
+		return;
+	}
+
+
+	/** \brief Looks up the registered landmarks of a map
+	 *  \param[in] data grid data of the map
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return landmarks of the map; empty if none are registered for this data and extent
+	 */
+	std::shared_ptr<const Landmarks> FindLandmarks(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Find(data, width, height);
+	}
+
+} // END OF NAMESPACE o_graph
@@ -17,7 +17,8 @@
  */
 
 
-#include "Map.hpp"  // accompanying header
+#include <algorithm>  // std::max
+#include "Map.hpp"    // accompanying header
 
 namespace o_graph
 {
@@ -27,7 +28,7 @@ namespace o_graph
 
 
 	//! \brief unaccessible constructor (made private)
-	Map::Map() : width_(0), height_(0), data_(0L),
+	Map::Map() : width_(0), height_(0), data_(0L), p_components_(), p_masks_(), p_landmarks_(),
 			x0_(0), y0_(0), max_manhattan_(.0)
 	{
 		// noting to do here
@@ -36,16 +37,22 @@ namespace o_graph
 
 	//! \brief Copy constructor (designed to work with LoadMap(..))
 	Map::Map(const Map &map) :
-			width_(map.width_), height_(map.height_), data_(map.data_),
+			width_(map.width_), height_(map.height_), data_(map.data_), p_components_(map.p_components_),
+			p_masks_(map.p_masks_), p_landmarks_(map.p_landmarks_),
 			x0_(0), y0_(0), max_manhattan_(height_ + width_ - 2)
 	{
 		// noting to do here
 	}
 
 
-	//! \brief Constructor (designed to work with Paradoxs interface)
+	/** \brief Constructor (designed to work with Paradoxs interface)
+	 *  \detail Uses the connected components and neighbour masks registered for data (if any);
+	 *  landmarks are set by the pathfinder that selects heuristic_landmarks
+	 */
 	Map::Map(const int &width, const int &height, const unsigned char *data) :
-		height_(height), width_(width), data_(data),
+		width_(width), height_(height), data_(data),
+		p_components_(FindComponents(data, width, height)),
+		p_masks_(FindNeighbourMasks(data, width, height)), p_landmarks_(),
 		x0_(0), y0_(0), max_manhattan_(height_ + width_ - 2)
 	{
 		// noting to do here
@@ -58,6 +65,8 @@ namespace o_graph
 	 *  - The ids are pused into Map::neighbour_list_
 	 *  - The backward node (nodes predecessor) isn't
 	 *    pushed to the list
+	 *  - Pathfinders that expand many nodes should iterate the neighbour
+	 *    mask directly (see get_neighbour_mask(..) and AStar::ExpandNode(..))
 	 *
 	 *  \param[in] node Pointer to node that is to be expanded
 	 *  by the pathfinder class
@@ -69,25 +78,14 @@ namespace o_graph
 		if ( node->p_predecessor_ != 0L )
 			prev_id = node->p_predecessor_->id_;
 
-		unsigned int id = node->id_;
-		int x = get_x(id);
-		int y = get_y(id);
-
-		if( ((x+1) < width_) && (data_[id+1]==terrain_traversable_)
-				&& ( ( id + 1 ) != prev_id ) )
-			neighbour_list_.push(id + 1);
-
-		if( ((x-1) >= 0) && (data_[id-1]==terrain_traversable_)
-				&& ( ( id - 1 ) != prev_id ) )
-			neighbour_list_.push(id - 1);
-
-		if( ((y+1) < height_) && (data_[id+width_]==terrain_traversable_)
-				&& ( ( id + width_ ) != prev_id ) )
-			neighbour_list_.push(id+width_);
-
-		if( ((y-1) >= 0) && (data_[id-width_]==terrain_traversable_)
-				&& ( ( id - width_ ) != prev_id ) )
-			neighbour_list_.push(id-width_);
+		const unsigned int id = node->id_;
+		const unsigned int mask = get_neighbour_mask(id);
+		for (unsigned int i=0; i<NeighbourMasks::n_moves_[mask]; ++i)
+		{
+			const unsigned int neighbour = get_neighbour(id, NeighbourMasks::moves_[mask][i]);
+			if (neighbour != prev_id)
+				neighbour_list_.push(neighbour);
+		}
 
 		return;
 	}
@@ -117,6 +115,11 @@ namespace o_graph
 	 */
 	double Map::get_heuristic(const unsigned int &id) const
 	{
+		if (p_landmarks_)
+		{
+			float max_distance = std::max(max_manhattan_, (float) p_landmarks_->max_distance_);
+			return get_distance_bound(id)*(1. + 1./(max_distance+1.));
+		}
 		int dx = get_x(id) - x0_;
 		int dy = get_y(id) - y0_;
 		float manhattan = (float) (abs(dx) + abs(dy));
@@ -124,6 +127,33 @@ namespace o_graph
 	}
 
 
+	/** \brief Calculates the (unmodified) manhattan distance to the reference point
+	 *  \detail Integer version of the heuristic (without tie breaking deviation)
+	 *  for open lists that need integer keys (see BucketQueue.hpp)
+	 *  \param[in] id The id of the node to calculate the distance for
+	 *  \return manhattan distance between node and reference point (set by set_heuristic(..))
+	 */
+	int Map::get_manhattan(const unsigned int &id) const
+	{
+		return abs(get_x(id) - x0_) + abs(get_y(id) - y0_);
+	}
+
+
+	/** \brief Calculates a lower bound of the distance to the reference point
+	 *  \detail Integer version of the heuristic: manhattan distance or, if landmarks
+	 *  are set, the larger of manhattan distance and landmark bound
+	 *  \param[in] id The id of the node to calculate the bound for
+	 *  \return lower bound of the path length between node and reference point
+	 */
+	int Map::get_distance_bound(const unsigned int &id) const
+	{
+		int bound = get_manhattan(id);
+		if (p_landmarks_)
+			bound = std::max(bound, p_landmarks_->get_bound(id, get_id(x0_, y0_)));
+		return bound;
+	}
+
+
 	/** \brief Loads a map from a data file
 	 *
 	 *  \detail The map data is organized in its header data (width & height),
@@ -183,8 +213,10 @@ namespace o_graph
 		do // handle map bulk data
 		{
 			getline(MapStream,line);
-			for(std::size_t collumn=0; collumn < line.size(); ++collumn)
+			for(std::size_t collumn=0; (collumn < line.size()) && (iter < size); ++collumn)
 			{
+				if(line[collumn] == '\r') // map files with windows line endings
+					continue;
 
 				switch (line[collumn])
 				{
@@ -0,0 +1,179 @@
+/** \file
+ * 		NeighbourMasks.cpp
+ *
+ *  \brief
+ *  	Traversable neighbours of all grid points of a game map (class NeighbourMasks)
+ *
+ *	\details
+ *		Contains definitions to accompanying header NeighbourMasks.hpp
+ *		and the registry of masks for maps passed by their data pointer.
+ */
+
+#include <cstring>  // std::memcpy, std::memset
+#include "NeighbourMasks.hpp"
+#include "Registry.hpp"  // registered masks
+
+namespace o_graph
+{
+
+	const unsigned char NeighbourMasks::n_moves_[16] = {0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+
+	const unsigned char NeighbourMasks::moves_[16][4] = {
+			{0, 0, 0, 0}, {0, 0, 0, 0}, {1, 0, 0, 0}, {0, 1, 0, 0},
+			{2, 0, 0, 0}, {0, 2, 0, 0}, {1, 2, 0, 0}, {0, 1, 2, 0},
+			{3, 0, 0, 0}, {0, 3, 0, 0}, {1, 3, 0, 0}, {0, 1, 3, 0},
+			{2, 3, 0, 0}, {0, 2, 3, 0}, {1, 2, 3, 0}, {0, 1, 2, 3}};
+
+
+	/** \brief 8 bytes of grid data as flags
+	 *  \details exact zero byte test: the high bit of a byte is set iff the byte is 0
+	 *  \param[in] word 8 bytes of grid data
+	 *  \return 1 in every byte that was traversable (== 1), 0 in all others
+	 */
+	inline unsigned long long TraversableBytes(const unsigned long long &word)
+	{
+		const unsigned long long low_bits = 0x7F7F7F7F7F7F7F7FULL;
+		const unsigned long long difference = word ^ 0x0101010101010101ULL;
+		const unsigned long long zero = ~(((difference & low_bits) + low_bits) | difference | low_bits);
+		return zero >> 7;
+	}
+
+
+	/** \brief Turns a row of grid data into flags (see TraversableBytes(..))
+	 *  \param[in] row grid data of the row
+	 *  \param[in] width width of the map
+	 *  \param[out] flags flags of the row (whole words: bytes beyond width are 0)
+	 */
+	inline void RowFlags(const unsigned char *row, const int &width, unsigned char *flags)
+	{
+		for (int x=0; x<width; x+=8)
+		{
+			unsigned long long word = 0;
+			std::memcpy(&word, row + x, (x+8 <= width) ? 8 : width-x);
+			word = TraversableBytes(word);
+			std::memcpy(flags + x, &word, 8);
+		}
+		return;
+	}
+
+
+	/** \brief Constructor (computes the masks)
+	 *
+	 *  \details Every row is turned into flags (1: traversable) with a border of 0 on
+	 *  both sides. The mask of 8 grid points is then assembled from 4 unaligned words of
+	 *  the flags of the previous, current and next row: flags are 0 or 1, so shifting
+	 *  them within their byte never carries into the next grid point. Bytes beyond
+	 *  the width of a row are read as 0 (blocked).
+	 *
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 */
+	NeighbourMasks::NeighbourMasks(const int &width, const int &height, const unsigned char *data) :
+			width_(width), height_(height), masks_(width*height, 0)
+	{
+		const int n_words = (width_ + 7) / 8;
+		const int pitch = 8*n_words + 16;  // border of 8 bytes on both sides
+		std::vector<unsigned char> flags(3*pitch, 0);
+		std::vector<unsigned char> row_masks(8*n_words);
+		unsigned char *previous = &flags[0];
+		unsigned char *current = &flags[pitch];
+		unsigned char *next = &flags[2*pitch];
+
+		// flags of row y are at current[8 .. 8+width_-1]
+		if (height_ > 0)
+			RowFlags(data, width_, next + 8);
+		for (int y=0; y<height_; ++y)
+		{
+			unsigned char *oldest = previous;
+			previous = current;
+			current = next;
+			next = oldest;
+			std::memset(next, 0, pitch);
+			if (y+1 < height_)
+				RowFlags(data + (y+1)*width_, width_, next + 8);
+			for (int x=0; x<width_; x+=8)
+			{
+				unsigned long long right, left, down, up;
+				std::memcpy(&right, current + 9 + x, 8);
+				std::memcpy(&left, current + 7 + x, 8);
+				std::memcpy(&down, next + 8 + x, 8);
+				std::memcpy(&up, previous + 8 + x, 8);
+				const unsigned long long mask = right | (left << 1) | (down << 2) | (up << 3);
+				std::memcpy(&row_masks[x], &mask, 8);
+			}
+			std::memcpy(&masks_[y*width_], &row_masks[0], width_);
+		}
+	}
+
+
+	/** \brief Computes the mask of a single grid point (without precomputed masks)
+	 *  \param[in] id The id of the grid point
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 *  \return the mask (see NeighbourMasks)
+	 */
+	unsigned int NeighbourMasks::ComputeMask(const unsigned int &id, const int &width, const int &height,
+			const unsigned char *data)
+	{
+		const int x = id % width;
+		const int y = id / width;
+		unsigned int mask = 0;
+		if (((x+1) < width) && (data[id+1] == 1))
+			mask |= 1u;
+		if (((x-1) >= 0) && (data[id-1] == 1))
+			mask |= 2u;
+		if (((y+1) < height) && (data[id+width] == 1))
+			mask |= 4u;
+		if (((y-1) >= 0) && (data[id-width] == 1))
+			mask |= 8u;
+		return mask;
+	}
+
+
+
+	static o_data_structures::Registry<NeighbourMasks> registry;  //< masks of all registered maps
+
+
+	/** \brief Computes the masks of a map and registers them for pathfinders
+	 *
+	 *  \details Pathfinders look up the masks by the data pointer of the map
+	 *  (see FindNeighbourMasks(..)). Registering a map again replaces its masks.
+	 *
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return the masks
+	 *
+	 *  \note Masks must be registered again if the map data changes.
+	 */
+	std::shared_ptr<const NeighbourMasks> RegisterNeighbourMasks(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Register(data, std::make_shared<const NeighbourMasks>(width, height, data));
+	}
+
+
+	/** \brief Removes the masks of a map from the registry
+	 *  \param[in] data grid data of the map
+	 *  \note Pathfinders that use them keep them alive until they are done.
+	 */
+	void UnregisterNeighbourMasks(const unsigned char *data)
+	{
+		registry.Unregister(data);
+		return;
+	}
+
+
+	/** \brief Looks up the registered masks of a map
+	 *  \param[in] data grid data of the map
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return masks of the map; empty if no masks of a map with this data and extent are registered
+	 */
+	std::shared_ptr<const NeighbourMasks> FindNeighbourMasks(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Find(data, width, height);
+	}
+
+} // END OF NAMESPACE o_graph
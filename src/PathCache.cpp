@@ -0,0 +1,489 @@
+/** \file
+ * 		PathCache.cpp
+ *
+ * 	\brief
+ *		Cache of shortest paths in front of astar::FindPath(..)
+ *
+ * 	\details
+ * 		Contains definitions to accompnying header PathCache.hpp
+ * 		This file is part of project pdx_pathfinding
+ */
+
+#include "PathCache.hpp"
+#include <algorithm>  // std::sort, std::binary_search, std::fill
+#include "AStar.hpp"  // paths not in the cache
+
+namespace pathcache
+{
+
+	const int PathCache::miss_;
+	const int PathCache::no_entry_;
+	const unsigned int PathCache::empty_slot_;
+
+
+	PathCache &SharedPathCache()
+	{
+		static PathCache cache(1 << 16);
+		return cache;
+	}
+
+
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize)
+	{
+		unsigned int nodes_expanded;
+		return FindPath(nStartX, nStartY, nTargetX, nTargetY,
+				pMap, nMapWidth, nMapHeight, pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		PathCache &cache = SharedPathCache();
+		const unsigned int start = nStartX + nStartY*nMapWidth;
+		const unsigned int target = nTargetX + nTargetY*nMapWidth;
+
+		nodes_expanded = 0;
+		int path_length = cache.Lookup(pMap, nMapWidth, nMapHeight, start, target, pOutBuffer, nOutBufferSize);
+		if (path_length != PathCache::miss_)
+			return path_length;
+
+		path_length = astar::FindPath(nStartX, nStartY, nTargetX, nTargetY,
+				pMap, nMapWidth, nMapHeight, pOutBuffer, nOutBufferSize, nodes_expanded);
+		if (path_length > 0)
+			cache.Insert(pMap, nMapWidth, nMapHeight, start, pOutBuffer, path_length);
+		return path_length;
+	}
+
+
+	/** \brief Constructor
+	 *  \param[in] capacity maximum number of grid points on all cached paths
+	 */
+	PathCache::PathCache(const std::size_t &capacity) :
+		capacity_(capacity), n_cells_(0), newest_(no_entry_), oldest_(no_entry_),
+		next_map_handle_(0), hits_(0), misses_(0), evictions_(0)
+	{
+		Rehash();
+	}
+
+
+	/** \brief Looks up a path in the cache
+	 *
+	 *  \param[in] data grid data of the map (only used as key)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] start first grid point of the path
+	 *  \param[in] target last grid point of the path
+	 *  \param[out] pOutBuffer buffer for the path (excluding start)
+	 *  \param[in] nOutBufferSize length of pOutBuffer
+	 *
+	 *  \return length of the path; -1 if it is longer than nOutBufferSize (nothing written);
+	 *  miss_ if no cached path contains start and target
+	 */
+	int PathCache::Lookup(const unsigned char *data, const int &width, const int &height,
+			const unsigned int &start, const unsigned int &target,
+			int *pOutBuffer, const int &nOutBufferSize)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		unsigned int map_handle;
+		Occurrence from, to;
+		if (!FindHandle(data, width, height, map_handle)
+				|| !FindOccurrences(map_handle, start, target, from, to))
+		{
+			++misses_;
+			return miss_;
+		}
+
+		++hits_;
+		Touch(from.entry_);
+		int path_length = (from.position_ < to.position_) ?
+				to.position_ - from.position_ : from.position_ - to.position_;
+		if (path_length > nOutBufferSize)
+			return -1;
+		return Decode(from, to, pOutBuffer);
+	}
+
+
+	/** \brief Puts a path into the cache (least recently used paths are evicted if needed)
+	 *
+	 *  \details Paths already answered by the cache and paths longer than the
+	 *  capacity aren't stored.
+	 *
+	 *  \param[in] data grid data of the map (only used as key)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] start first grid point of the path
+	 *  \param[in] path grid points after start (as written by FindPath(..))
+	 *  \param[in] length number of grid points in path
+	 */
+	void PathCache::Insert(const unsigned char *data, const int &width, const int &height,
+			const unsigned int &start, const int *path, const int &length)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+
+		if ((length <= 0) || ((std::size_t) length + 1 > capacity_))
+			return;
+
+		unsigned int map_handle;
+		if (!FindHandle(data, width, height, map_handle))
+		{
+			MapVersion version = {width, height, next_map_handle_++, 0};
+			versions_[data] = version;
+			map_handle = version.map_handle_;
+		}
+		Occurrence from, to;
+		if (FindOccurrences(map_handle, start, path[length-1], from, to))
+			return;
+		++versions_[data].n_paths_;  // before evictions: keeps the version of this map
+
+		while (n_cells_ + length + 1 > capacity_)
+			EvictOldest();
+
+		unsigned int entry;
+		if (free_entries_.empty())
+		{
+			entry = entries_.size();
+			entries_.push_back(Entry());
+		}
+		else
+		{
+			entry = free_entries_.back();
+			free_entries_.pop_back();
+		}
+
+		Entry &e = entries_[entry];
+		e.data_ = data;
+		e.map_handle_ = map_handle;
+		e.start_ = start;
+		e.width_ = width;
+		e.length_ = length;
+		e.moves_.assign((length + 3) >> 2, 0);
+		e.newer_ = e.older_ = no_entry_;
+
+		IndexInsert(map_handle, start, entry);
+		unsigned int previous = start;
+		for (int i = 0; i < length; ++i)
+		{
+			const unsigned int id = path[i];
+			unsigned char move;
+			if (id == previous + 1)
+				move = 0;
+			else if (id + 1 == previous)
+				move = 1;
+			else if (id > previous)
+				move = 2;
+			else
+				move = 3;
+			e.moves_[i >> 2] |= move << ((i & 3) << 1);
+			IndexInsert(map_handle, id, entry);
+			previous = id;
+		}
+		n_cells_ += length + 1;
+		Touch(entry);
+		return;
+	}
+
+
+	/** \brief Starts a new version of a map (to be called after its data changed)
+	 *  \details O(1): the map is forgotten, the next path inserted for it starts a new
+	 *  version. Paths of the old version stay until they are evicted.
+	 *  \param[in] data grid data of the map
+	 */
+	void PathCache::InvalidateMap(const unsigned char *data)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		versions_.erase(data);
+		return;
+	}
+
+
+	//! \brief Removes all paths (counters are kept)
+	void PathCache::Clear()
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		entries_.clear();
+		free_entries_.clear();
+		Slot empty = {0, empty_slot_};
+		std::fill(index_.begin(), index_.end(), empty);
+		versions_.clear();
+		n_cells_ = 0;
+		newest_ = oldest_ = no_entry_;
+		return;
+	}
+
+
+	/** \brief Changes the capacity (least recently used paths are evicted if needed)
+	 *  \param[in] capacity maximum number of grid points on all cached paths
+	 */
+	void PathCache::set_capacity(const std::size_t &capacity)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		capacity_ = capacity;
+		while (n_cells_ > capacity_)
+			EvictOldest();
+		Rehash();
+		return;
+	}
+
+
+	//! \brief counters and size of the cache
+	PathCacheStatistics PathCache::get_statistics() const
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		PathCacheStatistics statistics;
+		statistics.hits_ = hits_;
+		statistics.misses_ = misses_;
+		statistics.evictions_ = evictions_;
+		statistics.n_paths_ = entries_.size() - free_entries_.size();
+		statistics.n_cells_ = n_cells_;
+		statistics.n_maps_ = versions_.size();
+		return statistics;
+	}
+
+
+	/** \brief Finds the handle of the current version of a map
+	 *  \param[in] data grid data of the map
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[out] map_handle the handle
+	 *  \return false if there is no version of this map (with this size)
+	 */
+	bool PathCache::FindHandle(const unsigned char *data, const int &width, const int &height,
+			unsigned int &map_handle) const
+	{
+		std::unordered_map<const unsigned char*, MapVersion>::const_iterator it = versions_.find(data);
+		if ((it == versions_.end()) || (it->second.width_ != width) || (it->second.height_ != height))
+			return false;
+		map_handle = it->second.map_handle_;
+		return true;
+	}
+
+
+	/** \brief Finds a cached path through start and target
+	 *
+	 *  \details The paths through start are sorted; every path through target
+	 *  is looked up by binary search. The positions of start and target are
+	 *  found by walking the path.
+	 *
+	 *  \param[in] map_handle map and version
+	 *  \param[in] start first grid point
+	 *  \param[in] target last grid point
+	 *  \param[out] from occurrence of start on the path found
+	 *  \param[out] to occurrence of target on the same path
+	 *  \return false if no cached path contains both
+	 */
+	bool PathCache::FindOccurrences(const unsigned int &map_handle, const unsigned int &start,
+			const unsigned int &target, Occurrence &from, Occurrence &to)
+	{
+		const std::size_t mask = index_.size() - 1;
+		candidates_.clear();
+		for (std::size_t i = get_home(map_handle, start); index_[i].entry_ != empty_slot_; i = (i + 1) & mask)
+			if ((index_[i].id_ == start) && (entries_[index_[i].entry_].map_handle_ == map_handle))
+				candidates_.push_back(index_[i].entry_);
+		if (candidates_.empty())
+			return false;
+		std::sort(candidates_.begin(), candidates_.end());
+
+		for (std::size_t i = get_home(map_handle, target); index_[i].entry_ != empty_slot_; i = (i + 1) & mask)
+		{
+			const unsigned int entry = index_[i].entry_;
+			if ( (index_[i].id_ != target) || (entries_[entry].map_handle_ != map_handle)
+					|| !std::binary_search(candidates_.begin(), candidates_.end(), entry) )
+				continue;
+
+			// positions on the path (a shortest path visits every grid point once)
+			const Entry &e = entries_[entry];
+			const int offset[4] = {1, -1, e.width_, -e.width_};
+			from.entry_ = to.entry_ = entry;
+			unsigned int id = e.start_;
+			for (int p = 0; p <= e.length_; ++p)
+			{
+				if (id == start)
+					from.position_ = p;
+				if (id == target)
+					to.position_ = p;
+				if (p < e.length_)
+					id += offset[(e.moves_[p >> 2] >> ((p & 3) << 1)) & 3];
+			}
+			return true;
+		}
+		return false;
+	}
+
+
+	/** \brief Writes the part of a cached path between two of its grid points to a buffer
+	 *  \details Walks the moves forward or (undoing them) backward.
+	 *  \param[in] from occurrence of the first grid point (not written)
+	 *  \param[in] to occurrence of the last grid point (on the same path)
+	 *  \param[out] pOutBuffer buffer of at least |to.position_ - from.position_| grid points
+	 *  \return number of grid points written
+	 */
+	int PathCache::Decode(const Occurrence &from, const Occurrence &to, int *pOutBuffer) const
+	{
+		const Entry &e = entries_[from.entry_];
+		const int offset[4] = {1, -1, e.width_, -e.width_};
+
+		int id = e.start_;
+		for (unsigned int i = 0; i < from.position_; ++i)
+			id += offset[(e.moves_[i >> 2] >> ((i & 3) << 1)) & 3];
+
+		int n = 0;
+		if (from.position_ < to.position_)
+			for (unsigned int i = from.position_; i < to.position_; ++i)
+			{
+				id += offset[(e.moves_[i >> 2] >> ((i & 3) << 1)) & 3];
+				pOutBuffer[n++] = id;
+			}
+		else
+			for (unsigned int i = from.position_; i > to.position_; --i)
+			{
+				id -= offset[(e.moves_[(i-1) >> 2] >> (((i-1) & 3) << 1)) & 3];
+				pOutBuffer[n++] = id;
+			}
+		return n;
+	}
+
+
+	//! \brief Makes a path the most recently used one
+	void PathCache::Touch(const int &entry)
+	{
+		if (newest_ == entry)
+			return;
+		if (entries_[entry].newer_ != no_entry_) // on the list, but not the newest
+			Unlink(entry);
+
+		entries_[entry].older_ = newest_;
+		entries_[entry].newer_ = no_entry_;
+		if (newest_ != no_entry_)
+			entries_[newest_].newer_ = entry;
+		newest_ = entry;
+		if (oldest_ == no_entry_)
+			oldest_ = entry;
+		return;
+	}
+
+
+	//! \brief Removes a path from the LRU list
+	void PathCache::Unlink(const int &entry)
+	{
+		Entry &e = entries_[entry];
+		if (e.newer_ != no_entry_)
+			entries_[e.newer_].older_ = e.older_;
+		else
+			newest_ = e.older_;
+		if (e.older_ != no_entry_)
+			entries_[e.older_].newer_ = e.newer_;
+		else
+			oldest_ = e.newer_;
+		e.newer_ = e.older_ = no_entry_;
+		return;
+	}
+
+
+	//! \brief Removes the least recently used path and its grid points from the index
+	void PathCache::EvictOldest()
+	{
+		const int entry = oldest_;
+		Entry &e = entries_[entry];
+		Unlink(entry);
+
+		const int offset[4] = {1, -1, e.width_, -e.width_};
+		unsigned int id = e.start_;
+		for (int i = 0; i <= e.length_; ++i)
+		{
+			IndexErase(e.map_handle_, id, entry);
+			if (i < e.length_)
+				id += offset[(e.moves_[i >> 2] >> ((i & 3) << 1)) & 3];
+		}
+
+		// a map without paths of its current version is forgotten
+		std::unordered_map<const unsigned char*, MapVersion>::iterator it = versions_.find(e.data_);
+		if ( (it != versions_.end()) && (it->second.map_handle_ == e.map_handle_) && (--it->second.n_paths_ == 0) )
+			versions_.erase(it);
+
+		n_cells_ -= e.length_ + 1;
+		std::vector<unsigned char>().swap(e.moves_);
+		free_entries_.push_back(entry);
+		++evictions_;
+		return;
+	}
+
+
+	/** \brief Adds a grid point of a path to the index
+	 *  \param[in] map_handle map and version of the path
+	 *  \param[in] id the grid point
+	 *  \param[in] entry the path
+	 */
+	void PathCache::IndexInsert(const unsigned int &map_handle, const unsigned int &id, const unsigned int &entry)
+	{
+		const std::size_t mask = index_.size() - 1;
+		std::size_t i = get_home(map_handle, id);
+		while (index_[i].entry_ != empty_slot_)
+			i = (i + 1) & mask;
+		index_[i].id_ = id;
+		index_[i].entry_ = entry;
+		return;
+	}
+
+
+	/** \brief Removes a grid point of a path from the index
+	 *
+	 *  \details Backward shift deletion: following slots of the probe sequence that
+	 *  may live in the freed slot are moved into it, so no tombstones are needed.
+	 *
+	 *  \param[in] map_handle map and version of the path
+	 *  \param[in] id the grid point (must be in the index)
+	 *  \param[in] entry the path
+	 */
+	void PathCache::IndexErase(const unsigned int &map_handle, const unsigned int &id, const unsigned int &entry)
+	{
+		const std::size_t mask = index_.size() - 1;
+		std::size_t i = get_home(map_handle, id);
+		while ((index_[i].id_ != id) || (index_[i].entry_ != entry))
+			i = (i + 1) & mask;
+
+		for (std::size_t j = (i + 1) & mask; index_[j].entry_ != empty_slot_; j = (j + 1) & mask)
+		{
+			const std::size_t home = get_home(entries_[index_[j].entry_].map_handle_, index_[j].id_);
+			if (((j - home) & mask) >= ((j - i) & mask))
+			{
+				index_[i] = index_[j];
+				i = j;
+			}
+		}
+		index_[i].entry_ = empty_slot_;
+		return;
+	}
+
+
+	//! \brief Resizes the index to at least twice the capacity and indexes all cached paths again
+	void PathCache::Rehash()
+	{
+		std::size_t n_slots = 16;
+		while (n_slots < 2*capacity_)
+			n_slots <<= 1;
+		Slot empty = {0, empty_slot_};
+		std::vector<Slot>(n_slots, empty).swap(index_);
+
+		for (int entry = oldest_; entry != no_entry_; entry = entries_[entry].newer_)
+		{
+			const Entry &e = entries_[entry];
+			const int offset[4] = {1, -1, e.width_, -e.width_};
+			unsigned int id = e.start_;
+			for (int i = 0; i <= e.length_; ++i)
+			{
+				IndexInsert(e.map_handle_, id, entry);
+				if (i < e.length_)
+					id += offset[(e.moves_[i >> 2] >> ((i & 3) << 1)) & 3];
+			}
+		}
+		return;
+	}
+
+} // END OF NAMESPACE pathcache
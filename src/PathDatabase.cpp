@@ -0,0 +1,492 @@
+/** \file
+ * 		PathDatabase.cpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities without search (compressed path database)
+ *
+ *	\details
+ *		Contains definitions to accompanying header PathDatabase.hpp
+ *		and the registry of path databases for maps passed by their data pointer.
+ *
+ *		File format (native byte order):
+ *		magic "PDXCPD2" (8 bytes), width, height (int32), checksum of the map (uint64),
+ *		n_nodes_, number of runs (uint32), checksum of first_run_ and runs_ (uint64),
+ *		first_run_ (n_nodes_+1 x uint32), runs_ (uint32).
+ */
+
+#include <algorithm>   // std::upper_bound
+#include <atomic>      // next source of the build threads
+#include <cstring>     // std::memcmp
+#include <fstream>     // persistence
+#include <thread>      // parallel build
+#include "PathDatabase.hpp"
+#include "Registry.hpp"  // registered databases
+#include "AStar.hpp"      // fallback without registered database
+
+namespace cpd
+{
+
+	static const char file_magic[8] = "PDXCPD2";  //< first bytes of a database file
+
+
+	/** \brief FNV-1a checksum of a map
+	 *  \param[in] map The map
+	 *  \return checksum of extent and grid data
+	 */
+	unsigned long long MapChecksum(const o_graph::Map &map)
+	{
+		unsigned long long checksum = 14695981039346656037ULL;
+		const int extent[2] = {map.width_, map.height_};
+		const unsigned char *bytes = reinterpret_cast<const unsigned char *>(extent);
+		for (std::size_t i=0; i<sizeof(extent); ++i)
+			checksum = (checksum ^ bytes[i]) * 1099511628211ULL;
+		for (int id=0; id<map.width_*map.height_; ++id)
+			checksum = (checksum ^ map.data_[id]) * 1099511628211ULL;
+		return checksum;
+	}
+
+
+	/** \brief FNV-1a checksum of an array of runs (file payload)
+	 *  \param[in] checksum checksum of the preceding arrays (offset basis for the first one)
+	 *  \param[in] values The array
+	 *  \return checksum of all arrays up to values
+	 */
+	unsigned long long RunsChecksum(unsigned long long checksum, const std::vector<unsigned int> &values)
+	{
+		for (std::size_t i=0; i<values.size(); ++i)
+			for (int b=0; b<32; b+=8)
+				checksum = (checksum ^ ((values[i] >> b) & 0xFF)) * 1099511628211ULL;
+		return checksum;
+	}
+
+
+	//! \brief checksum of first_run_ and runs_ (see file format)
+	unsigned long long PathDatabase::get_payload_checksum() const
+	{
+		return RunsChecksum(RunsChecksum(14695981039346656037ULL, first_run_), runs_);
+	}
+
+
+	/** \brief Checks that first_run_ and runs_ describe a database of the map
+	 *
+	 *  \details first_run_ has to be monotone from 0 to the number of runs. The runs of a
+	 *  source start at target 0, have ascending first targets below n_nodes_ and lead to
+	 *  traversable neighbours, so GetFirstMove(..) and GetPath(..) stay on the map.
+	 *
+	 *  \param[in] map The game map
+	 *  \return true if the arrays are consistent
+	 */
+	bool PathDatabase::IsConsistent(const o_graph::Map &map) const
+	{
+		if ( (first_run_.size() != n_nodes_+1) || (first_run_[0] != 0) || (first_run_[n_nodes_] != runs_.size()) )
+			return false;
+
+		for (int cell=0; cell<width_*height_; ++cell)
+		{
+			if (node_of_cell_[cell] < 0)
+				continue;
+			const unsigned int source = node_of_cell_[cell];
+			if (first_run_[source] > first_run_[source+1])
+				return false;
+			const int x = cell % width_;
+			const int y = cell / width_;
+			const bool valid[4] = {x > 0, x+1 < width_, y > 0, y+1 < height_};
+			for (unsigned int run=first_run_[source]; run<first_run_[source+1]; ++run)
+			{
+				const unsigned int target = runs_[run] >> 2;
+				const int move = runs_[run] & 3;
+				if ( (target >= n_nodes_) || ((run == first_run_[source]) ? (target != 0) : (target <= (runs_[run-1] >> 2)))
+						|| !valid[move] || (map.data_[get_neighbour(cell, move)] != o_graph::Map::terrain_traversable_) )
+					return false;
+			}
+		}
+		return true;
+	}
+
+
+	/** \brief Constructor (builds the database)
+	 *  \param[in] map The game map
+	 *  \param[in] n_threads number of build threads (0: one per hardware thread)
+	 */
+	PathDatabase::PathDatabase(const o_graph::Map &map, const unsigned int &n_threads) :
+			PathDatabase(map, true, n_threads)
+	{
+		// nothing to do here
+	}
+
+
+	/** \brief Constructor
+	 *  \param[in] map The game map
+	 *  \param[in] build false: runs are left empty (to be read by Load(..))
+	 *  \param[in] n_threads number of build threads (0: one per hardware thread)
+	 */
+	PathDatabase::PathDatabase(const o_graph::Map &map, const bool &build, const unsigned int &n_threads) :
+			width_(map.width_), height_(map.height_), map_checksum_(MapChecksum(map)), n_nodes_(0),
+			node_of_cell_(map.width_*map.height_, -1), components_(map.width_, map.height_, map.data_)
+	{
+		OrderNodes(map);
+		if (build)
+			Build(map, n_threads);
+	}
+
+
+	/** \brief Numbers the traversable grid points in depth first search order
+	 *  \param[in] map The game map
+	 */
+	void PathDatabase::OrderNodes(const o_graph::Map &map)
+	{
+		o_graph::Map neighbours(map);
+		o_graph::MapNode node;
+		std::vector<unsigned int> stack;
+
+		for (int root=0; root<width_*height_; ++root)
+		{
+			if ( (map.data_[root] != o_graph::Map::terrain_traversable_) || (node_of_cell_[root] >= 0) )
+				continue;
+			stack.push_back(root);
+			while (!stack.empty())
+			{
+				node.id_ = stack.back();
+				stack.pop_back();
+				if (node_of_cell_[node.id_] >= 0)
+					continue;
+				node_of_cell_[node.id_] = n_nodes_++;
+				neighbours.fill_neighbour_list(&node);
+				while (!neighbours.neighbour_list_.is_empty())
+				{
+					unsigned int id = neighbours.neighbour_list_.pop();
+					if (node_of_cell_[id] < 0)
+						stack.push_back(id);
+				}
+			}
+		}
+		return;
+	}
+
+
+	/** \brief Computes the runs of all sources (one breadth first search per source)
+	 *  \param[in] map The game map
+	 *  \param[in] n_threads number of build threads (0: one per hardware thread)
+	 */
+	void PathDatabase::Build(const o_graph::Map &map, unsigned int n_threads)
+	{
+		if (n_threads == 0)
+			n_threads = std::max(1u, std::thread::hardware_concurrency());
+
+		std::vector< std::vector<unsigned int> > source_runs(n_nodes_);
+		std::vector<unsigned int> cell_of_node(n_nodes_);
+		for (int id=0; id<width_*height_; ++id)
+			if (node_of_cell_[id] >= 0)
+				cell_of_node[node_of_cell_[id]] = id;
+
+		std::atomic<unsigned int> next_source(0);
+		struct Worker
+		{
+			static void Run(const PathDatabase *p_database, const o_graph::Map *p_map,
+					const std::vector<unsigned int> *p_cell_of_node, std::atomic<unsigned int> *p_next_source,
+					std::vector< std::vector<unsigned int> > *p_source_runs)
+			{
+				const PathDatabase &database = *p_database;
+				o_graph::Map map(*p_map);  // own neighbour list
+				o_graph::MapNode node;
+				std::vector<unsigned char> moves(database.n_nodes_, move_none);
+				std::vector<unsigned int> queue;
+
+				unsigned int source;
+				while ((source = (*p_next_source)++) < database.n_nodes_)
+				{
+					// breadth first search, every grid point inherits the first move of its parent
+					const unsigned int source_id = (*p_cell_of_node)[source];
+					queue.assign(1, source_id);
+					for (std::size_t head=0; head<queue.size(); ++head)
+					{
+						node.id_ = queue[head];
+						map.fill_neighbour_list(&node);
+						while (!map.neighbour_list_.is_empty())
+						{
+							unsigned int id = map.neighbour_list_.pop();
+							unsigned char &move = moves[database.node_of_cell_[id]];
+							if ( (move != move_none) || (id == source_id) )
+								continue;
+							if (head == 0)
+							{
+								int offset = id - source_id;
+								move = (offset == -1) ? move_left : (offset == 1) ? move_right
+										: (offset < 0) ? move_up : move_down;
+							}
+							else
+								move = moves[database.node_of_cell_[node.id_]];
+							queue.push_back(id);
+						}
+					}
+
+					// run length encoding in depth first order (move_none is don't care)
+					std::vector<unsigned int> &runs = (*p_source_runs)[source];
+					int current = move_none;
+					for (unsigned int target=0; target<database.n_nodes_; ++target)
+					{
+						if ( (moves[target] == move_none) || (moves[target] == current) )
+							continue;
+						current = moves[target];
+						runs.push_back( (runs.empty() ? 0 : (target << 2)) | current );
+					}
+					for (std::size_t i=0; i<queue.size(); ++i)
+						moves[database.node_of_cell_[queue[i]]] = move_none;
+				}
+				return;
+			}
+		};
+
+		std::vector<std::thread> threads;
+		for (unsigned int t=1; t<n_threads; ++t)
+			threads.push_back(std::thread(Worker::Run, this, &map, &cell_of_node, &next_source, &source_runs));
+		Worker::Run(this, &map, &cell_of_node, &next_source, &source_runs);
+		for (std::size_t t=0; t<threads.size(); ++t)
+			threads[t].join();
+
+		first_run_.assign(n_nodes_+1, 0);
+		for (unsigned int source=0; source<n_nodes_; ++source)
+			first_run_[source+1] = first_run_[source] + source_runs[source].size();
+		runs_.reserve(first_run_[n_nodes_]);
+		for (unsigned int source=0; source<n_nodes_; ++source)
+		{
+			runs_.insert(runs_.end(), source_runs[source].begin(), source_runs[source].end());
+			std::vector<unsigned int>().swap(source_runs[source]);
+		}
+		return;
+	}
+
+
+	/** \brief first move of a shortest path
+	 *  \param[in] start id of the start position
+	 *  \param[in] target id of the target position
+	 *  \return FirstMove towards target; move_none if start == target or no path exists
+	 */
+	int PathDatabase::GetFirstMove(const unsigned int &start, const unsigned int &target) const
+	{
+		if ( (start == target) || !components_.connected(start, target) )
+			return move_none;
+
+		const unsigned int key = (node_of_cell_[target] << 2) | 3;
+		const unsigned int source = node_of_cell_[start];
+		std::vector<unsigned int>::const_iterator run =
+				std::upper_bound(runs_.begin() + first_run_[source], runs_.begin() + first_run_[source+1], key);
+		return *(run-1) & 3;
+	}
+
+
+	/** \brief shortest path by repeated first move lookups
+	 *
+	 *  \param[in] start id of the start position
+	 *  \param[in] target id of the target position
+	 *  \param[out] pOutBuffer Buffer for the ids of the path (excluding start)
+	 *  \param[in] nOutBufferSize length of pOutBuffer (only the first nOutBufferSize
+	 *  grid points of longer paths are written)
+	 *  \return length of the path; -1 if no path exists
+	 */
+	int PathDatabase::GetPath(const unsigned int &start, const unsigned int &target,
+			int *pOutBuffer, const int &nOutBufferSize) const
+	{
+		if (!components_.connected(start, target))
+			return -1;
+
+		int length = 0;
+		for (unsigned int id=start; id!=target; ++length)
+		{
+			id = get_neighbour(id, GetFirstMove(id, target));
+			if (length < nOutBufferSize)
+				pOutBuffer[length] = id;
+		}
+		return length;
+	}
+
+
+	/** \brief memory used by the database
+	 *  \return size of all arrays in bytes
+	 */
+	std::size_t PathDatabase::get_memory_footprint() const
+	{
+		return sizeof(PathDatabase)
+				+ node_of_cell_.capacity()*sizeof(int)
+				+ first_run_.capacity()*sizeof(unsigned int)
+				+ runs_.capacity()*sizeof(unsigned int)
+				+ components_.labels_.capacity()*sizeof(int);
+	}
+
+
+	/** \brief Writes the database to a file (format see file documentation)
+	 *  \param[in] file_name Path of the file
+	 *  \return Error code: 0 on success; -1 otherwise
+	 */
+	int PathDatabase::Save(const std::string &file_name) const
+	{
+		std::ofstream stream(file_name.c_str(), std::ofstream::out | std::ofstream::binary);
+		if (!stream.good())
+			return -1;
+
+		const unsigned int n_runs = runs_.size();
+		const unsigned long long payload_checksum = get_payload_checksum();
+		stream.write(file_magic, sizeof(file_magic));
+		stream.write(reinterpret_cast<const char *>(&width_), sizeof(width_));
+		stream.write(reinterpret_cast<const char *>(&height_), sizeof(height_));
+		stream.write(reinterpret_cast<const char *>(&map_checksum_), sizeof(map_checksum_));
+		stream.write(reinterpret_cast<const char *>(&n_nodes_), sizeof(n_nodes_));
+		stream.write(reinterpret_cast<const char *>(&n_runs), sizeof(n_runs));
+		stream.write(reinterpret_cast<const char *>(&payload_checksum), sizeof(payload_checksum));
+		stream.write(reinterpret_cast<const char *>(&first_run_[0]), first_run_.size()*sizeof(unsigned int));
+		if (n_runs > 0)
+			stream.write(reinterpret_cast<const char *>(&runs_[0]), n_runs*sizeof(unsigned int));
+		return stream.good() ? 0 : -1;
+	}
+
+
+	/** \brief Reads a database from a file
+	 *
+	 *  \details Load(..) is a factory function: ownership of the database
+	 *  is transferred to caller. Files whose size doesn't match their header are
+	 *  rejected before anything is allocated; the payload has to match its checksum
+	 *  and to be consistent with the map (see IsConsistent(..)).
+	 *
+	 *  \param[in] file_name Path of the file
+	 *  \param[in] map The map the database is expected for
+	 *  \return the database; null pointer if the file can't be read or belongs to other map data
+	 */
+	PathDatabase *PathDatabase::Load(const std::string &file_name, const o_graph::Map &map)
+	{
+		std::ifstream stream(file_name.c_str(), std::ifstream::in | std::ifstream::binary);
+		if (!stream.good())
+			return 0L;
+
+		char magic[sizeof(file_magic)];
+		int width, height;
+		unsigned long long checksum, payload_checksum;
+		unsigned int n_nodes, n_runs;
+		stream.read(magic, sizeof(magic));
+		stream.read(reinterpret_cast<char *>(&width), sizeof(width));
+		stream.read(reinterpret_cast<char *>(&height), sizeof(height));
+		stream.read(reinterpret_cast<char *>(&checksum), sizeof(checksum));
+		stream.read(reinterpret_cast<char *>(&n_nodes), sizeof(n_nodes));
+		stream.read(reinterpret_cast<char *>(&n_runs), sizeof(n_runs));
+		stream.read(reinterpret_cast<char *>(&payload_checksum), sizeof(payload_checksum));
+		if ( !stream.good() || (std::memcmp(magic, file_magic, sizeof(file_magic)) != 0)
+				|| (width != map.width_) || (height != map.height_) || (checksum != MapChecksum(map)) )
+			return 0L;
+
+		// the rest of the file has to be exactly first_run_ and runs_
+		const std::streamoff payload_begin = stream.tellg();
+		stream.seekg(0, std::ifstream::end);
+		const std::streamoff payload_size = stream.tellg() - payload_begin;
+		stream.seekg(payload_begin);
+		if ( !stream.good() || (payload_size < 0) || ((unsigned long long) payload_size
+				!= ((unsigned long long) n_nodes + 1 + n_runs)*sizeof(unsigned int)) )
+			return 0L;
+
+		PathDatabase *p_database = new PathDatabase(map, false, 0);
+		if (n_nodes != p_database->n_nodes_)
+		{
+			delete p_database;
+			return 0L;
+		}
+		p_database->first_run_.resize(n_nodes+1);
+		p_database->runs_.resize(n_runs);
+		stream.read(reinterpret_cast<char *>(&p_database->first_run_[0]), (n_nodes+1)*sizeof(unsigned int));
+		if (n_runs > 0)
+			stream.read(reinterpret_cast<char *>(&p_database->runs_[0]), n_runs*sizeof(unsigned int));
+		if ( !stream.good() || (p_database->get_payload_checksum() != payload_checksum)
+				|| !p_database->IsConsistent(map) )
+		{
+			delete p_database;
+			return 0L;
+		}
+		return p_database;
+	}
+
+
+
+
+	static o_data_structures::Registry<PathDatabase> registry;  //< databases of all registered maps
+
+
+	/** \brief Provides the path database of a map for cpd::FindPath(..)
+	 *
+	 *  \details The database is read from file_name if that file holds the database
+	 *  of this map; otherwise it is built and saved to file_name.
+	 *
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] file_name database file (empty: neither read nor saved)
+	 *  \return the database
+	 *
+	 *  \note The database must be registered again if the map data changes.
+	 */
+	std::shared_ptr<const PathDatabase> RegisterPathDatabase(const unsigned char *data, const int &width, const int &height,
+			const std::string &file_name)
+	{
+		o_graph::Map map(width, height, data);
+		std::shared_ptr<PathDatabase> p_database(file_name.empty() ? 0L : PathDatabase::Load(file_name, map));
+		if (!p_database)
+		{
+			p_database = std::make_shared<PathDatabase>(map);
+			if (!file_name.empty())
+				p_database->Save(file_name);
+		}
+		return registry.Register(data, p_database);
+	}
+
+
+	/** \brief Removes the path database of a map from the registry
+	 *  \param[in] data grid data of the map
+	 *  \note Pathfinders that use it keep it alive until they are done.
+	 */
+	void UnregisterPathDatabase(const unsigned char *data)
+	{
+		registry.Unregister(data);
+		return;
+	}
+
+
+	/** \brief Looks up the registered path database of a map
+	 *  \param[in] data grid data of the map
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return database of the map; empty if none is registered for this data and extent
+	 */
+	std::shared_ptr<const PathDatabase> FindPathDatabase(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Find(data, width, height);
+	}
+
+
+
+
+	//! \brief Interface to use the path database (see PathDatabase.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize)
+	{
+		unsigned int nodes_expanded;
+		return FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+				pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+
+	//! \brief Interface with diagnostics (see PathDatabase.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		const std::shared_ptr<const PathDatabase> p_database = FindPathDatabase(pMap, nMapWidth, nMapHeight);
+		if (!p_database)
+			return astar::FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+					pOutBuffer, nOutBufferSize, nodes_expanded);
+
+		int nPathLength = p_database->GetPath(nStartX + nStartY*nMapWidth, nTargetX + nTargetY*nMapWidth,
+				pOutBuffer, nOutBufferSize);
+		nodes_expanded = (nPathLength > 0) ? nPathLength : 0;
+		return nPathLength;
+	}
+
+} // END OF NAMESPACE cpd
@@ -258,3 +258,123 @@ void AnalysisRuntime::Evaluate()
 
 	return;
 }
+
+
+
+const int BenchmarkFamilies::corridor_widths_[6] = {1, 2, 4, 8, 16, 32};
+
+
+BenchmarkFamilies::BenchmarkFamilies() :
+	runs_per_map_(0),
+	maps_per_family_(0),
+	map_directory_(""),
+	max_corridor_width_(0)
+{ }
+
+
+BenchmarkFamilies::BenchmarkFamilies(const int &runs_per_map, const int &maps_per_family,
+		const std::string &map_directory) :
+	runs_per_map_(runs_per_map),
+	maps_per_family_(o_math::min(maps_per_family, 10)),
+	map_directory_(map_directory),
+	max_corridor_width_(corridor_widths_[n_families_-1])
+{ }
+
+
+//! \brief Restricts the following Run(..) calls to families up to this corridor width
+void BenchmarkFamilies::set_max_corridor_width(const int &max_corridor_width)
+{
+	max_corridor_width_ = max_corridor_width;
+	return;
+}
+
+
+void BenchmarkFamilies::Run(const std::string &engine_name, PathfinderDiagnosticsFunc engine,
+		std::ostream &output_stream) const
+{
+	Run(engine_name, engine, 0L, 0L, output_stream);
+	return;
+}
+
+
+void BenchmarkFamilies::Run(const std::string &engine_name, PathfinderDiagnosticsFunc engine,
+		MapPreparationFunc prepare, MapReleaseFunc release, std::ostream &output_stream) const
+{
+	output_stream << "engine: " << engine_name << "\n";
+	output_stream << "family\tqueries\tsum_len\texpanded\twall_time\texp/sec\t\tus/query\tprep_time\n";
+
+	for(int f=0; (f<n_families_) && (corridor_widths_[f]<=max_corridor_width_); ++f)
+	{
+		nr_rngs::Ran rng(19840827 + corridor_widths_[f]);
+		unsigned int queries = 0;
+		long long sum_length = 0;
+		double sum_expanded = .0;
+		double sum_wall = .0;
+		double sum_prep = .0;
+
+		for(int m=0; m<maps_per_family_; ++m)
+		{
+			std::stringstream file_name;
+			file_name << map_directory_ << "maze512-" << corridor_widths_[f] << "-" << m << ".map";
+			o_graph::Map map = o_graph::LoadMap(file_name.str());
+			if(map.data_ == 0L)
+				continue;
+			o_graph::RegisterComponents(map.data_, map.width_, map.height_);
+			o_graph::RegisterNeighbourMasks(map.data_, map.width_, map.height_);
+			if(prepare != 0L)
+			{
+				double prep0 = get_wall_time();
+				prepare(map.data_, map.width_, map.height_);
+				sum_prep += get_wall_time() - prep0;
+			}
+
+			const int nBufferSize = map.width_*map.height_;
+			int *pOutBuffer = new int[nBufferSize];
+
+			for(int r=0; r<runs_per_map_; ++r)
+			{
+				int x0, y0, x1, y1;
+				do {
+					x0 = (int) (rng.doub()*map.width_);
+					y0 = (int) (rng.doub()*map.height_);
+				} while(!map.is_traversable(x0,y0));
+				do {
+					x1 = (int) (rng.doub()*map.width_);
+					y1 = (int) (rng.doub()*map.height_);
+				} while(!map.is_traversable(x1,y1));
+
+				unsigned int nodes_expanded = 0;
+				double wall0 = get_wall_time();
+				int path_length = engine(x0, y0, x1, y1, map.data_, map.width_, map.height_,
+						pOutBuffer, nBufferSize, nodes_expanded);
+				sum_wall += get_wall_time() - wall0;
+
+				sum_length += path_length;
+				sum_expanded += nodes_expanded;
+				++queries;
+			}
+
+			delete[] pOutBuffer;
+			if(release != 0L)
+				release(map.data_);
+			o_graph::UnregisterNeighbourMasks(map.data_);
+			o_graph::UnregisterComponents(map.data_);
+			delete[] map.data_;
+		}
+
+		output_stream << "maze512-" << corridor_widths_[f] << "\t";
+		output_stream << queries << "\t";
+		output_stream << sum_length << "\t";
+		output_stream << std::fixed << std::setprecision(0) << sum_expanded << "\t";
+		output_stream << std::setprecision(4) << sum_wall << "\t\t";
+		output_stream << std::scientific << std::setprecision(3)
+				<< (sum_wall > .0 ? sum_expanded/sum_wall : .0) << "\t";
+		output_stream << std::fixed << std::setprecision(1)
+				<< (queries > 0 ? 1.e6*sum_wall/queries : .0) << "\t";
+		output_stream << std::setprecision(3) << sum_prep << "\n";
+		output_stream.unsetf(std::ios_base::floatfield);
+		output_stream << std::setprecision(6);
+	}
+	output_stream << std::endl;
+	return;
+}
@@ -0,0 +1,13 @@
+/** \file
+ * 		Registry.cpp
+ *
+ *  \brief
+ *  	Preprocessed data of game maps, looked up by the maps data pointer (class Registry)
+ *
+ *	\details
+ *		Accompanying .cpp file to Registry.hpp;
+ *		This file is a stub since Registry is
+ *		a template class.
+ */
+
+#include "Registry.hpp"
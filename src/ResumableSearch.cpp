@@ -0,0 +1,154 @@
+/** \file
+ * 		ResumableSearch.cpp
+ *
+ * 	\brief
+ *		A* search that can be spread over several calls (time slicing)
+ *
+ * 	\details
+ * 		Contains definitions to accompnying header ResumableSearch.hpp
+ * 		This file is part of project pdx_pathfinding
+ */
+
+#include "ResumableSearch.hpp"
+
+namespace astar
+{
+
+	/** \brief Everything a search needs between two steps
+	 *  \details Kept on the heap, so the references of astar_ stay valid when
+	 *  a ResumableSearch is moved.
+	 */
+	struct ResumableSearch::State
+	{
+		State(const unsigned char* pMap, const int &nMapWidth, const int &nMapHeight,
+				int* pOutBuffer, const int &nOutBufferSize) :
+			map_(nMapWidth, nMapHeight, pMap), workspace_(),
+			astar_(map_, pOutBuffer, nOutBufferSize, workspace_)
+		{
+			// nothing to do here
+		}
+
+		o_graph::Map map_;       //< the map (data owned by caller)
+		Workspace workspace_;    //< lists of the search (not shared with other searches)
+		AStar astar_;            //< the search working on map_ and workspace_
+	};
+
+
+	/** \brief Constructor
+	 *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+	 *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+	 *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+	 *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+	 *  stored (excluding the starting position)
+	 *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+	 */
+	ResumableSearch::ResumableSearch(const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+			int* pOutBuffer, const int nOutBufferSize) :
+		p_state_(new State(pMap, nMapWidth, nMapHeight, pOutBuffer, nOutBufferSize)),
+		status_(search_idle)
+	{
+		// nothing to do here
+	}
+
+
+	//! \brief Move constructor (other is idle afterwards)
+	ResumableSearch::ResumableSearch(ResumableSearch &&other) :
+		p_state_(other.p_state_), status_(other.status_)
+	{
+		other.p_state_ = 0L;
+		other.status_ = search_idle;
+	}
+
+
+	//! \brief Move assignment (the search of this object is cancelled, other is idle afterwards)
+	ResumableSearch &ResumableSearch::operator=(ResumableSearch &&other)
+	{
+		if (this != &other)
+		{
+			delete p_state_;
+			p_state_ = other.p_state_;
+			status_ = other.status_;
+			other.p_state_ = 0L;
+			other.status_ = search_idle;
+		}
+		return *this;
+	}
+
+
+	//! \brief Destructor (releases all memory of the search, running or not)
+	ResumableSearch::~ResumableSearch()
+	{
+		delete p_state_;
+	}
+
+
+	/** \brief Sets up a new search (a running search is cancelled)
+	 *
+	 *  \details Start and target known to be in different components (see RegisterComponents(..))
+	 *  are detected at once: the status is search_unreachable without any Step(..).
+	 *
+	 *  \param[in] nStartX The zero based x-coordinate of the start position
+	 *  \param[in] nStartY The zero based y-coordinate of the start position
+	 *  \param[in] nTargetX The zero based x-coordinate of the target position
+	 *  \param[in] nTargetY The zero based y-coordinate of the target position
+	 */
+	void ResumableSearch::Start(const int nStartX, const int nStartY, const int nTargetX, const int nTargetY)
+	{
+		Cancel();
+		if (p_state_ == 0L)
+			return;
+
+		p_state_->astar_.nodes_expanded_ = 0;
+		status_ = p_state_->astar_.Start(nStartX, nStartY, nTargetX, nTargetY) ?
+				search_in_progress : search_unreachable;
+		if (status_ != search_in_progress)
+			p_state_->astar_.ClearLists();
+		return;
+	}
+
+
+	/** \brief Continues the search
+	 *
+	 *  \details Once the search has ended its nodes are released and
+	 *  further calls return the same status without any work.
+	 *
+	 *  \param[in] max_expansions maximum number of nodes to be expanded in this call
+	 *  \return search_in_progress if the budget was used up; otherwise the final state
+	 *  of the search (search_idle if there is none)
+	 */
+	SearchStatus ResumableSearch::Step(const unsigned int &max_expansions)
+	{
+		if (status_ != search_in_progress)
+			return status_;
+
+		status_ = p_state_->astar_.Step(max_expansions);
+		if (status_ != search_in_progress)
+			p_state_->astar_.ClearLists();
+		return status_;
+	}
+
+
+	//! \brief Stops a running search and releases its nodes (the object is idle afterwards)
+	void ResumableSearch::Cancel()
+	{
+		if (status_ == search_in_progress)
+			p_state_->astar_.ClearLists();
+		status_ = search_idle;
+		return;
+	}
+
+
+	//! \brief length of the path found (-1 unless the status is search_found)
+	int ResumableSearch::get_path_length() const
+	{
+		return (status_ == search_found) ? p_state_->astar_.path_length_ : -1;
+	}
+
+
+	//! \brief number of nodes generated by the current search so far (for diagnostics)
+	unsigned int ResumableSearch::get_nodes_expanded() const
+	{
+		return (p_state_ == 0L) ? 0 : p_state_->astar_.nodes_expanded_;
+	}
+
+} // END OF NAMESPACE astar
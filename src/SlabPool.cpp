@@ -0,0 +1,13 @@
+/** \file
+ * 		SlabPool.cpp
+ *
+ *  \brief
+ *  	Provides an arena allocator for objects of one type (class SlabPool)
+ *
+ *	\details
+ *		Accompanying .cpp file to SlabPool.hpp;
+ *		This file is a stub since SlabPool is
+ *		a template class.
+ */
+
+#include "SlabPool.hpp"
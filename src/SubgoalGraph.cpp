@@ -0,0 +1,449 @@
+/** \file
+ * 		SubgoalGraph.cpp
+ *
+ *  \brief
+ *  	Provides pathfinding capabilities (simple subgoal graphs)
+ *
+ *	\details
+ *		Contains definitions to accompanying header SubgoalGraph.hpp
+ *		and the registry of subgoal graphs for maps passed by their data pointer.
+ *
+ *		A query searches the subgoals plus a virtual start (n_subgoals_) and a
+ *		virtual target (n_subgoals_+1). The virtual start has edges to the subgoals
+ *		directly h-reachable from the start (and to the virtual target if the target is
+ *		h-reachable), the subgoals directly h-reachable from the target get an edge to
+ *		the virtual target.
+ */
+
+#include <algorithm>  // std::sort, std::unique, std::reverse
+#include <cstdlib>    // abs(..)
+#include "SubgoalGraph.hpp"
+#include "Registry.hpp"           // registered graphs
+#include "AStar.hpp"              // fallback without registered graph
+#include "ComponentLabels.hpp"    // O(1) rejection of unreachable targets
+#include "GenerationStamps.hpp"   // seen and closed subgoals of the search
+#include "IndexedBinaryHeap.hpp"  // open list of the search
+
+namespace subgoal
+{
+
+	const int SubgoalGraph::no_subgoal_;
+
+
+	/** \brief Constructor (places the subgoals and connects them)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \param[in] data grid data of the map (see Map.hpp; must outlive the graph)
+	 */
+	SubgoalGraph::SubgoalGraph(const int &width, const int &height, const unsigned char *data) :
+			width_(width), height_(height), data_(data), n_subgoals_(0),
+			subgoal_of_cell_(width*height, no_subgoal_)
+	{
+		for (int y=0; y<height_; ++y)
+			for (int x=0; x<width_; ++x)
+				if (IsSubgoal(x, y))
+				{
+					subgoal_of_cell_[x + y*width_] = n_subgoals_++;
+					cell_of_subgoal_.push_back(x + y*width_);
+				}
+
+		std::vector<unsigned int> subgoals;
+		first_edge_.assign(1, 0);
+		for (unsigned int s=0; s<n_subgoals_; ++s)
+		{
+			ScanQuadrants(cell_of_subgoal_[s], cell_of_subgoal_[s], subgoals);
+			for (std::size_t i=0; i<subgoals.size(); ++i)
+				edge_head_.push_back(subgoal_of_cell_[subgoals[i]]);
+			first_edge_.push_back(edge_head_.size());
+		}
+	}
+
+
+	/** \brief checks if a grid point is traversable
+	 *  \param[in] x x-coordinate of the grid point
+	 *  \param[in] y y-coordinate of the grid point
+	 *  \return true if (x,y) lies on the map and is traversable
+	 */
+	bool SubgoalGraph::is_traversable(const int &x, const int &y) const
+	{
+		return (x >= 0) && (x < width_) && (y >= 0) && (y < height_) && (data_[x + y*width_] == 1);
+	}
+
+
+	/** \brief checks if a grid point lies at a convex corner of an obstacle
+	 *  \param[in] x x-coordinate of the grid point
+	 *  \param[in] y y-coordinate of the grid point
+	 *  \return true if (x,y) is a subgoal (see class documentation)
+	 */
+	bool SubgoalGraph::IsSubgoal(const int &x, const int &y) const
+	{
+		if (!is_traversable(x, y))
+			return false;
+		for (int dy=-1; dy<=1; dy+=2)
+			for (int dx=-1; dx<=1; dx+=2)
+				if ( is_traversable(x+dx, y) && is_traversable(x, y+dy) && !is_traversable(x+dx, y+dy) )
+					return true;
+		return false;
+	}
+
+
+	/** \brief finds the subgoals directly h-reachable from a grid point
+	 *
+	 *  \details Every quadrant is scanned row by row (away from origin); the scan of a
+	 *  quadrant ends with the first row without a reached grid point that isn't a subgoal.
+	 *
+	 *  \param[in] origin The grid point
+	 *  \param[in] goal A grid point to be checked for h-reachability from origin
+	 *  \param[out] subgoals the directly h-reachable subgoals (sorted, without origin)
+	 *  \return true if goal is h-reachable from origin without passing a subgoal
+	 */
+	bool SubgoalGraph::ScanQuadrants(const unsigned int &origin, const unsigned int &goal,
+			std::vector<unsigned int> &subgoals) const
+	{
+		static thread_local std::vector<char> previous_row;
+		static thread_local std::vector<char> current_row;
+		previous_row.resize(width_);
+		current_row.resize(width_);
+
+		const int x0 = origin % width_;
+		const int y0 = origin / width_;
+		bool goal_reached = (goal == origin);
+		subgoals.clear();
+
+		for (int dy=-1; dy<=1; dy+=2)
+			for (int dx=-1; dx<=1; dx+=2)
+			{
+				const int n_columns = (dx > 0) ? width_-x0 : x0+1;
+				const int n_rows = (dy > 0) ? height_-y0 : y0+1;
+				int previous_limit = 0;  // last column of previous_row that passes the scan on
+				for (int j=0; j<n_rows; ++j)
+				{
+					const int y = y0 + j*dy;
+					int limit = -1;
+					for (int i=0; i<n_columns; ++i)
+					{
+						const int x = x0 + i*dx;
+						const unsigned int id = x + y*width_;
+						bool reached = (i == 0) && (j == 0);
+						if (!reached)
+							reached = ( ((i > 0) && current_row[i-1]) || ((j > 0) && (i <= previous_limit) && previous_row[i]) )
+									&& (data_[id] == 1);
+						current_row[i] = 0;
+						if (!reached)
+						{
+							if (i > previous_limit)
+								break;
+							continue;
+						}
+						if (id == goal)
+							goal_reached = true;
+						if ( (id != origin) && (subgoal_of_cell_[id] != no_subgoal_) )
+						{
+							subgoals.push_back(id);
+							continue;
+						}
+						current_row[i] = 1;
+						limit = i;
+					}
+					if (limit < 0)
+						break;
+					previous_row.swap(current_row);
+					previous_limit = limit;
+				}
+			}
+
+		// grid points on the axes are found by two quadrants
+		std::sort(subgoals.begin(), subgoals.end());
+		subgoals.erase(std::unique(subgoals.begin(), subgoals.end()), subgoals.end());
+		return goal_reached;
+	}
+
+
+	/** \brief writes a monotone path between two h-reachable grid points
+	 *
+	 *  \param[in] from first grid point (not written)
+	 *  \param[in] to last grid point
+	 *  \param[out] pOutBuffer buffer for the path (owned by caller)
+	 *  \param[in] nOutBufferSize length of pOutBuffer
+	 *  \param[in] n number of grid points of the path before this segment
+	 *  \return number of grid points of the path after this segment
+	 */
+	int SubgoalGraph::Refine(const unsigned int &from, const unsigned int &to,
+			int *pOutBuffer, const int &nOutBufferSize, const int &n) const
+	{
+		static thread_local std::vector<char> reached;
+
+		const int x0 = from % width_;
+		const int y0 = from / width_;
+		const int dx = ((int) (to % width_) >= x0) ? 1 : -1;
+		const int dy = ((int) (to / width_) >= y0) ? 1 : -1;
+		const int n_columns = abs((int) (to % width_) - x0) + 1;
+		const int n_rows = abs((int) (to / width_) - y0) + 1;
+
+		// grid points of the box reachable from 'from' by monotone moves
+		reached.assign(n_columns*n_rows, 0);
+		for (int j=0; j<n_rows; ++j)
+			for (int i=0; i<n_columns; ++i)
+				reached[i + j*n_columns] = ( ((i == 0) && (j == 0))
+						|| ((i > 0) && reached[i-1 + j*n_columns]) || ((j > 0) && reached[i + (j-1)*n_columns]) )
+						&& (data_[(x0 + i*dx) + (y0 + j*dy)*width_] == 1);
+
+		// walk back from 'to'; keep the direction as long as possible (straight segments)
+		int i = n_columns-1;
+		int j = n_rows-1;
+		bool horizontal = true;
+		for (int k=n+n_columns+n_rows-3; k>=n; --k)
+		{
+			if (k < nOutBufferSize)
+				pOutBuffer[k] = (x0 + i*dx) + (y0 + j*dy)*width_;
+			bool left = (i > 0) && reached[i-1 + j*n_columns];
+			bool down = (j > 0) && reached[i + (j-1)*n_columns];
+			horizontal = left && (horizontal || !down);
+			if (horizontal)
+				--i;
+			else
+				--j;
+		}
+		return n + n_columns + n_rows - 2;
+	}
+
+
+	/** \brief memory used by the graph
+	 *  \return size of all arrays in bytes
+	 */
+	std::size_t SubgoalGraph::get_memory_footprint() const
+	{
+		return sizeof(SubgoalGraph)
+				+ subgoal_of_cell_.capacity()*sizeof(int)
+				+ (cell_of_subgoal_.capacity() + first_edge_.capacity() + edge_head_.capacity())*sizeof(unsigned int);
+	}
+
+
+
+
+	//! \brief memory of the search kept between queries (one per thread)
+	struct SearchWorkspace
+	{
+		std::vector<int> g_;                        //< path cost of nodes
+		std::vector<int> predecessors_;             //< predecessor of nodes (-1: none)
+		std::vector<unsigned int> start_subgoals_;  //< subgoals directly h-reachable from the start
+		std::vector<unsigned int> target_subgoals_; //< subgoals directly h-reachable from the target
+		std::vector<unsigned int> waypoints_;       //< grid points of the path found
+		o_data_structures::GenerationStamps<unsigned int> seen_;     //< nodes with valid g_
+		o_data_structures::GenerationStamps<unsigned int> closed_;   //< expanded nodes
+		o_data_structures::GenerationStamps<unsigned int> at_target_;  //< subgoals with an edge to the virtual target
+		o_data_structures::IndexedBinaryHeap<int, unsigned int> open_list_;  //< keyed by f
+	};
+
+
+	/** \brief Updates a node reached by the search
+	 *
+	 *  \param[in,out] workspace memory of the search
+	 *  \param[in] node The reached node
+	 *  \param[in] h heuristic of node (manhattan distance to the target)
+	 *  \param[in] g path cost of node via predecessor
+	 *  \param[in] predecessor The expanded node
+	 */
+	void RelaxNode(SearchWorkspace &workspace, const unsigned int &node, const int &h,
+			const int &g, const int &predecessor)
+	{
+		if (workspace.closed_.is_set(node))
+			return;
+		if (!workspace.seen_.is_set(node))
+		{
+			workspace.seen_.set(node);
+			workspace.g_[node] = g;
+			workspace.predecessors_[node] = predecessor;
+			workspace.open_list_.insert(node, g+h, node);
+		}
+		else if (g < workspace.g_[node])
+		{
+			workspace.g_[node] = g;
+			workspace.predecessors_[node] = predecessor;
+			workspace.open_list_.change_key_by_id(node, g+h);
+		}
+		return;
+	}
+
+
+	/** \brief A* search on the subgoal graph (see file documentation)
+	 *
+	 *  \param[in] start id of the start position
+	 *  \param[in] target id of the target position
+	 *  \param[out] pOutBuffer Buffer for the ids of the path (excluding start)
+	 *  \param[in] nOutBufferSize length of pOutBuffer (only the first nOutBufferSize
+	 *  grid points of longer paths are written)
+	 *  \param[out] nodes_expanded number of expanded nodes
+	 *  \return length of the path; -1 if no path exists
+	 */
+	int SubgoalGraph::FindPath(const unsigned int &start, const unsigned int &target,
+			int *pOutBuffer, const int &nOutBufferSize, unsigned int &nodes_expanded) const
+	{
+		static thread_local SearchWorkspace workspace;
+
+		nodes_expanded = 0;
+		if ( (data_[start] != 1) || (data_[target] != 1) )
+			return -1;
+		if (start == target)
+			return 0;
+
+		const unsigned int virtual_start = n_subgoals_;
+		const unsigned int virtual_target = n_subgoals_+1;
+		workspace.g_.resize(n_subgoals_+2);
+		workspace.predecessors_.resize(n_subgoals_+2);
+		workspace.seen_.resize(n_subgoals_+2);
+		workspace.closed_.resize(n_subgoals_+2);
+		workspace.at_target_.resize(n_subgoals_+2);
+		workspace.seen_.next_generation();
+		workspace.closed_.next_generation();
+		workspace.at_target_.next_generation();
+		workspace.open_list_.resize_ids(n_subgoals_+2);
+		workspace.open_list_.clear();
+
+		// connect start and target
+		const bool direct = ScanQuadrants(start, target, workspace.start_subgoals_);
+		ScanQuadrants(target, target, workspace.target_subgoals_);
+		for (std::size_t i=0; i<workspace.target_subgoals_.size(); ++i)
+			workspace.at_target_.set(subgoal_of_cell_[workspace.target_subgoals_[i]]);
+		if (subgoal_of_cell_[target] != no_subgoal_)
+			workspace.at_target_.set(subgoal_of_cell_[target]);
+
+		workspace.seen_.set(virtual_start);
+		workspace.g_[virtual_start] = 0;
+		workspace.predecessors_[virtual_start] = -1;
+		workspace.open_list_.insert(virtual_start, 0, virtual_start);
+
+		bool found = false;
+		while (!workspace.open_list_.is_empty())
+		{
+			const unsigned int node = workspace.open_list_.pop(0);
+			if (node == virtual_target)
+			{
+				found = true;
+				break;
+			}
+			workspace.closed_.set(node);
+			++nodes_expanded;
+
+			const int g = workspace.g_[node];
+			if (node == virtual_start)
+			{
+				if (direct)
+					RelaxNode(workspace, virtual_target, 0, get_distance(start, target), node);
+				for (std::size_t i=0; i<workspace.start_subgoals_.size(); ++i)
+				{
+					const unsigned int cell = workspace.start_subgoals_[i];
+					RelaxNode(workspace, subgoal_of_cell_[cell], get_distance(cell, target),
+							get_distance(start, cell), node);
+				}
+				if (subgoal_of_cell_[start] != no_subgoal_)
+					RelaxNode(workspace, subgoal_of_cell_[start], get_distance(start, target), 0, node);
+				continue;
+			}
+
+			const unsigned int cell = cell_of_subgoal_[node];
+			if (workspace.at_target_.is_set(node))
+				RelaxNode(workspace, virtual_target, 0, g + get_distance(cell, target), node);
+			for (unsigned int e=first_edge_[node]; e<first_edge_[node+1]; ++e)
+			{
+				const unsigned int head = cell_of_subgoal_[edge_head_[e]];
+				RelaxNode(workspace, edge_head_[e], get_distance(head, target), g + get_distance(cell, head), node);
+			}
+		}
+		if (!found)
+			return -1;
+
+		// waypoints: start, subgoals, target
+		workspace.waypoints_.assign(1, target);
+		for (int node=workspace.predecessors_[virtual_target]; node!=(int) virtual_start; node=workspace.predecessors_[node])
+			workspace.waypoints_.push_back(cell_of_subgoal_[node]);
+		workspace.waypoints_.push_back(start);
+		std::reverse(workspace.waypoints_.begin(), workspace.waypoints_.end());
+
+		int n = 0;
+		for (std::size_t i=1; i<workspace.waypoints_.size(); ++i)
+			n = Refine(workspace.waypoints_[i-1], workspace.waypoints_[i], pOutBuffer, nOutBufferSize, n);
+		return n;
+	}
+
+
+
+
+	static o_data_structures::Registry<SubgoalGraph> registry;  //< graphs of all registered maps
+
+
+	/** \brief Builds the subgoal graph of a map and registers it for subgoal::FindPath(..)
+	 *
+	 *  \param[in] data grid data of the map (see Map.hpp)
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return the graph
+	 *
+	 *  \note The graph must be registered again if the map data changes.
+	 */
+	std::shared_ptr<const SubgoalGraph> RegisterSubgoalGraph(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Register(data, std::make_shared<const SubgoalGraph>(width, height, data));
+	}
+
+
+	/** \brief Removes the subgoal graph of a map from the registry
+	 *  \param[in] data grid data of the map
+	 *  \note Pathfinders that use it keep it alive until they are done.
+	 */
+	void UnregisterSubgoalGraph(const unsigned char *data)
+	{
+		registry.Unregister(data);
+		return;
+	}
+
+
+	/** \brief Looks up the registered subgoal graph of a map
+	 *  \param[in] data grid data of the map
+	 *  \param[in] width width of the map
+	 *  \param[in] height height of the map
+	 *  \return graph of the map; empty if none is registered for this data and extent
+	 */
+	std::shared_ptr<const SubgoalGraph> FindSubgoalGraph(const unsigned char *data, const int &width, const int &height)
+	{
+		return registry.Find(data, width, height);
+	}
+
+
+
+
+	//! \brief Interface to search the subgoal graph (see SubgoalGraph.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize)
+	{
+		unsigned int nodes_expanded;
+		return FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+				pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+
+	//! \brief Interface with diagnostics (see SubgoalGraph.hpp)
+	int FindPath(const int nStartX, const int nStartY,
+				 const int nTargetX, const int nTargetY,
+				 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+	{
+		const std::shared_ptr<const SubgoalGraph> p_graph = FindSubgoalGraph(pMap, nMapWidth, nMapHeight);
+		if (!p_graph)
+			return astar::FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+					pOutBuffer, nOutBufferSize, nodes_expanded);
+
+		const unsigned int start = nStartX + nStartY*nMapWidth;
+		const unsigned int target = nTargetX + nTargetY*nMapWidth;
+		const std::shared_ptr<const o_graph::ComponentLabels> p_components = o_graph::FindComponents(pMap, nMapWidth, nMapHeight);
+		if ( p_components && !p_components->connected(start, target) )
+		{
+			nodes_expanded = 0;
+			return -1;
+		}
+		return p_graph->FindPath(start, target, pOutBuffer, nOutBufferSize, nodes_expanded);
+	}
+
+} // END OF NAMESPACE subgoal
@@ -23,13 +23,84 @@
  */
 
 
+#include <algorithm>  // std::fill, std::min (FindDistances(..))
 #include "UniformCostSearch.hpp"
 #include "BinaryHeap.hpp"
+#include "GenerationStamps.hpp"
+#include "BucketQueue.hpp"
+#include "ComponentLabels.hpp"
+#include "NeighbourMasks.hpp"
 
 typedef o_data_structures::BinaryHeap<unsigned int, unsigned int> OpenList;
+typedef o_data_structures::BucketQueue<unsigned int> BucketList;
 typedef o_data_structures::BinaryHeapNode<unsigned int, unsigned int> OpenListItem;
 
-//std::mutex ucs_mutex;
+
+/** \brief Memory used by FindPath(..) that is kept between calls
+ *
+ *  \details Every thread owns one workspace (see ThreadUcsWorkspace()).
+ *  The buffers are only reallocated if a map with more nodes than any map before
+ *  is searched. The closed list stores a generation stamp per node; a new search
+ *  starts a new generation instead of clearing the list, so the cost of a query
+ *  scales with the explored region and not with the size of the map.
+ *  pPredecessorIds is only read for nodes on the closed list and never needs clearing.
+ */
+struct UcsWorkspace
+{
+	UcsWorkspace() :
+		nNodes(0), pPredecessorIds(0L)
+	{
+		// nothing to do here
+	}
+
+	~UcsWorkspace()
+	{
+		delete[] pPredecessorIds;
+	}
+
+	/** \brief Makes sure the buffers can hold nNodesRequired nodes
+	 *  \param[in] nNodesRequired number of nodes of the map to be searched
+	 */
+	void Reserve(const unsigned int nNodesRequired)
+	{
+		if (nNodesRequired <= nNodes)
+			return;
+		delete[] pPredecessorIds;
+		nNodes = nNodesRequired;
+		sClosedList.resize(nNodes);
+		pPredecessorIds = new unsigned int[nNodes];
+		return;
+	}
+
+	//! \brief Resets everything a search has written to the workspace (O(1))
+	void Clear()
+	{
+		sClosedList.next_generation();
+		qOpenList.clear();
+		qBucketList.clear();
+		return;
+	}
+
+	unsigned int nNodes;                                  //< number of nodes the buffers can hold
+	o_data_structures::GenerationStamps<> sClosedList;    //< marks nodes that were put on the open list
+	unsigned int * pPredecessorIds;                       //< predecessor of every marked node
+	OpenList qOpenList;                                   //< priority queue (key: path cost, data: node id)
+	BucketList qBucketList;                               //< alternative priority queue (key: path cost, data: node id)
+
+private :
+	UcsWorkspace(const UcsWorkspace &);
+	UcsWorkspace &operator=(const UcsWorkspace &);
+};
+
+
+/** \brief Workspace of the calling thread
+ *  \return Reference to the UcsWorkspace of the calling thread
+ */
+UcsWorkspace &ThreadUcsWorkspace()
+{
+	static thread_local UcsWorkspace workspace;
+	return workspace;
+}
 
 
 
@@ -115,52 +186,23 @@ inline int GetY(const unsigned int &id, const int &width) {
 
 
 /** \brief Function for expanding the graph
- *  \details calculates ids of neighbouring nodes
- *  for a given node and puts ids to NeighbourList
+ *  \details traversable neighbours of a node as bit mask: precomputed if
+ *  masks are registered for the map, computed on the fly otherwise
  *
  *  \param[in] id Id of note to be expanded
  *  \param[in] width Width of the map
  *  \param[in] height Height of the map
- *  \param[in] pNeighbourList Buffer to write ids of neighbours into
- *  \param[in] Pointer to the game map
+ *  \param[in] pMap Pointer to the game map
+ *  \param[in] pMasks neighbour masks of the map (null pointer if none are registered)
  *
- *  return number of ids written into pNeighbourList
+ *  return the mask (see NeighbourMasks.hpp)
  */
-int FillNeighbourList(const unsigned int id,
-		int width,
-		int height, unsigned int * pNeighbourList,
-		const unsigned char * pMap)
+inline unsigned int GetNeighbourMask(const unsigned int id, const int width, const int height,
+		const unsigned char * pMap, const o_graph::NeighbourMasks *pMasks)
 {
-	int nNeighbours = 0;
-
-	int x = GetX(id,width);
-	int y = GetY(id,width);
-
-	if(((x + 1) < width) && (pMap[id + 1] == 1) )
-	{
-		pNeighbourList[nNeighbours] = id + 1;
-		++nNeighbours;
-	}
-
-	if(((x - 1) >= 0 ) && (pMap[id - 1] == 1) )
-	{
-		pNeighbourList[nNeighbours] = id - 1;
-		++nNeighbours;
-	}
-
-	if(((y + 1) < height) && (pMap[id + width] == 1))
-	{
-		pNeighbourList[nNeighbours] = id + width;
-		++nNeighbours;
-	}
-
-	if(((y - 1) >= 0) && (pMap[id - width] == 1))
-	{
-		pNeighbourList[nNeighbours] = id - width;
-		++nNeighbours;
-	}
-
-	return nNeighbours;
+	if (pMasks != 0L)
+		return pMasks->mask(id);
+	return o_graph::NeighbourMasks::ComputeMask(id, width, height, pMap);
 }
 
 
@@ -185,71 +227,336 @@ void ReconstructPath(unsigned int id, unsigned int cost,
 }
 
 
+/** \brief removes the node with least path cost from the open list
+ *  \param[in] qOpenList The open list (mustn't be empty)
+ *  \param[out] nCost path cost of the removed node
+ *  \param[out] nId id of the removed node
+ */
+inline void PopMin(OpenList &qOpenList, unsigned int &nCost, unsigned int &nId)
+{
+	nCost = qOpenList.A_[0].key_;
+	nId = qOpenList.A_[0].data_;
+	qOpenList.remove(0);
+	return;
+}
+
+
+//! \brief removes the node with least path cost from the open list (see above)
+inline void PopMin(BucketList &qOpenList, unsigned int &nCost, unsigned int &nId)
+{
+	nCost = qOpenList.min_key();
+	nId = qOpenList.pop();
+	return;
+}
+
+
 /** \brief uniform cost searchs main loop
  *
- *  \param[in] nStartX The zero based x-coordinate of the start position
- *  \param[in] nStartY The zero based y-coordinate of the start position
- *  \param[in] nTargetX The zero based x-coordinate of the target position
- *  \param[in] nTargetY The zero based y-coordinate of the target position
- *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
- *  \param[in] nMapWidth the width of the map (its extent in x-direction)
- *  \param[in] nMapHeight the height of the map (its extent in y-direction)
- *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
- *  stored (excluding the starting position)
- *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+ *  \details QueueType is either OpenList or BucketList; both are used through
+ *  insert(key, data), n_items_ and PopMin(..)
+ *
+ *  \param[in] workspace Memory of the calling thread (see ThreadUcsWorkspace())
+ *  \param[in] qOpenList The open list to be used (part of workspace)
+ *  \param[in] pMasks neighbour masks of the map (null pointer if none are registered)
+ *  \param[out] nodes_expanded number of nodes put on the open list
+ *  other parameters and return value see FindPath(..)
  */
-int FindPath(const int nStartX, const int nStartY,
+template <typename QueueType>
+int SearchLoop(UcsWorkspace &workspace, QueueType &qOpenList, const o_graph::NeighbourMasks *pMasks,
+			 const int nStartX, const int nStartY,
 			 const int nTargetX, const int nTargetY,
 			 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
-			 int* pOutBuffer, const int nOutBufferSize)
+			 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
 {
-	//std::lock_guard<std::mutex> ucs_guard(ucs_mutex);
-	//std::priority_queue<Node, std::vector<Node>, std::greater<Node>> qOpenList;
-	bool * pClosedList = new bool[nMapWidth*nMapHeight]();
-
-	o_data_structures::BinaryHeap<unsigned int, unsigned int> qOpenList;
+	o_data_structures::GenerationStamps<> &sClosedList = workspace.sClosedList;
 
-	unsigned int neighbour_list[4];
+	const int pOffsets[4] = {1, -1, nMapWidth, -nMapWidth};  // change of the id by every move
 
-	unsigned int * pPredecessorIds = new unsigned int[nMapWidth*nMapHeight];
+	unsigned int * pPredecessorIds = workspace.pPredecessorIds;
 	unsigned int nStartId = GetId(nStartX, nStartY, nMapWidth);
 	unsigned int nTargetId = GetId(nTargetX, nTargetY, nMapWidth);
 	int nPathLength = -1;
 
-	OpenListItem nodeCurrent(0, nStartId);
 	pPredecessorIds[nStartId] = nStartId;
-	pClosedList[nStartId] = true;
+	sClosedList.set(nStartId);
 	qOpenList.insert(0, nStartId);
+	nodes_expanded = 0;
 
 	while(qOpenList.n_items_ > 0)
 	{
-		unsigned int nCurrentCost = qOpenList.A_[0].key_;
-		unsigned int nCurrentId = qOpenList.A_[0].data_;
-		qOpenList.remove(0);
-
+		unsigned int nCurrentCost;
+		unsigned int nCurrentId;
+		PopMin(qOpenList, nCurrentCost, nCurrentId);
 
 		if (nCurrentId == nTargetId)
 		{
 			nPathLength = nCurrentCost;
-			if(nCurrentCost <= nOutBufferSize)
+			if(nCurrentCost <= (unsigned int) nOutBufferSize)
 				ReconstructPath(nCurrentId, nCurrentCost, pOutBuffer, pPredecessorIds);
 			break;
 		}
 
-		int nNeighbours = FillNeighbourList(nCurrentId, nMapWidth, nMapHeight, neighbour_list, pMap);
-		for (int i=0; i<nNeighbours; ++i)
-			if (!pClosedList[neighbour_list[i]])
+		const unsigned int nMask = GetNeighbourMask(nCurrentId, nMapWidth, nMapHeight, pMap, pMasks);
+		for (unsigned int i=0; i<o_graph::NeighbourMasks::n_moves_[nMask]; ++i)
+		{
+			const unsigned int nNeighbourId = nCurrentId + pOffsets[o_graph::NeighbourMasks::moves_[nMask][i]];
+			if (!sClosedList.is_set(nNeighbourId))
 			{
-				qOpenList.insert(nCurrentCost + 1, neighbour_list[i] );
-				pClosedList[neighbour_list[i]] = true;
-				pPredecessorIds[neighbour_list[i]] = nCurrentId;
+				qOpenList.insert(nCurrentCost + 1, nNeighbourId);
+				sClosedList.set(nNeighbourId);
+				pPredecessorIds[nNeighbourId] = nCurrentId;
+				++nodes_expanded;
 			}
+		}
 	}
 
-	delete[] pClosedList;
-	delete[] pPredecessorIds;
+	workspace.Clear();
 	return nPathLength;
 }
 
 
+/** \brief Interface to use uniform cost search (binary heap as open list)
+ *
+ *  \param[in] nStartX The zero based x-coordinate of the start position
+ *  \param[in] nStartY The zero based y-coordinate of the start position
+ *  \param[in] nTargetX The zero based x-coordinate of the target position
+ *  \param[in] nTargetY The zero based y-coordinate of the target position
+ *  \param[in] pMap A pointer to the grid data (see \ref Map.hpp)
+ *  \param[in] nMapWidth the width of the map (its extent in x-direction)
+ *  \param[in] nMapHeight the height of the map (its extent in y-direction)
+ *  \param[out] pOutBuffer Pointer to a buffer where the indices of visited grid points are
+ *  stored (excluding the starting position)
+ *  \param[in] nOutBufferSize length of the buffer pOutBuffer
+ */
+int FindPath(const int nStartX, const int nStartY,
+			 const int nTargetX, const int nTargetY,
+			 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+			 int* pOutBuffer, const int nOutBufferSize)
+{
+	unsigned int nodes_expanded;
+	return FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+			pOutBuffer, nOutBufferSize, nodes_expanded, o_data_structures::open_list_binary_heap);
+}
+
+
+//! \brief Interface with diagnostics (binary heap as open list), see UniformCostSearch.hpp
+int FindPath(const int nStartX, const int nStartY,
+			 const int nTargetX, const int nTargetY,
+			 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+			 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+{
+	return FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+			pOutBuffer, nOutBufferSize, nodes_expanded, o_data_structures::open_list_binary_heap);
+}
+
+
+//! \brief Interface with diagnostics and choice of the open list, see UniformCostSearch.hpp
+int FindPath(const int nStartX, const int nStartY,
+			 const int nTargetX, const int nTargetY,
+			 const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+			 int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded,
+			 const o_data_structures::OpenListPolicy &policy)
+{
+	nodes_expanded = 0;
+	const std::shared_ptr<const o_graph::ComponentLabels> pComponents = o_graph::FindComponents(pMap, nMapWidth, nMapHeight);
+	if (pComponents && !pComponents->connected(GetId(nStartX, nStartY, nMapWidth),
+			GetId(nTargetX, nTargetY, nMapWidth)))
+		return -1;
+
+	UcsWorkspace &workspace = ThreadUcsWorkspace();
+	workspace.Reserve(nMapWidth*nMapHeight);
+	const std::shared_ptr<const o_graph::NeighbourMasks> pMasks = o_graph::FindNeighbourMasks(pMap, nMapWidth, nMapHeight);
+
+	if (policy == o_data_structures::open_list_buckets)
+		return SearchLoop(workspace, workspace.qBucketList, pMasks.get(), nStartX, nStartY, nTargetX, nTargetY,
+				pMap, nMapWidth, nMapHeight, pOutBuffer, nOutBufferSize, nodes_expanded);
+	return SearchLoop(workspace, workspace.qOpenList, pMasks.get(), nStartX, nStartY, nTargetX, nTargetY,
+			pMap, nMapWidth, nMapHeight, pOutBuffer, nOutBufferSize, nodes_expanded);
+}
+
+
+
+/** \brief Memory used by FindDistances(..) that is kept between calls
+ *
+ *  \details Every thread owns one workspace (see ThreadBatchWorkspace()).
+ *  Bit i of a word belongs to the search from source i of the current batch.
+ *  The three words of a grid point share a cache line; nFrontier and nNext are zero
+ *  outside of FindDistances(..). vFirstTarget is -1 for all grid points that
+ *  aren't targets of the running call.
+ */
+struct BatchWorkspace
+{
+	//! \brief Searches of the current batch at one grid point
+	struct Lanes
+	{
+		unsigned long long nVisited;   //< searches that reached the grid point
+		unsigned long long nFrontier;  //< searches that reached it in the last sweep
+		unsigned long long nNext;      //< searches reaching it in the current sweep
+	};
+
+	BatchWorkspace() { }
+
+	/** \brief Makes sure the buffers can hold nNodesRequired nodes
+	 *  \param[in] nNodesRequired number of nodes of the map to be searched
+	 */
+	void Reserve(const unsigned int nNodesRequired)
+	{
+		if (nNodesRequired <= vLanes.size())
+			return;
+		Lanes empty = {0, 0, 0};
+		vLanes.resize(nNodesRequired, empty);
+		vFirstTarget.resize(nNodesRequired, -1);
+		return;
+	}
+
+	std::vector<Lanes> vLanes;            //< searches at every grid point
+	std::vector<unsigned int> vCurrent;   //< grid points with non-zero nFrontier
+	std::vector<unsigned int> vUpcoming;  //< grid points with non-zero nNext
+	std::vector<int> vFirstTarget;        //< first target on every grid point (-1 if none)
+	std::vector<int> vNextTarget;         //< next target on the same grid point (-1 if none)
+
+private :
+	BatchWorkspace(const BatchWorkspace &);
+	BatchWorkspace &operator=(const BatchWorkspace &);
+};
+
+
+/** \brief Workspace of the calling thread
+ *  \return Reference to the BatchWorkspace of the calling thread
+ */
+BatchWorkspace &ThreadBatchWorkspace()
+{
+	static thread_local BatchWorkspace workspace;
+	return workspace;
+}
+
+
+/** \brief Writes the distance of all searches that just reached a grid point to its targets
+ *  \param[in] workspace the workspace
+ *  \param[in] nId the grid point
+ *  \param[in] nLanes bits of the searches that reached nId
+ *  \param[in] nDistance number of sweeps so far
+ *  \param[out] pOutRows distance matrix of the current batch (row: source, column: target)
+ *  \param[in] nTargets number of columns
+ *  \return number of distances written
+ */
+inline int RecordDistances(const BatchWorkspace &workspace, const unsigned int nId,
+		const unsigned long long nLanes, const int nDistance, int* pOutRows, const int nTargets)
+{
+	int nRecorded = 0;
+	for (int k = workspace.vFirstTarget[nId]; k != -1; k = workspace.vNextTarget[k])
+		for (unsigned long long nBits = nLanes; nBits != 0; nBits &= nBits - 1)
+		{
+			pOutRows[__builtin_ctzll(nBits)*nTargets + k] = nDistance;
+			++nRecorded;
+		}
+	return nRecorded;
+}
+
+
+/** \brief Hands the frontier of a grid point to one neighbour (part of a sweep of FindDistances(..))
+ *  \param[in,out] workspace the workspace
+ *  \param[in] nNeighbour the neighbour (traversable)
+ *  \param[in] nLanes searches in the frontier of the grid point
+ */
+inline void Advance(BatchWorkspace &workspace, const unsigned int nNeighbour, const unsigned long long nLanes)
+{
+	BatchWorkspace::Lanes &lanes = workspace.vLanes[nNeighbour];
+	const unsigned long long nFresh = nLanes & ~lanes.nVisited;
+	if (nFresh == 0)
+		return;
+	if (lanes.nNext == 0)
+		workspace.vUpcoming.push_back(nNeighbour);
+	lanes.nNext |= nFresh;
+	return;
+}
+
+
+//! \brief Batch of breadth first searches, see UniformCostSearch.hpp
+int FindDistances(const int* pSources, const int nSources,
+				  const int* pTargets, const int nTargets,
+				  const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+				  int* pOutDistances)
+{
+	BatchWorkspace &workspace = ThreadBatchWorkspace();
+	workspace.Reserve(nMapWidth*nMapHeight);
+	std::vector<BatchWorkspace::Lanes> &vLanes = workspace.vLanes;
 
+	workspace.vNextTarget.assign(nTargets, -1);
+	for (int k = nTargets - 1; k >= 0; --k)
+	{
+		workspace.vNextTarget[k] = workspace.vFirstTarget[pTargets[k]];
+		workspace.vFirstTarget[pTargets[k]] = k;
+	}
+	std::fill(pOutDistances, pOutDistances + nSources*nTargets, -1);
+
+	int nSweeps = 0;
+	for (int nBase = 0; nBase < nSources; nBase += 64)
+	{
+		const int nLanes = std::min(64, nSources - nBase);
+		int* pOutRows = pOutDistances + nBase*nTargets;
+		for (int i = 0; i < nMapWidth*nMapHeight; ++i)
+			vLanes[i].nVisited = 0;
+		workspace.vCurrent.clear();
+
+		// sweep 0: the sources
+		long long nRemaining = 0;
+		for (int i = 0; i < nLanes; ++i)
+		{
+			const unsigned int nId = pSources[nBase + i];
+			if (pMap[nId] != 1)
+				continue;
+			if (vLanes[nId].nFrontier == 0)
+				workspace.vCurrent.push_back(nId);
+			vLanes[nId].nFrontier |= 1ULL << i;
+			vLanes[nId].nVisited |= 1ULL << i;
+			nRemaining += nTargets;
+		}
+		for (std::size_t i = 0; i < workspace.vCurrent.size(); ++i)
+			nRemaining -= RecordDistances(workspace, workspace.vCurrent[i], vLanes[workspace.vCurrent[i]].nFrontier,
+					0, pOutRows, nTargets);
+
+		// sweep d: every search moves its frontier by one step
+		for (int nDistance = 1; !workspace.vCurrent.empty() && (nRemaining > 0); ++nDistance)
+		{
+			workspace.vUpcoming.clear();
+			for (std::size_t i = 0; i < workspace.vCurrent.size(); ++i)
+			{
+				const unsigned int nId = workspace.vCurrent[i];
+				const unsigned long long nFrontier = vLanes[nId].nFrontier;
+				vLanes[nId].nFrontier = 0;
+
+				const int x = GetX(nId, nMapWidth);
+				const int y = GetY(nId, nMapWidth);
+				if (((x + 1) < nMapWidth) && (pMap[nId + 1] == 1))
+					Advance(workspace, nId + 1, nFrontier);
+				if ((x > 0) && (pMap[nId - 1] == 1))
+					Advance(workspace, nId - 1, nFrontier);
+				if (((y + 1) < nMapHeight) && (pMap[nId + nMapWidth] == 1))
+					Advance(workspace, nId + nMapWidth, nFrontier);
+				if ((y > 0) && (pMap[nId - nMapWidth] == 1))
+					Advance(workspace, nId - nMapWidth, nFrontier);
+			}
+
+			for (std::size_t i = 0; i < workspace.vUpcoming.size(); ++i)
+			{
+				BatchWorkspace::Lanes &lanes = vLanes[workspace.vUpcoming[i]];
+				lanes.nFrontier = lanes.nNext;
+				lanes.nVisited |= lanes.nNext;
+				lanes.nNext = 0;
+				nRemaining -= RecordDistances(workspace, workspace.vUpcoming[i], lanes.nFrontier,
+						nDistance, pOutRows, nTargets);
+			}
+			workspace.vCurrent.swap(workspace.vUpcoming);
+			++nSweeps;
+		}
+
+		// early exit: the frontier of the last sweep is left
+		for (std::size_t i = 0; i < workspace.vCurrent.size(); ++i)
+			vLanes[workspace.vCurrent[i]].nFrontier = 0;
+	}
+
+	for (int k = 0; k < nTargets; ++k)
+		workspace.vFirstTarget[pTargets[k]] = -1;
+	return nSweeps;
+}
@@ -97,6 +97,8 @@
 #include <string>                     // used for filenames
 #include <stdexcept>                  // used for exception handling
 #include <vector>                     // list of filenames
+#include <memory>                     // registered preprocessing is shared (std::shared_ptr)
+#include <thread>                     // concurrent queries, number of hardware threads
 
 #include "oString.hpp"                // helper functions for string handling
 #include "time_measure.hpp"           // functions to measure wall- / cpu-time
@@ -109,8 +111,19 @@
 
 
 #include "AStar.hpp"                  // Path finding algorithm
-#include "Dijskra.hpp"
 #include "UniformCostSearch.hpp"
+#include "JumpPointSearch.hpp"        // Path finding algorithm for open maps
+#include "BitboardSearch.hpp"         // Path finding algorithm (bit-parallel BFS)
+#include "BidirectionalSearch.hpp"    // Path finding algorithm (meet in the middle)
+#include "HierarchicalPathfinding.hpp"  // Path finding algorithm (HPA*, near optimal)
+#include "ContractionHierarchy.hpp"   // Path finding algorithm (preprocessed static maps)
+#include "CorridorGraph.hpp"           // Path finding algorithm (contracted corridors)
+#include "SubgoalGraph.hpp"            // Path finding algorithm (subgoals at obstacle corners)
+#include "FringeSearch.hpp"            // Path finding algorithm (little memory)
+#include "FlowField.hpp"               // one-to-many pathfinding (rally points)
+#include "BlockAStar.hpp"              // Path finding algorithm (blocks of 4x4 grid points)
+#include "PathDatabase.hpp"            // First move lookups (preprocessed static maps)
+#include "PathCache.hpp"               // LRU cache of paths in front of AStar
 
 
 std::vector<std::string> MAPS
@@ -401,11 +414,710 @@ void IterateMaps(setting s, const int &nBufferSize, int * pOutBuffer)
 
 
 
+// pathfinders with a fixed open list policy (signature of PathfinderDiagnosticsFunc)
+int AStarBuckets(const int nStartX, const int nStartY, const int nTargetX, const int nTargetY,
+		const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+		int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+{
+	return astar::FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+			pOutBuffer, nOutBufferSize, nodes_expanded, o_data_structures::open_list_buckets);
+}
+
+
+int UcsBuckets(const int nStartX, const int nStartY, const int nTargetX, const int nTargetY,
+		const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+		int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+{
+	return FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+			pOutBuffer, nOutBufferSize, nodes_expanded, o_data_structures::open_list_buckets);
+}
+
+
+int AStarLandmarks(const int nStartX, const int nStartY, const int nTargetX, const int nTargetY,
+		const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+		int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+{
+	return astar::FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+			pOutBuffer, nOutBufferSize, nodes_expanded, o_data_structures::open_list_binary_heap,
+			o_graph::heuristic_landmarks);
+}
+
+
+// weighted A* with paths at most (1 + percent/100) times longer than the shortest ones
+template<unsigned percent>
+int AStarBounded(const int nStartX, const int nStartY, const int nTargetX, const int nTargetY,
+		const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+		int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+{
+	return astar::FindBoundedPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+			pOutBuffer, nOutBufferSize, percent/100.f, nodes_expanded);
+}
+
+
+int BidirectionalThreads(const int nStartX, const int nStartY, const int nTargetX, const int nTargetY,
+		const unsigned char* pMap, const int nMapWidth, const int nMapHeight,
+		int* pOutBuffer, const int nOutBufferSize, unsigned int &nodes_expanded)
+{
+	return bidirectional::FindPath(nStartX, nStartY, nTargetX, nTargetY, pMap, nMapWidth, nMapHeight,
+			pOutBuffer, nOutBufferSize, nodes_expanded, bidirectional::search_two_threads);
+}
+
+
+// preprocessing of benchmark maps (signature of MapPreparationFunc)
+void PrepareClusterGraph(const unsigned char* pMap, const int &nMapWidth, const int &nMapHeight)
+{
+	hpa::RegisterClusterGraph(pMap, nMapWidth, nMapHeight);
+}
+
+
+// builds the local distance database before the first query (once per process, map independent)
+void PrepareBlockDatabase(const unsigned char*, const int &, const int &)
+{
+	blockastar::SharedDatabase();
+}
+
+
+template <unsigned int n_landmarks>
+void PrepareLandmarks(const unsigned char* pMap, const int &nMapWidth, const int &nMapHeight)
+{
+	o_graph::RegisterLandmarks(pMap, nMapWidth, nMapHeight, n_landmarks);
+}
+
+
+void PrepareCorridorGraph(const unsigned char* pMap, const int &nMapWidth, const int &nMapHeight)
+{
+	const std::shared_ptr<const corridor::CorridorGraph> p_graph = corridor::RegisterCorridorGraph(pMap, nMapWidth, nMapHeight);
+	if (!p_graph)
+	{
+		std::cout << "Corridors: too little contraction, no graph registered (AStar)" << std::endl;
+		return;
+	}
+	std::cout << "Corridors: " << p_graph->n_nodes_ << " nodes, " << p_graph->corridor_length_.size() << " corridors, "
+			<< p_graph->get_memory_footprint()/1024 << " KiB" << std::endl;
+}
+
+
+void PrepareSubgoalGraph(const unsigned char* pMap, const int &nMapWidth, const int &nMapHeight)
+{
+	subgoal::RegisterSubgoalGraph(pMap, nMapWidth, nMapHeight);
+}
+
+
+void PrepareContractionHierarchy(const unsigned char* pMap, const int &nMapWidth, const int &nMapHeight)
+{
+	const std::shared_ptr<const ch::ContractionHierarchy> p_hierarchy = ch::RegisterContractionHierarchy(pMap, nMapWidth, nMapHeight);
+	std::cout << "CH: " << p_hierarchy->n_nodes_ << " nodes, " << p_hierarchy->edge_head_.size() << " edges ("
+			<< p_hierarchy->n_shortcuts_ << " shortcuts), " << p_hierarchy->get_memory_footprint()/1024 << " KiB" << std::endl;
+}
+
+
+// builds (or loads) the path database of a map and times first move and path queries
+void EvaluatePathDatabase(const std::string &file_name, const std::string &database_file, const unsigned int &n_queries)
+{
+	o_graph::Map map = OpenMap(file_name);
+
+	double t0 = get_wall_time();
+	const std::shared_ptr<const cpd::PathDatabase> p_database = cpd::RegisterPathDatabase(map.data_, map.width_, map.height_, database_file);
+	double prep_time = get_wall_time() - t0;
+	std::cout << "CPD: " << p_database->n_nodes_ << " nodes, " << p_database->runs_.size() << " runs, "
+			<< p_database->get_memory_footprint()/1024 << " KiB, build/load " << prep_time << " s" << std::endl;
+
+	std::vector<int> starts(n_queries), targets(n_queries);
+	for (unsigned int i=0; i<n_queries; ++i)
+	{
+		int x, y;
+		RandomizeCoordinates(x, y, map);
+		starts[i] = map.get_id(x, y);
+		RandomizeCoordinates(x, y, map);
+		targets[i] = map.get_id(x, y);
+	}
+
+	unsigned int checksum = 0;
+	t0 = get_wall_time();
+	for (unsigned int i=0; i<n_queries; ++i)
+		checksum += p_database->GetFirstMove(starts[i], targets[i]);
+	double first_move_time = get_wall_time() - t0;
+
+	std::vector<int> buffer(map.width_*map.height_);
+	long long total_length = 0;
+	t0 = get_wall_time();
+	for (unsigned int i=0; i<n_queries; ++i)
+		total_length += p_database->GetPath(starts[i], targets[i], &buffer[0], buffer.size());
+	double path_time = get_wall_time() - t0;
+
+	std::cout << "first move: " << 1e6*first_move_time/n_queries << " us/query (" << checksum << ")" << std::endl;
+	std::cout << "path: " << 1e6*path_time/n_queries << " us/query (mean length "
+			<< double(total_length)/n_queries << ")" << std::endl;
+
+	cpd::UnregisterPathDatabase(map.data_);
+	delete[] map.data_;
+	return;
+}
+
+
+// compares nodes expanded by AStar with manhattan and landmark heuristic for a growing number of landmarks
+void EvaluateLandmarks(const std::string &file_name, const unsigned int &n_queries)
+{
+	o_graph::Map map = OpenMap(file_name);
+	o_graph::RegisterComponents(map.data_, map.width_, map.height_);
+
+	std::vector<int> starts(n_queries), targets(n_queries);
+	for (unsigned int i=0; i<n_queries; ++i)
+	{
+		int x, y;
+		RandomizeCoordinates(x, y, map);
+		starts[i] = map.get_id(x, y);
+		RandomizeCoordinates(x, y, map);
+		targets[i] = map.get_id(x, y);
+	}
+
+	std::vector<int> buffer(map.width_*map.height_);
+	std::cout << "landmarks\tprep_time\tKiB\texpanded/query\tus/query\n";
+	const unsigned int n_landmarks[] = {0, 1, 2, 4, 8, 16, 32};
+	for (unsigned int k=0; k<sizeof(n_landmarks)/sizeof(n_landmarks[0]); ++k)
+	{
+		double t0 = get_wall_time();
+		std::size_t memory = 0;
+		if (n_landmarks[k] > 0)
+			memory = o_graph::RegisterLandmarks(map.data_, map.width_, map.height_, n_landmarks[k])->get_memory_footprint();
+		double prep_time = get_wall_time() - t0;
+
+		double sum_expanded = .0;
+		t0 = get_wall_time();
+		for (unsigned int i=0; i<n_queries; ++i)
+		{
+			unsigned int nodes_expanded = 0;
+			astar::FindPath(starts[i] % map.width_, starts[i] / map.width_, targets[i] % map.width_, targets[i] / map.width_,
+					map.data_, map.width_, map.height_, &buffer[0], buffer.size(), nodes_expanded,
+					o_data_structures::open_list_binary_heap,
+					(n_landmarks[k] > 0) ? o_graph::heuristic_landmarks : o_graph::heuristic_manhattan);
+			sum_expanded += nodes_expanded;
+		}
+		double query_time = get_wall_time() - t0;
+		std::cout << n_landmarks[k] << "\t" << prep_time << "\t" << memory/1024 << "\t"
+				<< sum_expanded/n_queries << "\t" << 1e6*query_time/n_queries << std::endl;
+	}
+
+	o_graph::UnregisterLandmarks(map.data_);
+	o_graph::UnregisterComponents(map.data_);
+	delete[] map.data_;
+	return;
+}
+
+
+// compares AStar and the subgoal graph on the same random queries (path lengths must agree)
+void EvaluateSubgoalGraph(const std::string &file_name, const unsigned int &n_queries)
+{
+	o_graph::Map map = OpenMap(file_name);
+
+	double t0 = get_wall_time();
+	const std::shared_ptr<const subgoal::SubgoalGraph> p_graph = subgoal::RegisterSubgoalGraph(map.data_, map.width_, map.height_);
+	double prep_time = get_wall_time() - t0;
+	std::cout << "subgoals: " << p_graph->n_subgoals_ << ", edges: " << p_graph->edge_head_.size() << ", "
+			<< p_graph->get_memory_footprint()/1024 << " KiB, build " << prep_time << " s" << std::endl;
+
+	std::vector<int> buffer(map.width_*map.height_);
+	double expanded[2] = {.0, .0};
+	double time[2] = {.0, .0};
+	unsigned int mismatches = 0;
+	for (unsigned int i=0; i<n_queries; ++i)
+	{
+		int x0, y0, x1, y1;
+		RandomizeCoordinates(x0, y0, map);
+		RandomizeCoordinates(x1, y1, map);
+		int length[2];
+		for (int engine=0; engine<2; ++engine)
+		{
+			unsigned int nodes_expanded = 0;
+			t0 = get_wall_time();
+			if (engine == 0)
+				length[engine] = astar::FindPath(x0, y0, x1, y1, map.data_, map.width_, map.height_,
+						&buffer[0], buffer.size(), nodes_expanded);
+			else
+				length[engine] = subgoal::FindPath(x0, y0, x1, y1, map.data_, map.width_, map.height_,
+						&buffer[0], buffer.size(), nodes_expanded);
+			time[engine] += get_wall_time() - t0;
+			expanded[engine] += nodes_expanded;
+		}
+		if (length[0] != length[1])
+			++mismatches;
+	}
+	std::cout << "AStar:\t\t" << expanded[0]/n_queries << " expanded/query\t" << 1e6*time[0]/n_queries << " us/query" << std::endl;
+	std::cout << "Subgoal graph:\t" << expanded[1]/n_queries << " expanded/query\t" << 1e6*time[1]/n_queries << " us/query" << std::endl;
+	std::cout << "length mismatches: " << mismatches << std::endl;
+
+	subgoal::UnregisterSubgoalGraph(map.data_);
+	delete[] map.data_;
+	return;
+}
+
+
+// compares one batch of 64 breadth first searches (FindDistances) with 64 separate UCS calls
+void EvaluateBatchDistances(const std::string &file_name, const int &n_targets)
+{
+	o_graph::Map map = OpenMap(file_name);
+	const int n_sources = 64;
+	std::vector<int> sources(n_sources);
+	std::vector<int> targets(n_targets);
+	for (int i=0; i<n_sources; ++i)
+	{
+		int x, y;
+		RandomizeCoordinates(x, y, map);
+		sources[i] = map.get_id(x, y);
+	}
+	for (int k=0; k<n_targets; ++k)
+	{
+		int x, y;
+		RandomizeCoordinates(x, y, map);
+		targets[k] = map.get_id(x, y);
+	}
+
+	std::vector<int> distances(n_sources*n_targets);
+	double t0 = get_wall_time();
+	int n_sweeps = FindDistances(&sources[0], n_sources, &targets[0], n_targets,
+			map.data_, map.width_, map.height_, &distances[0]);
+	double batch_time = get_wall_time() - t0;
+
+	std::vector<int> buffer(map.width_*map.height_);
+	unsigned int mismatches = 0;
+	t0 = get_wall_time();
+	for (int i=0; i<n_sources; ++i)
+		for (int k=0; k<n_targets; ++k)
+			if (FindPath(map.get_x(sources[i]), map.get_y(sources[i]), map.get_x(targets[k]), map.get_y(targets[k]),
+					map.data_, map.width_, map.height_, &buffer[0], buffer.size()) != distances[i*n_targets+k])
+				++mismatches;
+	double ucs_time = get_wall_time() - t0;
+
+	const int n_queries = n_sources*n_targets;
+	std::cout << file_name << ": " << n_sources << " sources x " << n_targets << " targets" << std::endl;
+	std::cout << "FindDistances:\t" << n_queries/batch_time << " queries/s\t(" << n_sweeps << " sweeps)" << std::endl;
+	std::cout << "UCS:\t\t" << n_queries/ucs_time << " queries/s" << std::endl;
+	std::cout << "distance mismatches: " << mismatches << std::endl;
+
+	delete[] map.data_;
+	return;
+}
+
+
+// checks the flow field of a random target against a breadth first search and compares
+// one field for n_units units with n_units separate astar::FindPath(..) calls
+void EvaluateFlowField(const std::string &file_name, const unsigned int &n_units)
+{
+	o_graph::Map map = OpenMap(file_name);
+	const int n_nodes = map.width_*map.height_;
+	int x, y;
+	RandomizeCoordinates(x, y, map);
+	const unsigned int target = map.get_id(x, y);
+
+	double t0 = get_wall_time();
+	const std::shared_ptr<const flowfield::FlowField> p_field =
+			flowfield::RegisterFlowField(map.data_, map.width_, map.height_, target);
+	double build_time = get_wall_time() - t0;
+
+	// breadth first search from the target: every move has to decrease the distance by one
+	std::vector<int> distance(n_nodes, -1);
+	std::vector<unsigned int> queue(1, target);
+	distance[target] = 0;
+	for (std::size_t head=0; head<queue.size(); ++head)
+	{
+		const unsigned int id = queue[head];
+		const unsigned int mask = map.get_neighbour_mask(id);
+		for (unsigned int i=0; i<o_graph::NeighbourMasks::n_moves_[mask]; ++i)
+		{
+			const unsigned int neighbour = map.get_neighbour(id, o_graph::NeighbourMasks::moves_[mask][i]);
+			if (distance[neighbour] >= 0)
+				continue;
+			distance[neighbour] = distance[id] + 1;
+			queue.push_back(neighbour);
+		}
+	}
+	unsigned int field_mismatches = 0;
+	for (int id=0; id<n_nodes; ++id)
+	{
+		const int next = p_field->get_next(id);
+		if (distance[id] <= 0)
+		{
+			if (next != ((distance[id] == 0) ? id : -1))
+				++field_mismatches;
+		}
+		else if ( (next < 0) || (abs(map.get_x(next) - map.get_x(id)) + abs(map.get_y(next) - map.get_y(id)) != 1)
+				|| (distance[next] != distance[id] - 1) )
+			++field_mismatches;
+	}
+
+	std::vector<int> starts(n_units);
+	for (unsigned int i=0; i<n_units; ++i)
+	{
+		RandomizeCoordinates(x, y, map);
+		starts[i] = map.get_id(x, y);
+	}
+	std::vector<int> buffer(n_nodes);
+	std::vector<int> field_lengths(n_units);
+	t0 = get_wall_time();
+	for (unsigned int i=0; i<n_units; ++i)
+		field_lengths[i] = flowfield::FindPath(map.get_x(starts[i]), map.get_y(starts[i]), map.get_x(target), map.get_y(target),
+				map.data_, map.width_, map.height_, &buffer[0], buffer.size());
+	double follow_time = get_wall_time() - t0;
+
+	unsigned int path_mismatches = 0;
+	t0 = get_wall_time();
+	for (unsigned int i=0; i<n_units; ++i)
+		if (astar::FindPath(map.get_x(starts[i]), map.get_y(starts[i]), map.get_x(target), map.get_y(target),
+				map.data_, map.width_, map.height_, &buffer[0], buffer.size()) != field_lengths[i])
+			++path_mismatches;
+	double astar_time = get_wall_time() - t0;
+
+	std::cout << "field: " << 1e3*build_time << " ms, " << p_field->get_memory_footprint()/1024 << " KiB, "
+			<< field_mismatches << " mismatches (breadth first search)" << std::endl;
+	std::cout << n_units << " units, flow field:\t" << 1e3*(build_time + follow_time) << " ms ("
+			<< 1e3*follow_time << " ms following)" << std::endl;
+	std::cout << n_units << " units, AStar:\t" << 1e3*astar_time << " ms" << std::endl;
+	std::cout << "path length mismatches: " << path_mismatches << std::endl;
+
+	flowfield::UnregisterFlowField(map.data_, target);
+	delete[] map.data_;
+	return;
+}
+
+
+// expansion kernel with neighbour masks computed on the fly (former branchy code) and precomputed
+// (sums neighbour ids of all grid points, repeated n_sweeps times), then UCS and AStar without and with masks
+void EvaluateNeighbourMasks(const std::string &file_name, const unsigned int &n_queries)
+{
+	o_graph::Map map = OpenMap(file_name);
+	const unsigned int n_nodes = map.width_*map.height_;
+	const unsigned int n_sweeps = 20;
+
+	double t0 = get_wall_time();
+	const std::shared_ptr<const o_graph::NeighbourMasks> p_masks = o_graph::RegisterNeighbourMasks(map.data_, map.width_, map.height_);
+	double prep_time = get_wall_time() - t0;
+
+	const int offsets[4] = {1, -1, map.width_, -map.width_};
+	unsigned long long checksum[2] = {0, 0};
+	double kernel_time[2];
+	for (int k=0; k<2; ++k)
+	{
+		t0 = get_wall_time();
+		for (unsigned int s=0; s<n_sweeps; ++s)
+			for (unsigned int id=0; id<n_nodes; ++id)
+			{
+				const unsigned int mask = (k == 0) ?
+						o_graph::NeighbourMasks::ComputeMask(id, map.width_, map.height_, map.data_) : p_masks->mask(id);
+				for (unsigned int i=0; i<o_graph::NeighbourMasks::n_moves_[mask]; ++i)
+					checksum[k] += id + offsets[o_graph::NeighbourMasks::moves_[mask][i]];
+			}
+		kernel_time[k] = get_wall_time() - t0;
+	}
+	std::cout << "masks: " << 1e3*prep_time << " ms, " << p_masks->get_memory_footprint()/1024 << " KiB" << std::endl;
+	std::cout << "kernel on the fly:\t" << 1e9*kernel_time[0]/(double(n_sweeps)*n_nodes) << " ns/node" << std::endl;
+	std::cout << "kernel precomputed:\t" << 1e9*kernel_time[1]/(double(n_sweeps)*n_nodes) << " ns/node"
+			<< ((checksum[0] == checksum[1]) ? "" : " (CHECKSUM MISMATCH)") << std::endl;
+
+	std::vector<int> starts(n_queries), targets(n_queries);
+	for (unsigned int i=0; i<n_queries; ++i)
+	{
+		int x, y;
+		RandomizeCoordinates(x, y, map);
+		starts[i] = map.get_id(x, y);
+		RandomizeCoordinates(x, y, map);
+		targets[i] = map.get_id(x, y);
+	}
+
+	std::vector<int> buffer(n_nodes);
+	std::cout << "masks\tengine\texpanded/query\tus/query\n";
+	for (int k=0; k<2; ++k)
+	{
+		if (k == 0)
+			o_graph::UnregisterNeighbourMasks(map.data_);
+		else
+			o_graph::RegisterNeighbourMasks(map.data_, map.width_, map.height_);
+		for (int e=0; e<2; ++e)
+		{
+			double sum_expanded = .0;
+			t0 = get_wall_time();
+			for (unsigned int i=0; i<n_queries; ++i)
+			{
+				unsigned int nodes_expanded = 0;
+				if (e == 0)
+					FindPath(map.get_x(starts[i]), map.get_y(starts[i]), map.get_x(targets[i]), map.get_y(targets[i]),
+							map.data_, map.width_, map.height_, &buffer[0], buffer.size(), nodes_expanded);
+				else
+					astar::FindPath(map.get_x(starts[i]), map.get_y(starts[i]), map.get_x(targets[i]), map.get_y(targets[i]),
+							map.data_, map.width_, map.height_, &buffer[0], buffer.size(), nodes_expanded);
+				sum_expanded += nodes_expanded;
+			}
+			double query_time = get_wall_time() - t0;
+			std::cout << ((k == 0) ? "no" : "yes") << "\t" << ((e == 0) ? "UCS" : "AStar") << "\t"
+					<< sum_expanded/n_queries << "\t" << 1e6*query_time/n_queries << std::endl;
+		}
+	}
 
+	o_graph::UnregisterNeighbourMasks(map.data_);
+	delete[] map.data_;
+	return;
+}
 
 
-int main(void)
+// number of grid points of a path returned by FindPath(..) that aren't a step to a traversable neighbour
+unsigned int CountInvalidSteps(const o_graph::Map &map, const int &start, const int &target,
+		const int *pPath, const int &path_length)
 {
+	unsigned int invalid = 0;
+	int previous = start;
+	for (int i=0; i<path_length; ++i)
+	{
+		const int dx = map.get_x(pPath[i]) - map.get_x(previous);
+		const int dy = map.get_y(pPath[i]) - map.get_y(previous);
+		if ( (pPath[i] < 0) || (pPath[i] >= map.width_*map.height_) || (abs(dx) + abs(dy) != 1)
+				|| (map.data_[pPath[i]] != o_graph::Map::terrain_traversable_) )
+			++invalid;
+		previous = pPath[i];
+	}
+	if ( (path_length > 0) && (previous != target) )
+		++invalid;
+	return invalid;
+}
+
+
+// PathCache against AStar: lengths and steps of cached paths, sub-paths and reversed sub-paths
+// of cached paths, eviction with a small capacity, number of known maps after many maps were
+// cached and invalidated, pathcache::FindPath(..) from several threads; prints the number of
+// mismatches (should be 0)
+void EvaluatePathCache(const std::string &file_name, const unsigned int &n_queries)
+{
+	o_graph::Map map = OpenMap(file_name);
+	const int n_nodes = map.width_*map.height_;
+	std::vector<int> starts(n_queries), targets(n_queries), lengths(n_queries);
+	std::vector<int> buffer(n_nodes);
+	double t0 = get_wall_time();
+	for (unsigned int i=0; i<n_queries; ++i)
+	{
+		int x, y;
+		RandomizeCoordinates(x, y, map);
+		starts[i] = map.get_id(x, y);
+		RandomizeCoordinates(x, y, map);
+		targets[i] = map.get_id(x, y);
+		lengths[i] = astar::FindPath(map.get_x(starts[i]), map.get_y(starts[i]), map.get_x(targets[i]), map.get_y(targets[i]),
+				map.data_, map.width_, map.height_, &buffer[0], buffer.size());
+	}
+	const double astar_time = get_wall_time() - t0;
+
+	// every query is a miss first and a hit when it is repeated
+	pathcache::PathCache cache(16*n_nodes);
+	unsigned int mismatches = 0;
+	for (unsigned int i=0; i<n_queries; ++i)
+	{
+		if (cache.Lookup(map.data_, map.width_, map.height_, starts[i], targets[i], &buffer[0], buffer.size()) != pathcache::PathCache::miss_)
+			continue;
+		const int length = astar::FindPath(map.get_x(starts[i]), map.get_y(starts[i]), map.get_x(targets[i]), map.get_y(targets[i]),
+				map.data_, map.width_, map.height_, &buffer[0], buffer.size());
+		cache.Insert(map.data_, map.width_, map.height_, starts[i], &buffer[0], length);
+	}
+	t0 = get_wall_time();
+	for (unsigned int i=0; i<n_queries; ++i)
+	{
+		const int length = cache.Lookup(map.data_, map.width_, map.height_, starts[i], targets[i], &buffer[0], buffer.size());
+		if ( (length != lengths[i]) || (CountInvalidSteps(map, starts[i], targets[i], &buffer[0], length) > 0) )
+			++mismatches;
+	}
+	const double hit_time = get_wall_time() - t0;
+
+	// grid points a and b of a cached path: b to a is a reversed sub-path
+	unsigned int sub_mismatches = 0;
+	unsigned int sub_queries = 0;
+	std::vector<int> path(n_nodes + 1);
+	for (unsigned int i=0; i<n_queries; ++i)
+	{
+		if (lengths[i] < 2)
+			continue;
+		path[0] = starts[i];
+		cache.Lookup(map.data_, map.width_, map.height_, starts[i], targets[i], &path[1], n_nodes);
+		const int a = RNG.int32() % (lengths[i] + 1);
+		const int b = RNG.int32() % (lengths[i] + 1);
+		const int length = cache.Lookup(map.data_, map.width_, map.height_, path[b], path[a], &buffer[0], buffer.size());
+		if ( (length != abs(a - b)) || (CountInvalidSteps(map, path[b], path[a], &buffer[0], length) > 0) )
+			++sub_mismatches;
+		++sub_queries;
+	}
+
+	// capacity of a few paths: old paths are evicted, the others are still found
+	const std::size_t small_capacity = 4*(map.width_ + map.height_);
+	pathcache::PathCache small_cache(small_capacity);
+	unsigned int small_mismatches = 0;
+	for (unsigned int i=0; i<n_queries; ++i)
+	{
+		int length = small_cache.Lookup(map.data_, map.width_, map.height_, starts[i], targets[i], &buffer[0], buffer.size());
+		if (length == pathcache::PathCache::miss_)
+		{
+			length = astar::FindPath(map.get_x(starts[i]), map.get_y(starts[i]), map.get_x(targets[i]), map.get_y(targets[i]),
+					map.data_, map.width_, map.height_, &buffer[0], buffer.size());
+			small_cache.Insert(map.data_, map.width_, map.height_, starts[i], &buffer[0], length);
+		}
+		if ( (length != lengths[i]) || (CountInvalidSteps(map, starts[i], targets[i], &buffer[0], length) > 0) )
+			++small_mismatches;
+	}
+	const pathcache::PathCacheStatistics small_statistics = small_cache.get_statistics();
+
+	// many small maps, every second one invalidated: only maps with cached paths are known
+	const int n_maps = 1000;
+	const int map_extent = 16;
+	std::vector<std::vector<unsigned char> > maps(n_maps, std::vector<unsigned char>(map_extent*map_extent, 1));
+	pathcache::PathCache map_cache(64*map_extent);
+	const int row[map_extent - 1] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+	for (int i=0; i<n_maps; ++i)
+	{
+		map_cache.Insert(&maps[i][0], map_extent, map_extent, 0, row, map_extent - 1);
+		if (i % 2)
+			map_cache.InvalidateMap(&maps[i][0]);
+	}
+	const pathcache::PathCacheStatistics map_statistics = map_cache.get_statistics();
+
+	// the shared cache from several threads
+	const unsigned int n_threads = 4;
+	std::vector<unsigned int> thread_mismatches(n_threads, 0);
+	std::vector<std::thread> threads;
+	pathcache::SharedPathCache().Clear();
+	for (unsigned int t=0; t<n_threads; ++t)
+		threads.push_back(std::thread([&, t]()
+		{
+			std::vector<int> thread_buffer(n_nodes);
+			for (unsigned int k=0; k<2*n_queries; ++k)
+			{
+				const unsigned int i = (k*(t + 1)) % n_queries;
+				const int length = pathcache::FindPath(map.get_x(starts[i]), map.get_y(starts[i]), map.get_x(targets[i]), map.get_y(targets[i]),
+						map.data_, map.width_, map.height_, &thread_buffer[0], thread_buffer.size());
+				if ( (length != lengths[i]) || (CountInvalidSteps(map, starts[i], targets[i], &thread_buffer[0], length) > 0) )
+					++thread_mismatches[t];
+			}
+		}));
+	for (unsigned int t=0; t<n_threads; ++t)
+		threads[t].join();
+	unsigned int shared_mismatches = 0;
+	for (unsigned int t=0; t<n_threads; ++t)
+		shared_mismatches += thread_mismatches[t];
+
+	const pathcache::PathCacheStatistics statistics = cache.get_statistics();
+	std::cout << n_queries << " queries, AStar:\t" << 1e3*astar_time << " ms" << std::endl;
+	std::cout << n_queries << " queries, cache hits:\t" << 1e3*hit_time << " ms ("
+			<< statistics.n_paths_ << " paths, " << statistics.n_cells_ << " grid points)" << std::endl;
+	std::cout << "mismatches: " << mismatches << ", sub-paths: " << sub_mismatches << " of " << sub_queries << std::endl;
+	std::cout << "capacity " << small_capacity << ": " << small_statistics.n_cells_ << " grid points, "
+			<< small_statistics.evictions_ << " evictions, " << small_mismatches << " mismatches" << std::endl;
+	std::cout << n_maps << " maps: " << map_statistics.n_maps_ << " known, " << map_statistics.n_paths_ << " paths cached" << std::endl;
+	std::cout << n_threads << " threads: " << shared_mismatches << " mismatches" << std::endl;
+
+	delete[] map.data_;
+	return;
+}
+
+
+int main(int argc, char *argv[])
+{
+	// ./pdx_pathfinding pathcache [map_file]
+	if( (argc > 1) && (std::string(argv[1]) == "pathcache") )
+	{
+		EvaluatePathCache((argc > 2) ? argv[2] : "./maps/maze512-16-0.map", 200);
+		return 0;
+	}
+
+	// ./pdx_pathfinding flowfield [map_file] [units]
+	if( (argc > 1) && (std::string(argv[1]) == "flowfield") )
+	{
+		std::string file_name = (argc > 2) ? argv[2] : "./maps/maze512-16-0.map";
+		EvaluateFlowField(file_name, (argc > 3) ? std::stoi(argv[3]) : 50);
+		return 0;
+	}
+
+	// ./pdx_pathfinding neighbours [map_file ...]
+	if( (argc > 1) && (std::string(argv[1]) == "neighbours") )
+	{
+		std::vector<std::string> file_names(argv+2, argv+argc);
+		if (file_names.empty())
+			file_names = {"./maps/maze512-1-0.map", "./maps/maze512-32-0.map"};
+		for (std::size_t i=0; i<file_names.size(); ++i)
+			EvaluateNeighbourMasks(file_names[i], 200);
+		return 0;
+	}
+
+	// ./pdx_pathfinding subgoals [map_file ...]
+	if( (argc > 1) && (std::string(argv[1]) == "subgoals") )
+	{
+		std::vector<std::string> file_names(argv+2, argv+argc);
+		if (file_names.empty())
+			file_names = {"./maps/maze512-8-0.map", "./maps/maze512-16-0.map"};
+		for (std::size_t i=0; i<file_names.size(); ++i)
+			EvaluateSubgoalGraph(file_names[i], 200);
+		return 0;
+	}
+
+	// ./pdx_pathfinding batch [map_file] [targets]
+	if( (argc > 1) && (std::string(argv[1]) == "batch") )
+	{
+		std::string file_name = (argc > 2) ? argv[2] : "./maps/maze512-16-0.map";
+		EvaluateBatchDistances(file_name, (argc > 3) ? std::stoi(argv[3]) : 1);
+		return 0;
+	}
+
+	// ./pdx_pathfinding landmarks [map_file]
+	if( (argc > 1) && (std::string(argv[1]) == "landmarks") )
+	{
+		EvaluateLandmarks((argc > 2) ? argv[2] : "./maps/maze512-1-0.map", 200);
+		return 0;
+	}
+
+	// ./pdx_pathfinding cpd [map_file] [database_file]
+	if( (argc > 1) && (std::string(argv[1]) == "cpd") )
+	{
+		std::string file_name = (argc > 2) ? argv[2] : "./maps/pdx_example.map";
+		std::string database_file = (argc > 3) ? argv[3] : "";
+		EvaluatePathDatabase(file_name, database_file, 10000);
+		return 0;
+	}
+
+	// ./pdx_pathfinding bidirectional [runs_per_map] [maps_per_family]
+	// (experimental two-thread mode against alternating mode; needs a second idle core)
+	if( (argc > 1) && (std::string(argv[1]) == "bidirectional") )
+	{
+		int runs_per_map = (argc > 2) ? std::stoi(argv[2]) : 20;
+		int maps_per_family = (argc > 3) ? std::stoi(argv[3]) : 2;
+		std::cout << "hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+		BenchmarkFamilies benchmark(runs_per_map, maps_per_family);
+		benchmark.Run("Bidirectional", &bidirectional::FindPath);
+		benchmark.Run("Bidirectional (2 threads)", &BidirectionalThreads);
+		return 0;
+	}
+
+	// ./pdx_pathfinding benchmark [runs_per_map] [maps_per_family]
+	if( (argc > 1) && (std::string(argv[1]) == "benchmark") )
+	{
+		int runs_per_map = (argc > 2) ? std::stoi(argv[2]) : 20;
+		int maps_per_family = (argc > 3) ? std::stoi(argv[3]) : 2;
+		BenchmarkFamilies benchmark(runs_per_map, maps_per_family);
+		benchmark.Run("AStar", &astar::FindPath);
+		benchmark.Run("AStar (buckets)", &AStarBuckets);
+		benchmark.Run("AStar (8 landmarks)", &AStarLandmarks, &PrepareLandmarks<8>, &o_graph::UnregisterLandmarks);
+		benchmark.Run("AStar (eps 0.1)", &AStarBounded<10>);
+		benchmark.Run("AStar (eps 0.5)", &AStarBounded<50>);
+		benchmark.Run("Fringe", &fringe::FindPath);
+		benchmark.Run("Block A*", &blockastar::FindPath, &PrepareBlockDatabase, 0L);
+		benchmark.Run("UCS", &FindPath);
+		benchmark.Run("UCS (buckets)", &UcsBuckets);
+		benchmark.Run("JPS", &jps::FindPath);
+		benchmark.Run("Bitboard BFS", &bitboard::FindPath);
+		benchmark.Run("Bidirectional", &bidirectional::FindPath);
+		BenchmarkFamilies maze_benchmark(runs_per_map, maps_per_family);
+		maze_benchmark.set_max_corridor_width(1);  // wider corridors don't contract (see CorridorGraph.hpp)
+		maze_benchmark.Run("Corridors", &corridor::FindPath, &PrepareCorridorGraph, &corridor::UnregisterCorridorGraph);
+		benchmark.Run("Subgoal graph", &subgoal::FindPath, &PrepareSubgoalGraph, &subgoal::UnregisterSubgoalGraph);
+		benchmark.Run("HPA*", &hpa::FindPath, &PrepareClusterGraph, &hpa::UnregisterClusterGraph);
+		benchmark.Run("CH", &ch::FindPath, &PrepareContractionHierarchy, &ch::UnregisterContractionHierarchy);
+		const astar::NodePool &node_pool = astar::ThreadWorkspace().node_pool_;
+		std::cout << "AStar node pool: " << node_pool.allocations_ << " nodes, ";
+		std::cout << node_pool.heap_allocations_ << " slab allocations, ";
+		std::cout << node_pool.resets_ << " searches" << std::endl;
+		return 0;
+	}
+
 	AnalysisRuntime::printable_buffer = false;
 	AnalysisRuntime::disabled_analysis = true;
 	const int nBufferSize = 2; // 1024;